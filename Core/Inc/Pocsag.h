@@ -21,12 +21,31 @@ typedef enum {
     POCSAGRC_INVALIDADDRESS,
     POCSAGRC_INVALIDSOURCE,
     POCSAGRC_INVALIDBATCH2OPT,
-    POCSAGRC_INVALIDINVERTOPT
+    POCSAGRC_INVALIDINVERTOPT,
+    POCSAGRC_SINKABORTED,
+    POCSAGRC_INVALIDDIGIT
 } Pocsag_error;
 
+// The 576 bit preamble in front of the first batch
+#define POCSAG_PREAMBLE_BYTES 72
+
+// POCSAG_RADIO_PREAMBLE: the transmitter generates the preamble itself, the
+// message starts at the first sync codeword
+#ifdef POCSAG_RADIO_PREAMBLE
+#define POCSAG_MSG_PREAMBLE 0
+#else
+#define POCSAG_MSG_PREAMBLE POCSAG_PREAMBLE_BYTES
+#endif
+
+// Message sizes with one and two batches
+#define POCSAG_MSG_SIZE_1BATCH (POCSAG_MSG_PREAMBLE + 68)
+#define POCSAG_MSG_SIZE_2BATCH (POCSAG_MSG_PREAMBLE + 136)
+
 // POCSAG message structure
 typedef struct {
-    uint8_t sync[72];
+#if POCSAG_MSG_PREAMBLE > 0
+    uint8_t sync[POCSAG_MSG_PREAMBLE];
+#endif
     uint8_t synccw1[4];
     uint32_t batch1[16];
     uint8_t synccw2[4];
@@ -41,12 +60,43 @@ typedef struct {
     int error;
 } Pocsag_t;
 
+// Codeword sink: gets the transmission one codeword at a time, in air order
+// and polarity: the preamble (as 0xAAAAAAAA words), then per batch the sync
+// codeword and the 16 frame codewords. Returning false aborts the encoding.
+typedef bool (*Pocsag_Sink_t)(void* ctx, uint32_t codeword);
+
+// Streaming encoder, its size does not depend on the message length. The
+// text is read while encoding and must stay valid until the last codeword.
+typedef struct {
+    const char* text;
+    bool numeric;       // text holds digits for a numeric pager
+    int txtlen;         // characters including the terminating EOT, or digits
+    uint32_t addresscw;
+    int addressline;    // codeword slot of the address, 0-15
+    int lastline;       // last slot holding the address or message data
+    int batches;
+    int batch2copy;     // batch 2 repeats batch 1
+    int preamble;       // preamble words still to come
+    int pos;            // next codeword, counted from the first sync codeword
+    uint32_t invert;
+    int error;
+} Pocsag_Encoder_t;
+
 // Function prototypes
 void Pocsag_Init(Pocsag_t* pocsag);
 int Pocsag_GetState(Pocsag_t* pocsag);
 int Pocsag_GetSize(Pocsag_t* pocsag);
 int Pocsag_GetError(Pocsag_t* pocsag);
 void* Pocsag_GetMsgPointer(Pocsag_t* pocsag);
-int Pocsag_CreatePocsag(Pocsag_t* pocsag, long int address, int source, char* text, int option_batch2, int option_invert);
+int Pocsag_CreatePocsag(Pocsag_t* pocsag, long int address, int source, const char* text, int option_batch2, int option_invert);
+int Pocsag_CreatePocsagNumeric(Pocsag_t* pocsag, long int address, int source, const char* digits, int option_batch2, int option_invert);
+
+int Pocsag_EncoderInit(Pocsag_Encoder_t* enc, long int address, int source, const char* text, int option_batch2, int option_invert);
+int Pocsag_EncoderInitNumeric(Pocsag_Encoder_t* enc, long int address, int source, const char* digits, int option_batch2, int option_invert);
+bool Pocsag_EncoderNext(Pocsag_Encoder_t* enc, uint32_t* codeword);
+int Pocsag_EncoderGetSize(Pocsag_Encoder_t* enc);
+int Pocsag_EncoderGetCodewords(Pocsag_Encoder_t* enc, uint32_t* codewords, int max);
+int Pocsag_Encode(long int address, int source, const char* text, int option_batch2, int option_invert,
+                  Pocsag_Sink_t sink, void* ctx, int* error);
 
 #endif // POCSAG_H
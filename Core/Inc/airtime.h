@@ -0,0 +1,32 @@
+/*
+ * airtime.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef AIRTIME_H
+#define AIRTIME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Duty-cycle window: one hour in one-minute buckets. One extra bucket keeps
+// the partially elapsed oldest minute, so the sum always covers >= 60 minutes.
+#define AIRTIME_WINDOW_MS       3600000UL
+#define AIRTIME_BUCKET_MS       60000UL
+#define AIRTIME_BUCKETS         (AIRTIME_WINDOW_MS / AIRTIME_BUCKET_MS + 1)
+
+#define AIRTIME_DEFAULT_LIMIT_PERCENT 10
+#define AIRTIME_NEVER           UINT32_MAX
+
+void Airtime_Init(uint8_t limitPercent);
+void Airtime_SetLimit(uint8_t limitPercent);
+uint8_t Airtime_GetLimit(void);
+void Airtime_TxStart(void);
+void Airtime_TxEnd(void);
+uint32_t Airtime_GetUsedMs(void);
+uint32_t Airtime_GetBudgetMs(void);
+uint32_t Airtime_GetDeferral(uint32_t duration_ms);
+
+#endif // AIRTIME_H
@@ -0,0 +1,46 @@
+/*
+ * canned.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef CANNED_H
+#define CANNED_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Pocsag.h"
+
+// Canned messages are encoded at build time by Host/pocsag_canned from
+// Core/Src/canned.txt into Core/Src/canned.c, the tables stay in flash and
+// are sent as they are. They are in normal polarity (option_invert 0), the
+// radio's modem inverts them when the firmware transmits inverted.
+
+// The data starts like a Pocsag_t message: preamble bytes when the encoder
+// would send them (see POCSAG_MSG_PREAMBLE), then the batches
+#if POCSAG_MSG_PREAMBLE > 0
+#if POCSAG_MSG_PREAMBLE != 72
+#error "CANNED_PREAMBLE is written for a 72 byte preamble"
+#endif
+#define CANNED_PREAMBLE8 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA,
+#define CANNED_PREAMBLE  CANNED_PREAMBLE8 CANNED_PREAMBLE8 CANNED_PREAMBLE8 \
+                         CANNED_PREAMBLE8 CANNED_PREAMBLE8 CANNED_PREAMBLE8 \
+                         CANNED_PREAMBLE8 CANNED_PREAMBLE8 CANNED_PREAMBLE8
+#else
+#define CANNED_PREAMBLE
+#endif
+
+typedef struct {
+    long address;
+    int source;
+    const char* text;
+    const uint8_t* data;    // as Pocsag_GetMsgPointer()
+    uint16_t size;          // as Pocsag_GetSize()
+} Canned_t;
+
+// Function prototypes
+int Canned_GetCount(void);
+const Canned_t* Canned_Get(int number);
+
+#endif // CANNED_H
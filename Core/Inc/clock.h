@@ -0,0 +1,29 @@
+/*
+ * clock.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "main.h"
+
+// System clock profiles
+typedef enum {
+    CLOCK_PROFILE_LOWPOWER = 0,  // 8 MHz HSI, PLL and HSE off, 0 wait states
+    CLOCK_PROFILE_PERFORMANCE    // 72 MHz from 8 MHz HSE x9 PLL, 2 wait states
+} Clock_Profile;
+
+// SPI buses retimed on a profile switch
+#define CLOCK_MAX_SPI 2
+
+void Clock_Init(SPI_HandleTypeDef *hspi, UART_HandleTypeDef *huart);
+bool Clock_AddSpi(SPI_HandleTypeDef *hspi);
+bool Clock_SetProfile(Clock_Profile profile);
+Clock_Profile Clock_GetProfile(void);
+
+#endif // CLOCK_H
@@ -0,0 +1,42 @@
+/*
+ * direct_tx.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef DIRECT_TX_H
+#define DIRECT_TX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "main.h"
+
+// Bit clock for the SI4463's asynchronous direct mode: TIM2 interrupts at
+// the data rate and the handler puts the next bit on the TX data pin, wired
+// to GPIO0 of the radio. There is no FIFO and no length limit, the bits go
+// out as long as the data (and the refill callback) provide them.
+
+// The prescaler is chosen at the fastest timer clock (72 MHz) and kept over
+// clock profile switches, only the reload value follows the timer clock
+#define DIRECT_TX_TIMER_MAX_HZ 72000000U
+
+// Next chunk of the bitstream, called from the timer interrupt when the
+// current one is used up. Returns its length, 0 ends the transmission.
+typedef uint16_t (*DirectTx_Refill_t)(void *ctx, const uint8_t **data);
+
+void DirectTx_Init(GPIO_TypeDef *port, uint16_t pin);
+bool DirectTx_Start(const uint8_t *data, uint16_t len, uint8_t preambleByte, uint16_t preambleLen,
+                    uint16_t baudRate, bool invert);
+void DirectTx_SetRefill(DirectTx_Refill_t refill, void *ctx);
+void DirectTx_Stop(void);
+bool DirectTx_IsActive(void);
+uint32_t DirectTx_GetBitsSent(void);
+
+// Called by Clock_SetProfile() once the bus clocks have changed
+void DirectTx_ClockChanged(void);
+
+// Called from TIM2_IRQHandler
+void DirectTx_IRQHandler(void);
+
+#endif // DIRECT_TX_H
@@ -0,0 +1,33 @@
+/*
+ * directory.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef DIRECTORY_H
+#define DIRECTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Subscriber directory: pagers known by an alias, so a page does not need
+// the RIC and its details. The entries are listed in Core/Src/directory.txt
+// and turned into a table sorted by alias (Core/Inc/directory_table.h) by
+// Host/pocsag_directory, the table stays in flash.
+#define DIRECTORY_ALIAS_MAX 16
+
+typedef struct {
+    const char* alias;      // lower case, aliases are not case sensitive
+    long address;
+    int source;
+    bool numeric;           // numeric pager, pages are sent as digits
+    uint16_t baud;          // data rate the pager listens on, 512 or 1200
+} Directory_Entry_t;
+
+// Function prototypes
+int Directory_GetCount(void);
+const Directory_Entry_t* Directory_Get(int index);
+const Directory_Entry_t* Directory_Find(const char* alias);
+
+#endif // DIRECTORY_H
@@ -0,0 +1,25 @@
+/*
+ * directory_table.h
+ *
+ *  Generated by pocsag_directory from directory.txt, do not edit. After
+ *  changing the list run:
+ *  ./build/pocsag_directory Core/Src/directory.txt Core/Inc/directory_table.h
+ */
+
+#ifndef DIRECTORY_TABLE_H
+#define DIRECTORY_TABLE_H
+
+#include "directory.h"
+
+#define DIRECTORY_TABLE_SIZE 5
+
+// Sorted by alias for Directory_Find()
+static const Directory_Entry_t directoryTable[] = {
+    {"alarm", 123456, 3, false, 1200},
+    {"engineer", 200008, 0, false, 1200},
+    {"gate", 300000, 1, true, 512},
+    {"oncall", 123456, 0, false, 1200},
+    {"workshop", 200016, 0, true, 512},
+};
+
+#endif // DIRECTORY_TABLE_H
@@ -0,0 +1,39 @@
+/*
+ * events.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Event flags, set from interrupt context and consumed by the main loop
+#define EVENT_UART_RX       (1UL << 0)  // byte(s) waiting in the UART receive ring
+#define EVENT_RADIO_IRQ     (1UL << 1)  // SI4463 nIRQ asserted (or radio poll tick)
+#define EVENT_TX_NEXT       (1UL << 2)  // repeat gap or duty-cycle deferral elapsed
+#define EVENT_PAGE_QUEUE    (1UL << 3)  // radio free, next queued page can be encoded
+#define EVENT_RX_PAGE       (1UL << 4)  // channel monitor decoded a page
+#define EVENT_REPEAT        (1UL << 5)  // repeater gather time elapsed
+#define EVENT_GROUP         (1UL << 6)  // page grouping hold time elapsed
+
+// Number of software timers driven from SysTick
+#define EVENTS_MAX_TIMERS 4
+
+void Events_Init(void);
+void Events_Set(uint32_t events);
+uint32_t Events_Take(void);
+uint32_t Events_Wait(void);
+
+// One-shot software timers: the timer is identified by the event it raises
+void Events_StartTimer(uint32_t event, uint32_t delay_ms);
+void Events_StopTimer(uint32_t event);
+bool Events_TimerActive(uint32_t event);
+
+// Called from SysTick_Handler every millisecond
+void Events_TickFromISR(void);
+
+#endif // EVENTS_H
@@ -0,0 +1,44 @@
+/*
+ * lbt.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef LBT_H
+#define LBT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Listen before talk: a transmission only starts when the RSSI on the
+// channel is below the threshold, otherwise it backs off for a random number
+// of slots. The window doubles with every busy assessment of the same
+// transmission, up to LBT_MAX_WINDOW slots.
+#define LBT_DEFAULT_THRESHOLD_DBM -90
+#define LBT_MIN_THRESHOLD_DBM     -130
+#define LBT_MAX_THRESHOLD_DBM     -20
+#define LBT_SLOT_MS               50
+#define LBT_MAX_WINDOW            32
+
+// Busy assessments before transmitting anyway, a stuck carrier must not hold
+// the queue forever
+#define LBT_MAX_ATTEMPTS          8
+
+typedef struct {
+    uint32_t checks;
+    uint32_t busy;
+    uint32_t gaveUp;              // transmitted on a busy channel after LBT_MAX_ATTEMPTS
+    uint32_t deferredMs;          // total backoff
+    int lastRssi;                 // dBm
+} Lbt_Stats_t;
+
+void Lbt_Init(uint32_t seed);
+void Lbt_SetEnabled(bool on);
+bool Lbt_IsEnabled(void);
+void Lbt_SetThreshold(int dBm);
+int Lbt_GetThreshold(void);
+uint32_t Lbt_Assess(int rssiDbm);
+const Lbt_Stats_t* Lbt_GetStats(void);
+
+#endif // LBT_H
@@ -0,0 +1,35 @@
+/*
+ * pagequeue.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef PAGEQUEUE_H
+#define PAGEQUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PAGEQUEUE_LEN 8
+
+// A page waiting to be encoded and transmitted
+typedef struct {
+    long address;
+    int source;
+    int repeat;
+    bool timed;       // pipeline timing already started at the command line
+    int canned;       // canned message number, -1 = encode the text
+    bool numeric;     // text holds digits for a numeric pager
+    uint16_t baud;    // data rate of the pager, 512 or 1200
+    char text[41];    // up to 40 chars + terminating \0
+} Page_t;
+
+void PageQueue_Init(void);
+bool PageQueue_Push(const Page_t* page);
+bool PageQueue_Pop(Page_t* page);
+bool PageQueue_PeekBaud(Page_t* page, uint16_t baud);
+bool PageQueue_PopBaud(Page_t* page, uint16_t baud);
+int PageQueue_Count(void);
+
+#endif // PAGEQUEUE_H
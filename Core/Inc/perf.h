@@ -0,0 +1,45 @@
+/*
+ * perf.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Page pipeline stages, each measured from the previous mark
+typedef enum {
+    PERF_STAGE_PARSE = 0,    // command line complete -> parsed (incl. echo output)
+    PERF_STAGE_QUEUE,        // parsed -> taken from the queue (grouping hold)
+    PERF_STAGE_ENCODE,       // taken from the queue -> POCSAG message encoded
+    PERF_STAGE_FIFO_LOAD,    // encoded -> TX FIFO pre-loaded
+    PERF_STAGE_TX_START,     // FIFO loaded -> START_TX accepted
+    PERF_STAGE_TX_END,       // START_TX -> packet sent
+    PERF_STAGE_TO_AIR,       // command line complete -> START_TX (derived)
+    PERF_STAGE_COUNT
+} Perf_Stage;
+
+// log2 histogram: bucket n counts durations of [2^n, 2^(n+1)) microseconds
+#define PERF_HIST_BUCKETS 24
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint16_t hist[PERF_HIST_BUCKETS];
+} Perf_Stats_t;
+
+void Perf_Init(void);
+void Perf_Reset(void);
+void Perf_BeginPage(void);
+void Perf_Mark(Perf_Stage stage);
+void Perf_ClockChanging(void);
+const Perf_Stats_t* Perf_GetStats(Perf_Stage stage);
+const char* Perf_GetStageName(Perf_Stage stage);
+
+#endif // PERF_H
@@ -0,0 +1,53 @@
+/*
+ * pocsag_bench.h
+ *
+ *  Encoder benchmark, compiled in with -DPOCSAG_BENCH. On the target the
+ *  B command runs it with DWT cycle timing, Host/pocsag_bench_main.c runs
+ *  the same mixes natively.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef POCSAG_BENCH_H
+#define POCSAG_BENCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define POCSAG_BENCH_MAXLEN 40
+
+// Number of pages in one sweep: every length x frame x invert x batch2 option
+#define POCSAG_BENCH_SWEEP ((POCSAG_BENCH_MAXLEN + 1) * 8 * 2 * 3)
+
+// Traffic mix
+typedef struct {
+    const char *name;
+    uint8_t minLen;
+    uint8_t maxLen;
+    int8_t batch2;          // -1 = random option
+    int8_t invert;          // -1 = random polarity
+    bool sweep;             // walk all length/frame/option combinations in turn
+} PocsagBench_Mix_t;
+
+typedef struct {
+    uint32_t pages;
+    uint32_t codewords;
+    uint64_t ticks;
+    uint32_t minTicks;
+    uint32_t maxTicks;
+    uint32_t stackBytes;    // deepest stack use of Pocsag_CreatePocsag
+    uint64_t lenTicks[POCSAG_BENCH_MAXLEN + 1];
+    uint32_t lenPages[POCSAG_BENCH_MAXLEN + 1];
+} PocsagBench_Result_t;
+
+extern const PocsagBench_Mix_t PocsagBench_Mixes[];
+extern const int PocsagBench_MixCount;
+
+void PocsagBench_Run(const PocsagBench_Mix_t *mix, uint32_t pages, uint32_t seed, PocsagBench_Result_t *result);
+
+// Platform timer: free running tick counter and its rate
+uint32_t PocsagBench_GetTicks(void);
+uint32_t PocsagBench_GetTickRate(void);
+
+#endif // POCSAG_BENCH_H
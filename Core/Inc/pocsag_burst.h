@@ -0,0 +1,37 @@
+/*
+ * pocsag_burst.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef POCSAG_BURST_H
+#define POCSAG_BURST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "Pocsag.h"
+
+// Several messages in one transmission: one preamble, then as many batches
+// as the messages need. Each address codeword goes into the frame of its
+// address, message codewords follow back to back across batches.
+#define POCSAG_BURST_MAX_BATCHES 8
+#define POCSAG_BURST_PREAMBLE    POCSAG_MSG_PREAMBLE    // as Pocsag_CreatePocsag
+#define POCSAG_BURST_BATCHSIZE   68    // sync codeword + 16 codewords
+#define POCSAG_BURST_MAXSIZE     (POCSAG_BURST_PREAMBLE + POCSAG_BURST_MAX_BATCHES * POCSAG_BURST_BATCHSIZE)
+
+typedef struct {
+    uint8_t data[POCSAG_BURST_MAXSIZE];
+    int batches;
+    int used;           // codeword slots used, counted from the first batch
+    int messages;
+    bool invert;
+} PocsagBurst_t;
+
+// Function prototypes
+void PocsagBurst_Init(PocsagBurst_t* burst, bool invert);
+bool PocsagBurst_Add(PocsagBurst_t* burst, long address, const uint32_t* codewords, int count);
+int PocsagBurst_GetSize(PocsagBurst_t* burst);
+uint8_t* PocsagBurst_GetData(PocsagBurst_t* burst);
+
+#endif // POCSAG_BURST_H
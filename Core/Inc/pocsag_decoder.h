@@ -0,0 +1,80 @@
+/*
+ * pocsag_decoder.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef POCSAG_DECODER_H
+#define POCSAG_DECODER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Longest text kept per message (two batches hold at most 91 characters)
+#define POCSAG_DECODER_MAXTEXT 96
+
+// Sync codeword bit errors tolerated while searching
+#define POCSAG_DECODER_SYNC_ERRORS 2
+
+// Corrected codewords kept per message, address included
+#define POCSAG_DECODER_MAXCW 40
+
+// Decoded message
+typedef struct {
+    long address;                 // 21 bit pager address
+    int function;                 // function bits (the encoder's "source")
+    bool inverted;                // received with inverted polarity
+    int codewords;                // message codewords, address excluded
+    int corrected;                // bit errors corrected
+    int uncorrectable;            // codewords dropped
+    char text[POCSAG_DECODER_MAXTEXT + 1];     // alphanumeric interpretation
+    char numeric[POCSAG_DECODER_MAXTEXT + 1];  // numeric interpretation
+    bool isNumeric;               // the text interpretation is not a clean alphanumeric message
+    uint32_t raw[POCSAG_DECODER_MAXCW];        // corrected codewords, address first, not inverted
+    int rawCount;
+} PocsagDecoder_Message_t;
+
+typedef struct {
+    uint32_t bits;
+    uint32_t syncs;
+    uint32_t codewords;
+    uint32_t corrected;           // bit errors corrected
+    uint32_t uncorrectable;       // codewords with more than 2 bit errors
+    uint32_t messages;
+} PocsagDecoder_Stats_t;
+
+// Decoder context
+typedef struct {
+    uint32_t shift;               // last 32 received bits
+    int state;
+    int bitCount;                 // bits of the current codeword received
+    int cwIndex;                  // codeword position in the batch
+    bool inverted;
+
+    bool inMessage;
+    uint32_t alphaBits;           // pending bits of the text interpretation
+    int alphaCount;
+    bool alphaDone;               // EOT seen
+    bool alphaEnded;              // text terminated by EOT or ETX and followed by padding only
+    bool alphaPrintable;          // no control characters in the text
+    int textLen;
+    int numericLen;
+    PocsagDecoder_Message_t msg;
+
+    PocsagDecoder_Stats_t stats;
+    void (*onMessage)(void *ctx, const PocsagDecoder_Message_t *msg);
+    void *ctx;
+} PocsagDecoder_t;
+
+// Function prototypes
+void PocsagDecoder_Init(PocsagDecoder_t* dec, void (*onMessage)(void *ctx, const PocsagDecoder_Message_t *msg), void *ctx);
+void PocsagDecoder_PushBit(PocsagDecoder_t* dec, int bit);
+void PocsagDecoder_PushBytes(PocsagDecoder_t* dec, const uint8_t *data, int len);
+void PocsagDecoder_Flush(PocsagDecoder_t* dec);
+void PocsagDecoder_Sync(PocsagDecoder_t* dec, bool inverted);
+int PocsagDecoder_CorrectCodeword(uint32_t *cw);
+const PocsagDecoder_Stats_t* PocsagDecoder_GetStats(PocsagDecoder_t* dec);
+const char* PocsagDecoder_GetText(const PocsagDecoder_Message_t* msg);
+
+#endif // POCSAG_DECODER_H
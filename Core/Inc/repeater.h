@@ -0,0 +1,61 @@
+/*
+ * repeater.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef REPEATER_H
+#define REPEATER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pocsag_decoder.h"
+#include "pocsag_burst.h"
+
+// Received messages waiting to be repeated
+#define REPEATER_STORE_LEN     8
+
+// RIC ranges to repeat, none = every address
+#define REPEATER_MAX_RANGES    4
+
+// Quiet time on the input before the stored messages are sent, so the source
+// transmission has ended and everything it carried goes out in one burst.
+// Longer than the rest of a batch plus the next preamble at 1200 baud, so
+// back to back transmissions of the source are gathered as one.
+#define REPEATER_GATHER_MS     1500
+
+// A message heard again within this time (source repeats) is not repeated twice
+#define REPEATER_DEDUP_MS      30000
+#define REPEATER_DEDUP_LEN     8
+
+typedef struct {
+    long first;
+    long last;
+} Repeater_Range_t;
+
+typedef struct {
+    uint32_t received;
+    uint32_t filtered;            // address outside the RIC ranges
+    uint32_t duplicates;
+    uint32_t damaged;             // uncorrectable or too long to keep
+    uint32_t dropped;             // store full
+    uint32_t forwarded;
+    uint32_t bursts;
+} Repeater_Stats_t;
+
+void Repeater_Init(void);
+void Repeater_SetEnabled(bool on);
+bool Repeater_IsEnabled(void);
+bool Repeater_AddRange(long first, long last);
+void Repeater_ClearRanges(void);
+int Repeater_GetRangeCount(void);
+const Repeater_Range_t* Repeater_GetRange(int index);
+bool Repeater_Offer(const PocsagDecoder_Message_t* msg);
+void Repeater_ChannelActive(void);
+int Repeater_Pending(void);
+bool Repeater_IsReady(void);
+int Repeater_BuildBurst(PocsagBurst_t* burst);
+const Repeater_Stats_t* Repeater_GetStats(void);
+
+#endif // REPEATER_H
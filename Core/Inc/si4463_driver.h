@@ -12,25 +12,115 @@
 #include <stdbool.h>
 #include "main.h"
 
-// STM32 HAL version - simplified for single instance
-void Si4463_Init(SPI_HandleTypeDef *hspi, GPIO_TypeDef* sdn_port, uint16_t sdn_pin,
+// Properties remembered per radio, further writes go straight through
+#define SI4463_SHADOW_SIZE 32
+
+// A property value the radio is known to hold
+typedef struct {
+    uint8_t group;
+    uint8_t index;
+    uint8_t value;
+} Si4463_Property_t;
+
+// Called as soon as the radio has taken START_TX
+typedef void (*Si4463_TxStartHook_t)(void *ctx);
+
+// One SI4463 module, every call takes the radio it talks to
+typedef struct {
+    // STM32 HAL handles
+    SPI_HandleTypeDef *hspi;
+    GPIO_TypeDef* sdnPort;
+    uint16_t sdnPin;
+    GPIO_TypeDef* nirqPort;
+    uint16_t nirqPin;
+    GPIO_TypeDef* csPort;
+    uint16_t csPin;
+
+    // Transmit state, the FIFO is refilled from txData while on air
+    const uint8_t *txData;
+    uint16_t txLen;
+    uint16_t txPos;
+    bool txActive;
+    uint32_t txStartTick;
+    uint32_t txTimeoutMs;
+    uint16_t currentBaud;
+    uint8_t preambleLen;    // bytes the packet handler sends ahead of the FIFO data
+    bool preambleInverted;  // 0x55 preamble instead of 0xAA
+    bool txDirect;          // current transmission is clocked onto GPIO0 by DirectTx
+    bool txInvert;          // modem inverts the transmitted data
+    Si4463_TxStartHook_t txStartHook;
+    void *txStartCtx;
+
+    // Continuous transmission: Si4463_AppendTx() queues the next chunk while on air
+    bool txStream;          // open-ended packet, cut once the data has run out
+    bool txClosing;         // no more chunks, the tail follows the data
+    const uint8_t *txNextData;
+    uint16_t txNextLen;
+    uint16_t txTotal;       // FIFO bytes of the transmission so far
+    uint8_t txTail;         // alternating bits behind the data, slack for the cut
+
+    // SDN released to configuration replayed, measured by Si4463_Init()
+    uint32_t bootMs;
+
+    // Receive state
+    bool rxActive;
+
+    // Shadow of the properties written since reset, unchanged bytes are not resent
+    Si4463_Property_t shadow[SI4463_SHADOW_SIZE];
+    uint8_t shadowCount;
+    uint32_t propSent;      // property bytes written to the radio
+    uint32_t propSkipped;   // property bytes that already held the value
+} Si4463_t;
+
+// Returns false, leaving the radio unconfigured, when no SI4463 answers
+bool Si4463_Init(Si4463_t *radio, SPI_HandleTypeDef *hspi, GPIO_TypeDef* sdn_port, uint16_t sdn_pin,
                  GPIO_TypeDef* nirq_port, uint16_t nirq_pin,
                  GPIO_TypeDef* cs_port, uint16_t cs_pin);
-void Si4463_Reset(void);
-void Si4463_Configure(void);
-void Si4463_Write(uint8_t *data, uint8_t len);
-void Si4463_Read(uint8_t *cmd, uint8_t cmdLen, uint8_t *data, uint8_t dataLen);
-void Si4463_SetFrequency(float freq);
-void Si4463_StartRx(void);
-bool Si4463_ReadRxFifo(uint8_t *data, uint8_t len);
-void Si4463_GetIntStatus(uint8_t *intStatus);
-void Si4463_ClearInt(void);
-uint8_t Si4463_GetFifoInfo(void);
-bool Si4463_IsNIRQActive(void);
+bool Si4463_Probe(Si4463_t *radio);
+bool Si4463_Reset(Si4463_t *radio);
+void Si4463_Configure(Si4463_t *radio);
+void Si4463_Write(Si4463_t *radio, uint8_t *data, uint8_t len);
+void Si4463_Read(Si4463_t *radio, uint8_t *cmd, uint8_t cmdLen, uint8_t *data, uint8_t dataLen);
+bool Si4463_Command(Si4463_t *radio, uint8_t *cmd, uint8_t cmdLen, uint8_t *resp, uint8_t respLen);
+void Si4463_SetFrequency(Si4463_t *radio, float freq);
+bool Si4463_SetProperties(Si4463_t *radio, uint8_t group, uint8_t start, const uint8_t *values, uint8_t count);
+void Si4463_InvalidateProperties(Si4463_t *radio);
+bool Si4463_ReadRxFifo(Si4463_t *radio, uint8_t *data, uint8_t len);
+void Si4463_GetIntStatus(Si4463_t *radio, uint8_t *intStatus);
+void Si4463_ClearInt(Si4463_t *radio);
+uint8_t Si4463_GetFifoInfo(Si4463_t *radio);
+uint8_t Si4463_GetTxFifoSpace(Si4463_t *radio);
+bool Si4463_IsNIRQActive(Si4463_t *radio);
 
 // POCSAG-specific functions
-void Si4463_ConfigureForPOCSAG(void);
-void Si4463_TransmitPOCSAG(uint8_t *data, uint16_t len);
-void Si4463_SetPOCSAGDataRate(uint16_t baudRate);
+void Si4463_ConfigureForPOCSAG(Si4463_t *radio);
+void Si4463_TransmitPOCSAG(Si4463_t *radio, uint8_t *data, uint16_t len);
+void Si4463_SetPOCSAGDataRate(Si4463_t *radio, uint16_t baudRate);
+void Si4463_SetPreamble(Si4463_t *radio, uint8_t lengthBytes, bool inverted);
+void Si4463_SetTxInvert(Si4463_t *radio, bool invert);
+
+// Non-blocking transmit, driven by nIRQ events from the main loop
+bool Si4463_LoadTx(Si4463_t *radio, const uint8_t *data, uint16_t len);
+bool Si4463_StartTx(Si4463_t *radio);
+bool Si4463_StartTransmit(Si4463_t *radio, const uint8_t *data, uint16_t len);
+bool Si4463_StartStreamTx(Si4463_t *radio);
+bool Si4463_StartDirectTx(Si4463_t *radio, const uint8_t *data, uint16_t len);
+void Si4463_SetTxStartHook(Si4463_t *radio, Si4463_TxStartHook_t hook, void *ctx);
+bool Si4463_AppendTx(Si4463_t *radio, const uint8_t *data, uint16_t len);
+bool Si4463_IsTxPending(Si4463_t *radio);
+bool Si4463_ServiceTx(Si4463_t *radio);
+bool Si4463_IsTransmitting(Si4463_t *radio);
+uint32_t Si4463_GetAirtimeMs(Si4463_t *radio, uint16_t len);
+uint32_t Si4463_GetAirtimeMsAt(Si4463_t *radio, uint16_t len, uint16_t baudRate);
+
+// Streaming receive, driven by nIRQ events from the main loop
+#define SI4463_RX_PACKET_END 0x01  // radio went back to hunting for a sync word
+#define SI4463_RX_OVERFLOW   0x02  // RX FIFO overflowed, data was lost
+
+bool Si4463_StartRx(Si4463_t *radio, uint32_t syncWord);
+void Si4463_StopRx(Si4463_t *radio);
+uint8_t Si4463_ServiceRx(Si4463_t *radio, uint8_t *data, uint8_t maxLen, uint8_t *events);
+bool Si4463_IsReceiving(Si4463_t *radio);
+bool Si4463_MeasureRssi(Si4463_t *radio, int *rssiDbm);
 
 #endif // SI4463_DRIVER_H
@@ -0,0 +1,75 @@
+/*
+ * si4463_trace.h
+ *
+ *  SPI transaction trace of the SI4463 driver, compiled in with
+ *  -DSI4463_TRACE. Every chip-select frame the driver issues is recorded
+ *  in a RAM ring that the T command dumps, Host/pocsag_trace.c turns a
+ *  dump into a command timeline and per-command latency figures.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef SI4463_TRACE_H
+#define SI4463_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "main.h"
+
+// Transactions kept, the oldest are overwritten
+#ifndef SI4463_TRACE_DEPTH
+#define SI4463_TRACE_DEPTH 64
+#endif
+
+// Transaction types
+#define SI4463_TRACE_WRITE    'W'   // plain write frame (FIFO data, raw commands)
+#define SI4463_TRACE_READ     'R'   // write-then-read frame
+#define SI4463_TRACE_COMMAND  'C'   // command followed by CTS polling
+#define SI4463_TRACE_TIMEOUT  'X'   // command that never got CTS
+
+typedef struct {
+    uint32_t timeUs;    // start of the transaction since Si4463Trace_Init()
+    uint32_t totalUs;   // first chip select to the end of the frame (or to CTS)
+    uint32_t ctsUs;     // time spent polling for CTS
+    uint16_t polls;     // READ_CMD_BUFF frames until CTS
+    uint8_t cmd;        // first byte written
+    uint8_t len;        // bytes written, including the command
+    uint8_t resp;       // bytes read
+    uint8_t type;       // SI4463_TRACE_*
+    uint8_t bus;        // SPI bus number
+} Si4463Trace_Entry_t;
+
+#ifdef SI4463_TRACE
+
+void Si4463Trace_Init(void);
+void Si4463Trace_Clear(void);
+void Si4463Trace_ClockChanging(void);
+
+// Cycle counter value the driver takes at the start of a transaction
+static inline uint32_t Si4463Trace_Cycles(void) {
+    return DWT->CYCCNT;
+}
+
+void Si4463Trace_Record(SPI_HandleTypeDef *hspi, uint8_t type, uint8_t cmd, uint8_t len, uint8_t resp,
+                        uint32_t startCycles, uint32_t ctsCycles, uint16_t polls);
+
+// Recorded transactions, index 0 is the oldest
+uint16_t Si4463Trace_GetCount(void);
+uint32_t Si4463Trace_GetLost(void);
+const Si4463Trace_Entry_t* Si4463Trace_Get(uint16_t index);
+
+#else
+
+// Without SI4463_TRACE the driver's hooks compile to nothing
+static inline uint32_t Si4463Trace_Cycles(void) {
+    return 0;
+}
+
+static inline void Si4463Trace_Record(SPI_HandleTypeDef *hspi, uint8_t type, uint8_t cmd, uint8_t len, uint8_t resp,
+                                      uint32_t startCycles, uint32_t ctsCycles, uint16_t polls) {
+}
+
+#endif // SI4463_TRACE
+
+#endif // SI4463_TRACE_H
@@ -0,0 +1,31 @@
+/*
+ * uart_tx.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "main.h"
+
+// Interrupt driven UART output: writes are copied into a ring and sent from
+// the UART interrupt, a print costs the copy instead of about 1 ms per
+// character at 9600 baud. A full ring makes the writer wait for room.
+#define UART_TX_RINGLEN 512
+
+void UartTx_Init(UART_HandleTypeDef *huart);
+void UartTx_Write(const uint8_t *data, uint16_t len);
+
+// Hold the output across a baud rate change: no further byte is loaded and
+// the one in the shift register gets up to timeoutMs to leave
+void UartTx_Pause(uint32_t timeoutMs);
+void UartTx_Resume(void);
+
+// Called from HAL_UART_TxCpltCallback()
+void UartTx_TxComplete(UART_HandleTypeDef *huart);
+
+#endif // UART_TX_H
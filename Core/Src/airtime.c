@@ -0,0 +1,122 @@
+/*
+ * airtime.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "airtime.h"
+#include "main.h"
+#include <string.h>
+
+// Milliseconds on air per bucket, buckets[currentBucket] is the running minute
+static uint32_t buckets[AIRTIME_BUCKETS];
+static uint32_t currentBucket = 0;
+static uint32_t currentBucketStart = 0;
+
+static uint8_t limit = AIRTIME_DEFAULT_LIMIT_PERCENT;
+static bool txRunning = false;
+static uint32_t txStartTick = 0;
+
+// Private function prototypes
+static void airtime_advance(uint32_t now);
+
+// Initialize with a duty-cycle limit in percent (100 = no limit)
+void Airtime_Init(uint8_t limitPercent) {
+    memset(buckets, 0, sizeof(buckets));
+    currentBucket = 0;
+    currentBucketStart = HAL_GetTick();
+    txRunning = false;
+    Airtime_SetLimit(limitPercent);
+}
+
+void Airtime_SetLimit(uint8_t limitPercent) {
+    if (limitPercent == 0 || limitPercent > 100) {
+        limitPercent = 100;
+    }
+    limit = limitPercent;
+}
+
+uint8_t Airtime_GetLimit(void) {
+    return limit;
+}
+
+// Called when the radio starts transmitting
+void Airtime_TxStart(void) {
+    txRunning = true;
+    txStartTick = HAL_GetTick();
+}
+
+// Called when the radio reports the end of a transmission
+void Airtime_TxEnd(void) {
+    uint32_t now = HAL_GetTick();
+
+    if (!txRunning) return;
+    txRunning = false;
+
+    // booked in the minute it ended, which keeps it in the window slightly longer
+    airtime_advance(now);
+    buckets[currentBucket] += now - txStartTick;
+}
+
+// Airtime used in the last hour
+uint32_t Airtime_GetUsedMs(void) {
+    uint32_t used = 0;
+
+    airtime_advance(HAL_GetTick());
+    for (uint32_t i = 0; i < AIRTIME_BUCKETS; i++) {
+        used += buckets[i];
+    }
+    return used;
+}
+
+// Airtime allowed per hour
+uint32_t Airtime_GetBudgetMs(void) {
+    return AIRTIME_WINDOW_MS / 100 * limit;
+}
+
+// Milliseconds to wait before a transmission of duration_ms stays within the
+// duty cycle: 0 if it may start now, AIRTIME_NEVER if it can never fit
+uint32_t Airtime_GetDeferral(uint32_t duration_ms) {
+    uint32_t now = HAL_GetTick();
+    uint32_t budget = Airtime_GetBudgetMs();
+    uint32_t used = Airtime_GetUsedMs();
+
+    if (limit >= 100) return 0;
+    if (duration_ms > budget) return AIRTIME_NEVER;
+    if (used + duration_ms <= budget) return 0;
+
+    // walk from the oldest bucket until enough airtime has left the window
+    uint32_t excess = used + duration_ms - budget;
+    uint32_t freed = 0;
+    for (uint32_t k = 0; k < AIRTIME_BUCKETS - 1; k++) {
+        uint32_t idx = (currentBucket + 1 + k) % AIRTIME_BUCKETS;
+
+        freed += buckets[idx];
+        if (freed >= excess) {
+            uint32_t expires = currentBucketStart + (k + 1) * AIRTIME_BUCKET_MS;
+            return expires - now;
+        }
+    }
+
+    // only the running minute is left, it expires a full window from now
+    return AIRTIME_WINDOW_MS;
+}
+
+// Private functions
+static void airtime_advance(uint32_t now) {
+    uint32_t elapsed = now - currentBucketStart;
+
+    if (elapsed >= AIRTIME_BUCKETS * AIRTIME_BUCKET_MS) {
+        // idle for more than the whole window
+        memset(buckets, 0, sizeof(buckets));
+        currentBucketStart = now - (elapsed % AIRTIME_BUCKET_MS);
+        return;
+    }
+
+    while (elapsed >= AIRTIME_BUCKET_MS) {
+        currentBucket = (currentBucket + 1) % AIRTIME_BUCKETS;
+        buckets[currentBucket] = 0;
+        currentBucketStart += AIRTIME_BUCKET_MS;
+        elapsed -= AIRTIME_BUCKET_MS;
+    }
+}
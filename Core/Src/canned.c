@@ -0,0 +1,71 @@
+/*
+ * canned.c
+ *
+ *  Generated by pocsag_canned from canned.txt, do not edit. After
+ *  changing the list run:
+ *  ./build/pocsag_canned Core/Src/canned.txt Core/Src/canned.c
+ */
+#include "canned.h"
+
+static const uint8_t canned0[] = {
+    CANNED_PREAMBLE
+    0x7C, 0xD2, 0x15, 0xD8,
+        0x07, 0x89, 0x05, 0x8B, 0x95, 0xA3, 0x93, 0xFC, 0xCA, 0x82, 0x08, 0xC4, 0xB0, 0x78, 0xD6, 0x55,
+        0x93, 0x40, 0x87, 0xC2, 0xA9, 0x9A, 0x30, 0x3C, 0x87, 0x2D, 0x12, 0xF9, 0x85, 0x27, 0x8B, 0x5E,
+        0xB9, 0xF2, 0x91, 0xD5, 0xE8, 0x90, 0x06, 0xE2, 0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97,
+        0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97,
+};
+
+static const uint8_t canned1[] = {
+    CANNED_PREAMBLE
+    0x7C, 0xD2, 0x15, 0xD8,
+        0x07, 0x89, 0x18, 0x2E, 0xE5, 0x92, 0x57, 0x83, 0xE8, 0x82, 0x82, 0x9C, 0xA6, 0x60, 0xA1, 0xB5,
+        0xDB, 0x2B, 0x86, 0x2F, 0x95, 0x98, 0x36, 0xDC, 0xA5, 0xCE, 0x51, 0xE8, 0x84, 0xC6, 0x0B, 0x98,
+        0xC9, 0x33, 0x57, 0xBF, 0xD2, 0xD1, 0x27, 0xF0, 0x80, 0x00, 0x07, 0x69, 0x7A, 0x89, 0xC1, 0x97,
+        0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97,
+};
+
+static const uint8_t canned2[] = {
+    CANNED_PREAMBLE
+    0x7C, 0xD2, 0x15, 0xD8,
+        0x07, 0x89, 0x18, 0x2E, 0xE5, 0x92, 0x57, 0x83, 0xE8, 0x82, 0x82, 0x9C, 0xA6, 0x60, 0xA1, 0xB5,
+        0xDB, 0x2B, 0x86, 0x2F, 0x95, 0x98, 0x36, 0xDC, 0xA5, 0xCE, 0x51, 0xE8, 0x84, 0x96, 0x89, 0xCE,
+        0xE5, 0x2B, 0xE3, 0x99, 0xD2, 0xD1, 0x27, 0xF0, 0xA4, 0x00, 0x00, 0x3B, 0x7A, 0x89, 0xC1, 0x97,
+        0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97,
+};
+
+static const uint8_t canned3[] = {
+    CANNED_PREAMBLE
+    0x7C, 0xD2, 0x15, 0xD8,
+        0x07, 0x89, 0x18, 0x2E, 0xE5, 0x92, 0x57, 0x83, 0xE8, 0x82, 0x82, 0x9C, 0xA6, 0x60, 0xA1, 0xB5,
+        0xDB, 0x2B, 0x86, 0x2F, 0x91, 0x1F, 0x3B, 0x0B, 0xE5, 0x28, 0x2F, 0x5A, 0xF2, 0x16, 0x8E, 0x50,
+        0xB9, 0x20, 0x02, 0xB9, 0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97,
+        0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97,
+};
+
+static const uint8_t canned4[] = {
+    CANNED_PREAMBLE
+    0x7C, 0xD2, 0x15, 0xD8,
+        0x07, 0x89, 0x18, 0x2E, 0xE5, 0x92, 0x57, 0x83, 0xE8, 0x82, 0x82, 0x9C, 0xA6, 0x60, 0xA1, 0xB5,
+        0xDB, 0x2B, 0x86, 0x2F, 0x90, 0x99, 0x3D, 0xDF, 0xC4, 0x48, 0x23, 0xC3, 0xAB, 0x46, 0xCF, 0x48,
+        0x85, 0xA2, 0x96, 0x82, 0xE0, 0x95, 0xAC, 0xCB, 0xA9, 0x68, 0x97, 0x24, 0x80, 0x00, 0x07, 0x69,
+        0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97, 0x7A, 0x89, 0xC1, 0x97,
+};
+
+static const Canned_t cannedMessages[] = {
+    {123456, 0, "TEST PAGE, PLEASE IGNORE", canned0, sizeof(canned0)},
+    {123456, 3, "SITE ALARM: MAINS FAILURE", canned1, sizeof(canned1)},
+    {123456, 3, "SITE ALARM: MAINS RESTORED", canned2, sizeof(canned2)},
+    {123456, 3, "SITE ALARM: DOOR OPEN", canned3, sizeof(canned3)},
+    {123456, 3, "SITE ALARM: HIGH TEMPERATURE", canned4, sizeof(canned4)},
+};
+
+int Canned_GetCount(void) {
+    return 5;
+}
+
+// Get a canned message, NULL for an unknown number
+const Canned_t* Canned_Get(int number) {
+    if (number < 0 || number >= Canned_GetCount()) return NULL;
+    return &cannedMessages[number];
+}
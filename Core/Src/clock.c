@@ -0,0 +1,191 @@
+/*
+ * clock.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "clock.h"
+#include "perf.h"
+#include "si4463_trace.h"
+#include "direct_tx.h"
+#include "uart_tx.h"
+
+// SI4463 SPI clock is limited to 10 MHz: SPI1 runs at 72 MHz / 8 = 9 MHz,
+// SPI2 at 36 MHz / 4 = 9 MHz, both at 8 MHz / 2 = 4 MHz on the HSI
+#define CLOCK_SPI_MAX_HZ 10000000U
+
+// Maximum time to wait for a pending UART byte before switching
+#define CLOCK_UART_DRAIN_TIMEOUT_MS 5
+
+// Peripherals whose dividers follow the bus clocks
+static SPI_HandleTypeDef *clock_hspi[CLOCK_MAX_SPI];
+static int clock_spiCount = 0;
+static UART_HandleTypeDef *clock_huart = NULL;
+
+// SystemClock_Config() starts from the HSI
+static Clock_Profile currentProfile = CLOCK_PROFILE_LOWPOWER;
+
+// Private function prototypes
+static bool clock_enterPerformance(void);
+static bool clock_enterLowPower(void);
+static void clock_updatePeripherals(void);
+static uint32_t clock_spiPrescaler(SPI_HandleTypeDef *hspi);
+
+// Register the peripherals that must be retimed on a profile switch
+void Clock_Init(SPI_HandleTypeDef *hspi, UART_HandleTypeDef *huart) {
+    clock_spiCount = 0;
+    clock_huart = huart;
+    currentProfile = CLOCK_PROFILE_LOWPOWER;
+    Clock_AddSpi(hspi);
+}
+
+// Register a further SPI bus, set up at the current profile's prescaler
+bool Clock_AddSpi(SPI_HandleTypeDef *hspi) {
+    if (!hspi || clock_spiCount >= CLOCK_MAX_SPI) {
+        return false;
+    }
+    clock_hspi[clock_spiCount++] = hspi;
+    clock_updatePeripherals();
+    return true;
+}
+
+// Get the active profile
+Clock_Profile Clock_GetProfile(void) {
+    return currentProfile;
+}
+
+// Switch the system clock profile, SysTick is reprogrammed by the HAL
+bool Clock_SetProfile(Clock_Profile profile) {
+    bool ok;
+
+    if (profile == currentProfile) {
+        return true;
+    }
+
+    // let the last UART byte leave the shift register, it would be garbled
+    // by the baud rate change otherwise
+    if (clock_huart) {
+        UartTx_Pause(CLOCK_UART_DRAIN_TIMEOUT_MS);
+    }
+
+    // convert pending cycle counts at the old core clock
+    Perf_ClockChanging();
+#ifdef SI4463_TRACE
+    Si4463Trace_ClockChanging();
+#endif
+
+    if (profile == CLOCK_PROFILE_PERFORMANCE) {
+        ok = clock_enterPerformance();
+    } else {
+        ok = clock_enterLowPower();
+    }
+
+    if (ok) {
+        currentProfile = profile;
+    }
+
+    // bus clocks may have changed even on a partial failure
+    clock_updatePeripherals();
+    DirectTx_ClockChanged();
+    if (clock_huart) {
+        UartTx_Resume();
+    }
+
+    return ok;
+}
+
+// Private functions
+static bool clock_enterPerformance(void) {
+    RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+    RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+    // 8 MHz HSE x 9 = 72 MHz
+    RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+    RCC_OscInitStruct.HSEState = RCC_HSE_ON;
+    RCC_OscInitStruct.HSEPredivValue = RCC_HSE_PREDIV_DIV1;
+    RCC_OscInitStruct.PLL.PLLState = RCC_PLL_ON;
+    RCC_OscInitStruct.PLL.PLLSource = RCC_PLLSOURCE_HSE;
+    RCC_OscInitStruct.PLL.PLLMUL = RCC_PLL_MUL9;
+    if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
+        return false;
+    }
+
+    // APB1 is limited to 36 MHz
+    RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK
+                                | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
+    RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_PLLCLK;
+    RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+    RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV2;
+    RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
+
+    // 2 wait states above 48 MHz, raised by the HAL before the switch
+    if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_2) != HAL_OK) {
+        return false;
+    }
+
+    return true;
+}
+
+static bool clock_enterLowPower(void) {
+    RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+    RCC_ClkInitTypeDef RCC_ClkInitStruct = {0};
+
+    // move SYSCLK back to the HSI first, wait states are lowered after the switch
+    RCC_ClkInitStruct.ClockType = RCC_CLOCKTYPE_HCLK | RCC_CLOCKTYPE_SYSCLK
+                                | RCC_CLOCKTYPE_PCLK1 | RCC_CLOCKTYPE_PCLK2;
+    RCC_ClkInitStruct.SYSCLKSource = RCC_SYSCLKSOURCE_HSI;
+    RCC_ClkInitStruct.AHBCLKDivider = RCC_SYSCLK_DIV1;
+    RCC_ClkInitStruct.APB1CLKDivider = RCC_HCLK_DIV1;
+    RCC_ClkInitStruct.APB2CLKDivider = RCC_HCLK_DIV1;
+    if (HAL_RCC_ClockConfig(&RCC_ClkInitStruct, FLASH_LATENCY_0) != HAL_OK) {
+        return false;
+    }
+
+    // stop the PLL before its HSE source
+    RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_NONE;
+    RCC_OscInitStruct.PLL.PLLState = RCC_PLL_OFF;
+    if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
+        return false;
+    }
+
+    RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_HSE;
+    RCC_OscInitStruct.HSEState = RCC_HSE_OFF;
+    RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
+    if (HAL_RCC_OscConfig(&RCC_OscInitStruct) != HAL_OK) {
+        return false;
+    }
+
+    return true;
+}
+
+// Recalculate SPI prescalers and UART baud rate register for the new bus clocks
+static void clock_updatePeripherals(void) {
+    for (int i = 0; i < clock_spiCount; i++) {
+        uint32_t prescaler = clock_spiPrescaler(clock_hspi[i]);
+
+        if (clock_hspi[i]->Init.BaudRatePrescaler != prescaler) {
+            clock_hspi[i]->Init.BaudRatePrescaler = prescaler;
+            HAL_SPI_Init(clock_hspi[i]);
+        }
+    }
+
+    if (clock_huart) {
+        // write BRR directly, HAL_UART_Init() would abort the pending RX interrupt transfer
+        clock_huart->Instance->BRR = UART_BRR_SAMPLING16(HAL_RCC_GetPCLK2Freq(),
+                                                         clock_huart->Init.BaudRate);
+    }
+}
+
+// Smallest divider keeping the SPI clock within CLOCK_SPI_MAX_HZ, SPI1 is on APB2, SPI2 on APB1
+static uint32_t clock_spiPrescaler(SPI_HandleTypeDef *hspi) {
+    uint32_t pclk = (hspi->Instance == SPI1) ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+    uint32_t prescaler = SPI_BAUDRATEPRESCALER_2;
+    uint32_t div = 2;
+
+    // the BR field steps by SPI_BAUDRATEPRESCALER_4 per doubling
+    while (pclk / div > CLOCK_SPI_MAX_HZ && prescaler != SPI_BAUDRATEPRESCALER_256) {
+        prescaler += SPI_BAUDRATEPRESCALER_4;
+        div *= 2;
+    }
+    return prescaler;
+}
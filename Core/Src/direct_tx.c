@@ -0,0 +1,197 @@
+/*
+ * direct_tx.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "direct_tx.h"
+#include "events.h"
+
+// TX data pin
+static GPIO_TypeDef *dataPort = NULL;
+static uint16_t dataPin = 0;
+
+// Bitstream: preamble bytes, then the data and whatever the refill callback adds
+static const uint8_t *txData = NULL;
+static uint16_t txLen = 0;
+static uint16_t txPos = 0;
+static uint8_t txMask = 0;          // next bit of txData[txPos], 0 = fetch the next byte
+static uint8_t txByte = 0;
+static uint8_t preambleByte = 0;
+static uint16_t preambleLeft = 0;
+static uint8_t invertMask = 0;
+static DirectTx_Refill_t refill = NULL;
+static void *refillCtx = NULL;
+
+static volatile bool active = false;
+static volatile uint32_t bitsSent = 0;
+static uint16_t baud = 0;
+
+// Private function prototypes
+static bool directtx_nextByte(void);
+static uint32_t directtx_timerHz(void);
+static uint32_t directtx_reload(uint32_t prescaler);
+static void directtx_stopTimer(void);
+
+void DirectTx_Init(GPIO_TypeDef *port, uint16_t pin) {
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    dataPort = port;
+    dataPin = pin;
+
+    HAL_GPIO_WritePin(port, pin, GPIO_PIN_RESET);
+    GPIO_InitStruct.Pin = pin;
+    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+    HAL_GPIO_Init(port, &GPIO_InitStruct);
+
+    __HAL_RCC_TIM2_CLK_ENABLE();
+    HAL_NVIC_SetPriority(TIM2_IRQn, 0, 0);
+    HAL_NVIC_EnableIRQ(TIM2_IRQn);
+}
+
+// Start clocking out preambleLen bytes of preambleByte followed by len bytes
+// of data, MSB first, at baudRate. invert flips every bit on the way out.
+// The data must stay valid until DirectTx_IsActive() returns false.
+bool DirectTx_Start(const uint8_t *data, uint16_t len, uint8_t preamble, uint16_t preambleLen,
+                    uint16_t baudRate, bool invert) {
+    if (!dataPort || active || baudRate == 0 || (len == 0 && preambleLen == 0)) {
+        return false;
+    }
+
+    txData = data;
+    txLen = data ? len : 0;
+    txPos = 0;
+    txMask = 0;
+    preambleByte = preamble;
+    preambleLeft = preambleLen;
+    invertMask = invert ? 0xFF : 0x00;
+    baud = baudRate;
+    bitsSent = 0;
+    if (!directtx_nextByte()) {
+        return false;
+    }
+
+    // the prescaler only loads on an update event, force one with URS set
+    // so it does not raise the interrupt
+    uint32_t prescaler = (DIRECT_TX_TIMER_MAX_HZ / baud - 1) / 0x10000;
+    TIM2->CR1 = TIM_CR1_URS;
+    TIM2->PSC = prescaler;
+    TIM2->ARR = directtx_reload(prescaler);
+    TIM2->EGR = TIM_EGR_UG;
+    TIM2->SR = 0;
+    TIM2->DIER = TIM_DIER_UIE;
+
+    // the first bit starts now, each update ends one bit and starts the next
+    active = true;
+    HAL_GPIO_WritePin(dataPort, dataPin, (txByte & txMask) ? GPIO_PIN_SET : GPIO_PIN_RESET);
+    TIM2->CR1 |= TIM_CR1_CEN;
+    return true;
+}
+
+// More data for a running transmission, see DirectTx_Refill_t
+void DirectTx_SetRefill(DirectTx_Refill_t callback, void *ctx) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    refill = callback;
+    refillCtx = ctx;
+    __set_PRIMASK(primask);
+}
+
+// Cut the transmission short, the pin is left low
+void DirectTx_Stop(void) {
+    directtx_stopTimer();
+    HAL_GPIO_WritePin(dataPort, dataPin, GPIO_PIN_RESET);
+}
+
+bool DirectTx_IsActive(void) {
+    return active;
+}
+
+uint32_t DirectTx_GetBitsSent(void) {
+    return bitsSent;
+}
+
+// Keep the bit period over a clock profile switch: the reload value follows
+// the new timer clock and the count is scaled so the current bit keeps its phase
+void DirectTx_ClockChanged(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (active) {
+        uint32_t oldReload = TIM2->ARR;
+        uint32_t reload = directtx_reload(TIM2->PSC);
+
+        // lower the count first, it must never pass the reload value
+        TIM2->CNT = TIM2->CNT * (reload + 1) / (oldReload + 1);
+        TIM2->ARR = reload;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+// One bit period is over: put the next bit on the pin, or end the transmission
+void DirectTx_IRQHandler(void) {
+    if (!(TIM2->SR & TIM_SR_UIF)) {
+        return;
+    }
+    TIM2->SR = ~TIM_SR_UIF;
+
+    if (!active) {
+        directtx_stopTimer();
+        return;
+    }
+    bitsSent++;
+
+    txMask >>= 1;
+    if (txMask == 0 && !directtx_nextByte()) {
+        directtx_stopTimer();
+        HAL_GPIO_WritePin(dataPort, dataPin, GPIO_PIN_RESET);
+        Events_Set(EVENT_RADIO_IRQ);
+        return;
+    }
+    HAL_GPIO_WritePin(dataPort, dataPin, (txByte & txMask) ? GPIO_PIN_SET : GPIO_PIN_RESET);
+}
+
+// Private functions
+// Load the next byte of the bitstream, false at its end
+static bool directtx_nextByte(void) {
+    if (preambleLeft > 0) {
+        preambleLeft--;
+        txByte = preambleByte ^ invertMask;
+        txMask = 0x80;
+        return true;
+    }
+    if (txPos >= txLen && refill) {
+        txLen = refill(refillCtx, &txData);
+        txPos = 0;
+    }
+    if (txPos >= txLen || !txData) {
+        return false;
+    }
+    txByte = txData[txPos++] ^ invertMask;
+    txMask = 0x80;
+    return true;
+}
+
+// TIM2 runs at twice PCLK1 when the APB1 prescaler divides
+static uint32_t directtx_timerHz(void) {
+    uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+
+    return (pclk1 == HAL_RCC_GetHCLKFreq()) ? pclk1 : 2 * pclk1;
+}
+
+// Auto-reload value for one bit period at the current timer clock
+static uint32_t directtx_reload(uint32_t prescaler) {
+    uint32_t ticks = directtx_timerHz() / (prescaler + 1);
+
+    return (ticks + baud / 2) / baud - 1;
+}
+
+static void directtx_stopTimer(void) {
+    TIM2->CR1 = 0;
+    TIM2->DIER = 0;
+    TIM2->SR = 0;
+    active = false;
+}
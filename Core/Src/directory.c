@@ -0,0 +1,60 @@
+/*
+ * directory.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "directory.h"
+#include "directory_table.h"
+#include <stddef.h>
+
+#define DIRECTORY_COUNT DIRECTORY_TABLE_SIZE
+
+// Private function prototypes
+static int directory_compare(const char* alias, const char* entry);
+
+int Directory_GetCount(void) {
+    return DIRECTORY_COUNT;
+}
+
+// Get an entry by position, in alias order
+const Directory_Entry_t* Directory_Get(int index) {
+    if (index < 0 || index >= DIRECTORY_COUNT) return NULL;
+    return &directoryTable[index];
+}
+
+// Binary search of the sorted table, NULL when the alias is unknown
+const Directory_Entry_t* Directory_Find(const char* alias) {
+    int low = 0;
+    int high = DIRECTORY_COUNT - 1;
+
+    if (alias == NULL) {
+        return NULL;
+    }
+
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int cmp = directory_compare(alias, directoryTable[mid].alias);
+
+        if (cmp == 0) {
+            return &directoryTable[mid];
+        } else if (cmp < 0) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+// Private functions
+// strcmp() with alias folded to lower case, the table holds lower case only
+static int directory_compare(const char* alias, const char* entry) {
+    for (;; alias++, entry++) {
+        char c = (*alias >= 'A' && *alias <= 'Z') ? *alias - 'A' + 'a' : *alias;
+
+        if (c != *entry || c == '\0') {
+            return (unsigned char)c - (unsigned char)*entry;
+        }
+    }
+}
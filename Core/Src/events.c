@@ -0,0 +1,124 @@
+/*
+ * events.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "events.h"
+#include "main.h"
+
+// Pending event flags
+static volatile uint32_t pendingEvents = 0;
+
+// Software timers
+typedef struct {
+    uint32_t event;     // 0 = slot unused
+    uint32_t deadline;  // HAL tick at which the event fires
+} EventTimer_t;
+
+static volatile EventTimer_t timers[EVENTS_MAX_TIMERS];
+
+// Initialize event flags and timers
+void Events_Init(void) {
+    __disable_irq();
+    pendingEvents = 0;
+    for (int i = 0; i < EVENTS_MAX_TIMERS; i++) {
+        timers[i].event = 0;
+    }
+    __enable_irq();
+}
+
+// Set one or more event flags (safe from ISR and thread context)
+void Events_Set(uint32_t events) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    pendingEvents |= events;
+    __set_PRIMASK(primask);
+}
+
+// Fetch and clear all pending events without sleeping
+uint32_t Events_Take(void) {
+    uint32_t events;
+
+    __disable_irq();
+    events = pendingEvents;
+    pendingEvents = 0;
+    __enable_irq();
+
+    return events;
+}
+
+// Sleep until at least one event is pending, then fetch and clear them
+uint32_t Events_Wait(void) {
+    uint32_t events;
+
+    // Interrupts are masked while checking, so an event raised between the
+    // check and WFI still wakes the core (pending IRQs end WFI even when masked)
+    __disable_irq();
+    while (pendingEvents == 0) {
+        __WFI();
+        __enable_irq();
+        __disable_irq();
+    }
+    events = pendingEvents;
+    pendingEvents = 0;
+    __enable_irq();
+
+    return events;
+}
+
+// Start (or restart) the timer that raises "event" after delay_ms
+void Events_StartTimer(uint32_t event, uint32_t delay_ms) {
+    int freeSlot = -1;
+
+    __disable_irq();
+    for (int i = 0; i < EVENTS_MAX_TIMERS; i++) {
+        if (timers[i].event == event) {
+            freeSlot = i;
+            break;
+        }
+        if (timers[i].event == 0 && freeSlot < 0) {
+            freeSlot = i;
+        }
+    }
+
+    if (freeSlot >= 0) {
+        timers[freeSlot].deadline = HAL_GetTick() + delay_ms;
+        timers[freeSlot].event = event;
+    }
+    __enable_irq();
+}
+
+// Cancel the timer for "event" (a flag already raised stays pending)
+void Events_StopTimer(uint32_t event) {
+    __disable_irq();
+    for (int i = 0; i < EVENTS_MAX_TIMERS; i++) {
+        if (timers[i].event == event) {
+            timers[i].event = 0;
+        }
+    }
+    __enable_irq();
+}
+
+// Check whether the timer for "event" is still running
+bool Events_TimerActive(uint32_t event) {
+    for (int i = 0; i < EVENTS_MAX_TIMERS; i++) {
+        if (timers[i].event == event) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Expire timers, called from SysTick context once per millisecond
+void Events_TickFromISR(void) {
+    uint32_t now = HAL_GetTick();
+
+    for (int i = 0; i < EVENTS_MAX_TIMERS; i++) {
+        if (timers[i].event != 0 && (int32_t)(now - timers[i].deadline) >= 0) {
+            // UART and EXTI handlers may preempt SysTick, so use the masked setter
+            Events_Set(timers[i].event);
+            timers[i].event = 0;
+        }
+    }
+}
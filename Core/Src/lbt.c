@@ -0,0 +1,89 @@
+/*
+ * lbt.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "lbt.h"
+#include <string.h>
+
+static bool enabled = false;
+static int threshold = LBT_DEFAULT_THRESHOLD_DBM;
+static int attempts = 0;          // busy assessments of the pending transmission
+static uint32_t randomState = 1;
+static Lbt_Stats_t stats;
+
+// Private function prototypes
+static uint32_t lbt_random(void);
+
+// Initialize, the seed should differ between transmitters sharing a channel
+// so their backoffs do not stay in step
+void Lbt_Init(uint32_t seed) {
+    memset(&stats, 0, sizeof(stats));
+    attempts = 0;
+    randomState = seed ? seed : 1;
+}
+
+void Lbt_SetEnabled(bool on) {
+    enabled = on;
+    attempts = 0;
+}
+
+bool Lbt_IsEnabled(void) {
+    return enabled;
+}
+
+void Lbt_SetThreshold(int dBm) {
+    if (dBm < LBT_MIN_THRESHOLD_DBM) {
+        dBm = LBT_MIN_THRESHOLD_DBM;
+    } else if (dBm > LBT_MAX_THRESHOLD_DBM) {
+        dBm = LBT_MAX_THRESHOLD_DBM;
+    }
+    threshold = dBm;
+}
+
+int Lbt_GetThreshold(void) {
+    return threshold;
+}
+
+// Judge a clear channel assessment. Returns 0 when the transmission may
+// start, otherwise the backoff in ms before assessing again.
+uint32_t Lbt_Assess(int rssiDbm) {
+    stats.checks++;
+    stats.lastRssi = rssiDbm;
+
+    if (rssiDbm < threshold) {
+        attempts = 0;
+        return 0;
+    }
+
+    stats.busy++;
+    if (++attempts > LBT_MAX_ATTEMPTS) {
+        stats.gaveUp++;
+        attempts = 0;
+        return 0;
+    }
+
+    // 1..window slots, the window doubles per attempt
+    uint32_t window = 2UL << (attempts - 1);
+    if (window > LBT_MAX_WINDOW) {
+        window = LBT_MAX_WINDOW;
+    }
+    uint32_t backoff = (1 + lbt_random() % window) * LBT_SLOT_MS;
+
+    stats.deferredMs += backoff;
+    return backoff;
+}
+
+const Lbt_Stats_t* Lbt_GetStats(void) {
+    return &stats;
+}
+
+// Private functions
+static uint32_t lbt_random(void) {
+    // xorshift32
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
@@ -21,8 +21,23 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-#include "pocsag.h"
+#include "Pocsag.h"
 #include "si4463_driver.h"
+#include "events.h"
+#include "clock.h"
+#include "perf.h"
+#include "airtime.h"
+#include "pagequeue.h"
+#include "pocsag_decoder.h"
+#include "lbt.h"
+#include "pocsag_burst.h"
+#include "repeater.h"
+#include "pocsag_bench.h"
+#include "si4463_trace.h"
+#include "direct_tx.h"
+#include "canned.h"
+#include "directory.h"
+#include "uart_tx.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
@@ -30,7 +45,14 @@
 
 /* Private typedef -----------------------------------------------------------*/
 /* USER CODE BEGIN PTD */
-
+// Page heard by the channel monitor, waiting to be printed
+typedef struct {
+    long address;
+    int function;
+    int corrected;                // bit errors corrected
+    int lost;                     // codewords that could not be corrected
+    char text[POCSAG_DECODER_MAXTEXT + 1];
+} RxPage_t;
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
@@ -42,6 +64,41 @@
 #define SI4463_NIRQ_PIN    GPIO_PIN_1
 #define SI4463_CS_PORT     GPIOB
 #define SI4463_CS_PIN      GPIO_PIN_10
+
+// Optional second SI4463 on SPI2 (PB13 SCK, PB14 MISO, PB15 MOSI)
+#define SI4463_2_SDN_PORT  GPIOB
+#define SI4463_2_SDN_PIN   GPIO_PIN_11
+#define SI4463_2_NIRQ_PORT GPIOA
+#define SI4463_2_NIRQ_PIN  GPIO_PIN_4
+#define SI4463_2_CS_PORT   GPIOB
+#define SI4463_2_CS_PIN    GPIO_PIN_12
+
+// Optional direct mode TX data, wired to GPIO0 of the first SI4463
+#define DIRECT_TX_PORT     GPIOA
+#define DIRECT_TX_PIN      GPIO_PIN_8
+
+#define UART_RX_RINGLEN    128
+#define RADIO_POLL_MS      20    // radio service interval while on air (nIRQ is optional)
+#define TX_REPEAT_GAP_MS   3000  // pause between repeated transmissions
+
+#define RX_POLL_MS         300   // fallback service interval while monitoring, the 64 byte FIFO lasts 427 ms
+#define RX_CHUNK_LEN       64    // one RX FIFO
+#define RX_PAGE_QUEUE_LEN  4
+#define RX_SYNC_WORD       0x832DEA27  // POCSAG sync codeword 0x7CD215D8, inverted
+#define TX_INVERTED        true        // this firmware transmits inverted
+#define RX_INVERTED        TX_INVERTED // monitor the same polarity
+
+// POCSAG_MODEM_INVERT: messages are encoded in normal polarity and the
+// radio's modem inverts them on air, otherwise the encoder inverts
+#ifdef POCSAG_MODEM_INVERT
+#define TX_ENCODE_INVERTED false
+#else
+#define TX_ENCODE_INVERTED TX_INVERTED
+#endif
+
+#define DEFAULT_FREQUENCY  433.920f
+#define DEFAULT_BAUD       1200
+#define GROUP_HOLD_MAX_MS  10000  // longest hold time for G
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -55,8 +112,60 @@ SPI_HandleTypeDef hspi1;
 UART_HandleTypeDef huart1;
 
 /* USER CODE BEGIN PV */
+SPI_HandleTypeDef hspi2;
+static Si4463_t radio;
+static Si4463_t radio2;
+static bool radio2Present = false;
+static float simulcastFrequency = 0.0f;   // 0 = second radio idle
+static bool simulcastActive = false;      // current transmission went out on both radios
+static bool txEnded = false;              // first radio done, waiting for the second
+static bool directTxEnabled = false;      // X: clock pages onto GPIO0 instead of the FIFO
+static bool continuousEnabled = false;    // C: queued pages ride on the transmission on air
+static uint16_t streamBytes = 0;          // bytes in the transmission on air, appended pages included
+static bool appendPending = false;        // appended page not yet taken by the radio
+static uint32_t groupHoldMs = 0;          // G: pages are held this long and sent in one burst per data rate, 0 = off
+
 static char txBuff[TXBUFLEN];
-Pocsag_t pocsag;
+// Two message buffers: the page on air is in pocsag[txSlot], the next queued
+// page is encoded into the other one meanwhile
+static Pocsag_t pocsag[2];
+static uint8_t txSlot = 0;
+static bool nextReady = false;     // the other buffer holds an encoded page
+static int nextRepeat = 0;
+static int nextCanned = -1;        // the next page is a canned message, it needs no buffer
+static uint16_t nextBaud = DEFAULT_BAUD;
+static PocsagBurst_t txBurst;      // repeater burst or grouped pages
+
+// UART receive ring, filled from the RX complete interrupt
+static uint8_t uartRxByte;
+static uint8_t uartRxRing[UART_RX_RINGLEN];
+static volatile uint16_t uartRxHead = 0;
+static volatile uint16_t uartRxTail = 0;
+
+// Page currently on air (pocsag[txSlot] or a repeater burst), and transmissions left for it
+static bool pageLoaded = false;
+static const uint8_t* txData = NULL;
+static uint16_t txSize = 0;
+static bool txInverted = false;    // polarity txData was encoded with
+static uint16_t txBaud = DEFAULT_BAUD;
+static int txRepeatsLeft = 0;
+static int txCount = 0;
+
+// Channel set with F, the repeater may transmit elsewhere
+static float channelFrequency = DEFAULT_FREQUENCY;
+static uint16_t channelBaud = DEFAULT_BAUD;    // data rate of P and N pages, the monitor and the repeater
+static float repeaterFrequency = 0.0f;     // 0 = repeat on the channel
+static float txFrequency = DEFAULT_FREQUENCY;
+static float radioFrequency = 0.0f;
+
+// Channel monitor: decodes the channel whenever the transmitter is idle
+static bool monitorEnabled = false;
+static bool rxSynced = false;     // decoder has been told about the sync word the radio matched
+static PocsagDecoder_t rxDecoder;
+static RxPage_t rxPages[RX_PAGE_QUEUE_LEN];
+static uint8_t rxPageHead = 0;
+static uint8_t rxPageTail = 0;
+static uint32_t rxPagesDropped = 0;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -66,10 +175,49 @@ static void MX_SPI1_Init(void);
 static void MX_USART1_UART_Init(void);
 /* USER CODE BEGIN PFP */
 void setupSI4463(void);
+void setupSecondSI4463(void);
 void processPOCSAGCommand(void);
 void parseAndSendPOCSAG(char* command);
 void parseAndSetFrequency(char* command);
-void transmitPOCSAGWithSI4463(long address, int addresssource, int repeat, char* textmsg);
+void printStats(char* command);
+void printAirtime(char* command);
+void setMonitor(char* command);
+void setListenBeforeTalk(char* command);
+void setRepeater(char* command);
+void setSimulcast(char* command);
+void setDirectTx(char* command);
+void setContinuous(char* command);
+void setGrouping(char* command);
+void sendCanned(char* command);
+void sendByAlias(char* command);
+#ifdef POCSAG_BENCH
+void runBenchmark(char* command);
+#endif
+#ifdef SI4463_TRACE
+void dumpTrace(char* command);
+#endif
+void queuePage(Page_t* page);
+void servicePageQueue(void);
+void transmitPOCSAGWithSI4463(const Page_t* page);
+int encodePage(Pocsag_t* msg, const Page_t* page);
+void transmitCanned(int number, int repeat, uint16_t baud);
+void prepareNextPage(const Page_t* page);
+void appendNextPage(void);
+void transmitSlot(int repeat, uint16_t baud);
+void transmitGroupBurst(const Page_t* first);
+void transmitRepeaterBurst(void);
+void startNextTransmission(void);
+void finishPage(void);
+void tuneRadio(float freq);
+void setDataRate(uint16_t baud);
+bool isValidFrequency(float freq);
+void serviceRadio(void);
+void startReceive(void);
+void stopReceive(void);
+void serviceReceive(void);
+void printReceivedPages(void);
+static void onRxMessage(void *ctx, const PocsagDecoder_Message_t *msg);
+static void onTxStart(void *ctx);
 void uart_print(const char* message);
 void uart_printf(const char* format, ...);
 /* USER CODE END PFP */
@@ -78,7 +226,7 @@ void uart_printf(const char* format, ...);
 /* USER CODE BEGIN 0 */
 // Simple UART print function
 void uart_print(const char* message) {
-    HAL_UART_Transmit(&huart1, (uint8_t*)message, strlen(message), HAL_MAX_DELAY);
+    UartTx_Write((const uint8_t*)message, strlen(message));
 }
 
 // Formatted UART print function
@@ -89,34 +237,145 @@ void uart_printf(const char* format, ...) {
     va_end(args);
 
     if (len > 0 && len < TXBUFLEN) {
-        HAL_UART_Transmit(&huart1, (uint8_t*)txBuff, len, HAL_MAX_DELAY);
+        UartTx_Write((const uint8_t*)txBuff, len);
+    }
+}
+
+// Start receiving the next UART byte in interrupt mode
+static void uartRxStart(void) {
+    HAL_UART_Receive_IT(&huart1, &uartRxByte, 1);
+}
+
+// Pop one byte from the UART receive ring
+static bool uartRxPop(uint8_t* byte) {
+    if (uartRxTail == uartRxHead) {
+        return false;
+    }
+    *byte = uartRxRing[uartRxTail];
+    uartRxTail = (uartRxTail + 1) % UART_RX_RINGLEN;
+    return true;
+}
+
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
+    if (huart->Instance == USART1) {
+        uint16_t next = (uartRxHead + 1) % UART_RX_RINGLEN;
+
+        // drop the byte if the main loop fell behind
+        if (next != uartRxTail) {
+            uartRxRing[uartRxHead] = uartRxByte;
+            uartRxHead = next;
+        }
+        Events_Set(EVENT_UART_RX);
+        uartRxStart();
+    }
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    UartTx_TxComplete(huart);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+    if (huart->Instance == USART1) {
+        // overrun/framing error aborts the reception, re-arm it
+        uartRxStart();
+    }
+}
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    if (GPIO_Pin == SI4463_NIRQ_PIN || GPIO_Pin == SI4463_2_NIRQ_PIN) {
+        Events_Set(EVENT_RADIO_IRQ);
     }
 }
 
 // Initialize SI4463
 void setupSI4463(void) {
     // Initialize SI4463
-    Si4463_Init(&hspi1,
+    Si4463_Init(&radio, &hspi1,
                 SI4463_SDN_PORT, SI4463_SDN_PIN,
                 SI4463_NIRQ_PORT, SI4463_NIRQ_PIN,
                 SI4463_CS_PORT, SI4463_CS_PIN);
+    Si4463_SetTxStartHook(&radio, onTxStart, NULL);
 
     // Set default POCSAG frequency
-    Si4463_SetFrequency(433.920f);
+    tuneRadio(channelFrequency);
 
     // Configure for POCSAG
-    Si4463_ConfigureForPOCSAG();
+    Si4463_ConfigureForPOCSAG(&radio);
 
     uart_print("SI4463 initialized for POCSAG at 433.92 MHz\r\n");
 }
 
+// Bring up the optional second SI4463 on SPI2, left idle until simulcast is enabled
+void setupSecondSI4463(void) {
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+    __HAL_RCC_SPI2_CLK_ENABLE();
+
+    // PB13 SCK, PB15 MOSI
+    GPIO_InitStruct.Pin = GPIO_PIN_13 | GPIO_PIN_15;
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+    // PB14 MISO, pulled up so an empty socket reads 0xFF
+    GPIO_InitStruct.Pin = GPIO_PIN_14;
+    GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+    HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+    // PB11 SDN, PB12 CS
+    HAL_GPIO_WritePin(GPIOB, SI4463_2_SDN_PIN | SI4463_2_CS_PIN, GPIO_PIN_SET);
+    GPIO_InitStruct.Pin = SI4463_2_SDN_PIN | SI4463_2_CS_PIN;
+    GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+    HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+    // PA4 nIRQ, falling edge raises EVENT_RADIO_IRQ like the first radio
+    GPIO_InitStruct.Pin = SI4463_2_NIRQ_PIN;
+    GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+    HAL_GPIO_Init(SI4463_2_NIRQ_PORT, &GPIO_InitStruct);
+
+    hspi2.Instance = SPI2;
+    hspi2.Init.Mode = SPI_MODE_MASTER;
+    hspi2.Init.Direction = SPI_DIRECTION_2LINES;
+    hspi2.Init.DataSize = SPI_DATASIZE_8BIT;
+    hspi2.Init.CLKPolarity = SPI_POLARITY_LOW;
+    hspi2.Init.CLKPhase = SPI_PHASE_1EDGE;
+    hspi2.Init.NSS = SPI_NSS_SOFT;
+    hspi2.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_2;
+    hspi2.Init.FirstBit = SPI_FIRSTBIT_MSB;
+    hspi2.Init.TIMode = SPI_TIMODE_DISABLE;
+    hspi2.Init.CRCCalculation = SPI_CRCCALCULATION_DISABLE;
+    hspi2.Init.CRCPolynomial = 10;
+    if (HAL_SPI_Init(&hspi2) != HAL_OK) {
+        return;
+    }
+    Clock_AddSpi(&hspi2);
+
+    radio2Present = Si4463_Init(&radio2, &hspi2,
+                                SI4463_2_SDN_PORT, SI4463_2_SDN_PIN,
+                                SI4463_2_NIRQ_PORT, SI4463_2_NIRQ_PIN,
+                                SI4463_2_CS_PORT, SI4463_2_CS_PIN);
+    if (!radio2Present) {
+        return;
+    }
+    Si4463_ConfigureForPOCSAG(&radio2);
+
+    HAL_NVIC_SetPriority(EXTI4_IRQn, 5, 0);
+    HAL_NVIC_EnableIRQ(EXTI4_IRQn);
+
+    uart_print("Second SI4463 found on SPI2\r\n");
+}
+
 // Command processing
 void processPOCSAGCommand(void) {
     static uint8_t rx_buffer[256];
     static uint16_t rx_index = 0;
     uint8_t byte;
 
-    while (HAL_UART_Receive(&huart1, &byte, 1, 0) == HAL_OK) {
+    while (uartRxPop(&byte)) {
         if (byte == '\r' || byte == '\n') {
             if (rx_index > 0) {
                 rx_buffer[rx_index] = '\0';
@@ -124,20 +383,69 @@ void processPOCSAGCommand(void) {
                 // Echo the command
                 uart_print("\r\n");
 
-                // Process command
+                // time pages from the complete command line, unless it has to queue
+                if ((rx_buffer[0] == 'P' || rx_buffer[0] == 'p' || rx_buffer[0] == 'N' || rx_buffer[0] == 'n' ||
+                     rx_buffer[0] == 'U' || rx_buffer[0] == 'u') && !pageLoaded && !nextReady && PageQueue_Count() == 0) {
+                    Perf_BeginPage();
+                }
+
+                // Process command at full speed, encoding and FIFO load run 9x faster
+                Clock_SetProfile(CLOCK_PROFILE_PERFORMANCE);
+
                 if (rx_buffer[0] == 'P' || rx_buffer[0] == 'p') {
                     parseAndSendPOCSAG((char*)rx_buffer);
                 } else if (rx_buffer[0] == 'F' || rx_buffer[0] == 'f') {
                     parseAndSetFrequency((char*)rx_buffer);
+                } else if (rx_buffer[0] == 'S' || rx_buffer[0] == 's') {
+                    printStats((char*)rx_buffer);
+                } else if (rx_buffer[0] == 'A' || rx_buffer[0] == 'a') {
+                    printAirtime((char*)rx_buffer);
+                } else if (rx_buffer[0] == 'R' || rx_buffer[0] == 'r') {
+                    setMonitor((char*)rx_buffer);
+                } else if (rx_buffer[0] == 'L' || rx_buffer[0] == 'l') {
+                    setListenBeforeTalk((char*)rx_buffer);
+                } else if (rx_buffer[0] == 'D' || rx_buffer[0] == 'd') {
+                    setRepeater((char*)rx_buffer);
+                } else if (rx_buffer[0] == 'M' || rx_buffer[0] == 'm') {
+                    setSimulcast((char*)rx_buffer);
+                } else if (rx_buffer[0] == 'X' || rx_buffer[0] == 'x') {
+                    setDirectTx((char*)rx_buffer);
+                } else if (rx_buffer[0] == 'C' || rx_buffer[0] == 'c') {
+                    setContinuous((char*)rx_buffer);
+                } else if (rx_buffer[0] == 'G' || rx_buffer[0] == 'g') {
+                    setGrouping((char*)rx_buffer);
+                } else if (rx_buffer[0] == 'N' || rx_buffer[0] == 'n') {
+                    sendCanned((char*)rx_buffer);
+                } else if (rx_buffer[0] == 'U' || rx_buffer[0] == 'u') {
+                    sendByAlias((char*)rx_buffer);
+#ifdef POCSAG_BENCH
+                } else if (rx_buffer[0] == 'B' || rx_buffer[0] == 'b') {
+                    runBenchmark((char*)rx_buffer);
+#endif
+#ifdef SI4463_TRACE
+                } else if (rx_buffer[0] == 'T' || rx_buffer[0] == 't') {
+                    dumpTrace((char*)rx_buffer);
+#endif
                 } else {
-                    uart_print("Unknown command. Use P or F.\r\n");
+                    // the list follows the commands built in
+                    uart_print("Unknown command. Use P, F, S, A, R, L, D, M, X, C, G, N, U"
+#ifdef POCSAG_BENCH
+                               ", B"
+#endif
+#ifdef SI4463_TRACE
+                               ", T"
+#endif
+                               ".\r\n");
                 }
 
+                // on-air time and idle are spent on the HSI
+                Clock_SetProfile(CLOCK_PROFILE_LOWPOWER);
+
                 rx_index = 0;
             }
         } else if (rx_index < sizeof(rx_buffer) - 1) {
             // Echo character back
-            HAL_UART_Transmit(&huart1, &byte, 1, HAL_MAX_DELAY);
+            UartTx_Write(&byte, 1);
             rx_buffer[rx_index++] = byte;
         }
     }
@@ -151,60 +459,622 @@ void parseAndSendPOCSAG(char* command) {
 
     // Parse command: P <address> <source> <repeat> <message>
     if (sscanf(command, "%*c %ld %d %d %40[^\n]",
-               &address, &addresssource, &repeat, textmsg) == 4) {
+               &address, &addresssource, &repeat, textmsg) == 4 && repeat >= 0) {
 
         uart_printf("address: %ld\r\n", address);
         uart_printf("addresssource: %d\r\n", addresssource);
         uart_printf("repeat: %d\r\n", repeat);
         uart_printf("message: %s\r\n", textmsg);
 
-        transmitPOCSAGWithSI4463(address, addresssource, repeat, textmsg);
+        Page_t page;
+        page.address = address;
+        page.source = addresssource;
+        page.repeat = repeat;
+        page.canned = -1;
+        page.numeric = false;
+        page.baud = channelBaud;
+        strncpy(page.text, textmsg, sizeof(page.text) - 1);
+        page.text[sizeof(page.text) - 1] = '\0';
+
+        queuePage(&page);
     } else {
         uart_print("Invalid P command format. Use: P <address> <source> <repeat> <message>\r\n");
         uart_print("Example: P 123456 0 1 \"Hello World\"\r\n");
     }
 }
 
-void transmitPOCSAGWithSI4463(long address, int addresssource, int repeat, char* textmsg) {
-    int rc = Pocsag_CreatePocsag(&pocsag, address, addresssource, textmsg, 0, 1);
+// Canned messages: N to list them, N <number> [repeat] to send one. They are
+// encoded at build time (Core/Src/canned.txt) and sent straight from flash.
+void sendCanned(char* command) {
+    int number = 0;
+    int repeat = 0;
+    int args = sscanf(command, "%*c %d %d", &number, &repeat);
+
+    if (args < 1) {
+        for (int i = 0; i < Canned_GetCount(); i++) {
+            const Canned_t* canned = Canned_Get(i);
+            uart_printf("%d: %ld %d %s\r\n", i, canned->address, canned->source, canned->text);
+        }
+        uart_printf("%d canned message(s)\r\n", Canned_GetCount());
+        return;
+    }
+    if (Canned_Get(number) == NULL || repeat < 0) {
+        uart_print("Invalid N command format. Use: N [number [repeat]]\r\n");
+        return;
+    }
+
+    const Canned_t* canned = Canned_Get(number);
+    uart_printf("canned message %d: %ld %d %s\r\n", number, canned->address, canned->source, canned->text);
+
+    Page_t page;
+    page.address = canned->address;
+    page.source = canned->source;
+    page.repeat = repeat;
+    page.canned = number;
+    page.numeric = false;
+    page.baud = channelBaud;
+    page.text[0] = '\0';
+
+    queuePage(&page);
+}
+
+// Subscriber directory: U to list it, U <alias> <repeat> [message] to page a
+// pager by its alias. Numeric pagers get the message as digits, no message
+// sends a tone-only page.
+void sendByAlias(char* command) {
+    char alias[DIRECTORY_ALIAS_MAX + 2] = {0};     // one more, a longer alias must not match
+    int repeat = 0;
+    char textmsg[42] = {0};
+    char format[24];
+
+    // the alias field width follows DIRECTORY_ALIAS_MAX
+    snprintf(format, sizeof(format), "%%*c %%%ds %%d %%40[^\n]", DIRECTORY_ALIAS_MAX + 1);
+    int args = sscanf(command, format, alias, &repeat, textmsg);
+
+    if (args < 1) {
+        for (int i = 0; i < Directory_GetCount(); i++) {
+            const Directory_Entry_t* entry = Directory_Get(i);
+            uart_printf("%s: %ld %d %s %u baud\r\n", entry->alias, entry->address, entry->source,
+                        entry->numeric ? "numeric" : "alpha", entry->baud);
+        }
+        uart_printf("%d subscriber(s)\r\n", Directory_GetCount());
+        return;
+    }
+    if (args < 2 || repeat < 0) {
+        uart_print("Invalid U command format. Use: U <alias> <repeat> [message]\r\n");
+        return;
+    }
+
+    const Directory_Entry_t* entry = Directory_Find(alias);
+    if (entry == NULL) {
+        uart_printf("Unknown alias: %s\r\n", alias);
+        return;
+    }
+    uart_printf("%s: %ld %d %s\r\n", entry->alias, entry->address, entry->source, textmsg);
+
+    Page_t page;
+    page.address = entry->address;
+    page.source = entry->source;
+    page.repeat = repeat;
+    page.canned = -1;
+    page.numeric = entry->numeric;
+    page.baud = entry->baud;
+    strncpy(page.text, textmsg, sizeof(page.text) - 1);
+    page.text[sizeof(page.text) - 1] = '\0';
+
+    queuePage(&page);
+}
+
+// Hand a page to the queue, it goes straight to the encoder when nothing is waiting
+void queuePage(Page_t* page) {
+    page->timed = !pageLoaded && !nextReady && PageQueue_Count() == 0;
+    if (page->timed) {
+        Perf_Mark(PERF_STAGE_PARSE);
+
+        // grouping: the pages right behind this one get the hold time to join its burst
+        if (groupHoldMs > 0) {
+            Events_StartTimer(EVENT_GROUP, groupHoldMs);
+        }
+    }
+
+    if (PageQueue_Push(page)) {
+        if (!page->timed) {
+            uart_printf("Page queued (%d waiting)\r\n", PageQueue_Count());
+        }
+        servicePageQueue();
+    } else {
+        uart_print("Queue full, page dropped\r\n");
+    }
+}
+
+// Encode and start the next queued page once the radio is free, while it is
+// busy encode the page after it so it can start as soon as the radio is done
+void servicePageQueue(void) {
+    Page_t page;
+
+    if (pageLoaded) {
+        // an appended page not yet taken by the radio still holds the other buffer,
+        // with grouping the queued pages wait for the burst of their data rate
+        if (!nextReady && groupHoldMs == 0 && !Si4463_IsTxPending(&radio) && PageQueue_Pop(&page)) {
+            prepareNextPage(&page);
+        }
+        if (nextReady) {
+            appendNextPage();
+        }
+        return;
+    }
+
+    // the page encoded during the previous transmission goes first
+    if (nextReady) {
+        int canned = nextCanned;
+
+        nextReady = false;
+        nextCanned = -1;
+        Perf_BeginPage();
+        if (canned >= 0) {
+            transmitCanned(canned, nextRepeat, nextBaud);
+        } else {
+            txSlot ^= 1;
+            transmitSlot(nextRepeat, nextBaud);
+        }
+        Events_Set(EVENT_PAGE_QUEUE);
+        return;
+    }
+
+    // grouping: hold the queue until the hold time is over or it is full
+    if (groupHoldMs > 0 && Events_TimerActive(EVENT_GROUP) && PageQueue_Count() < PAGEQUEUE_LEN) {
+        return;
+    }
+
+    // local pages first, then what the repeater gathered, otherwise listen to the channel
+    if (!PageQueue_Pop(&page)) {
+        if (Repeater_IsReady()) {
+            transmitRepeaterBurst();
+        } else if (!Si4463_IsReceiving(&radio)) {
+            startReceive();
+        }
+        return;
+    }
+
+    // a timed page may have waited for the grouping hold, that is not encoding
+    if (page.timed) {
+        Perf_Mark(PERF_STAGE_QUEUE);
+    } else {
+        Perf_BeginPage();
+    }
+
+    if (groupHoldMs > 0 && page.repeat == 0 && page.canned < 0) {
+        transmitGroupBurst(&page);
+    } else if (page.canned >= 0) {
+        transmitCanned(page.canned, page.repeat, page.baud);
+    } else {
+        transmitPOCSAGWithSI4463(&page);
+    }
+
+    // encoding failed: move on to the next one, otherwise encode it while this one is on air
+    Events_Set(EVENT_PAGE_QUEUE);
+}
+
+void transmitPOCSAGWithSI4463(const Page_t* page) {
+    Pocsag_t* msg = &pocsag[txSlot];
+    int rc = encodePage(msg, page);
+    Perf_Mark(PERF_STAGE_ENCODE);
 
     if (!rc) {
-        uart_printf("Error in createpocsag! Error: %d\r\n", Pocsag_GetError(&pocsag));
-        HAL_Delay(10000);
+        uart_printf("Error in createpocsag! Error: %d\r\n", Pocsag_GetError(msg));
     } else {
-        uint8_t* pocsagData = (uint8_t*)Pocsag_GetMsgPointer(&pocsag);
-        uint16_t pocsagSize = Pocsag_GetSize(&pocsag);
+        uart_printf("POCSAG message created: %d bytes\r\n", Pocsag_GetSize(msg));
+        transmitSlot(page->repeat, page->baud);
+    }
+}
+
+// Encode a page as text, or as digits for a numeric pager
+int encodePage(Pocsag_t* msg, const Page_t* page) {
+    if (page->numeric) {
+        return Pocsag_CreatePocsagNumeric(msg, page->address, page->source, page->text, 0, TX_ENCODE_INVERTED);
+    }
+    return Pocsag_CreatePocsag(msg, page->address, page->source, page->text, 0, TX_ENCODE_INVERTED);
+}
+
+// Encode a queued page into the buffer that is not on air. Not timed, the
+// pipeline statistics belong to the page being transmitted.
+void prepareNextPage(const Page_t* page) {
+    Pocsag_t* msg = &pocsag[txSlot ^ 1];
+
+    // nothing to encode, it is sent from flash
+    if (page->canned >= 0) {
+        uart_printf("Canned message %d next in line\r\n", page->canned);
+        nextReady = true;
+        nextRepeat = page->repeat;
+        nextCanned = page->canned;
+        nextBaud = page->baud;
+        return;
+    }
+
+    if (!encodePage(msg, page)) {
+        uart_printf("Error in createpocsag! Error: %d\r\n", Pocsag_GetError(msg));
+        Events_Set(EVENT_PAGE_QUEUE);
+        return;
+    }
+    uart_printf("POCSAG message created: %d bytes, next in line\r\n", Pocsag_GetSize(msg));
+    nextReady = true;
+    nextRepeat = page->repeat;
+    nextBaud = page->baud;
+}
+
+// Continuous mode: hand the encoded page to the radio while the transmission
+// is still on air, it follows the last batch without a preamble of its own.
+// Pages to be repeated, other channels, other data rates and simulcast get
+// their own transmission.
+void appendNextPage(void) {
+    const uint8_t* data = (uint8_t*)Pocsag_GetMsgPointer(&pocsag[txSlot ^ 1]);
+    uint16_t len = Pocsag_GetSize(&pocsag[txSlot ^ 1]);
+    bool inverted = TX_ENCODE_INVERTED;
+
+    if (nextCanned >= 0) {
+        const Canned_t* canned = Canned_Get(nextCanned);
+
+        data = canned->data;
+        len = canned->size;
+        inverted = false;
+    }
+    data += POCSAG_MSG_PREAMBLE;
+    len -= POCSAG_MSG_PREAMBLE;
+
+    // the modem inverts the whole transmission or none of it, a canned page
+    // only joins one of its own polarity
+    if (!continuousEnabled || simulcastActive || txRepeatsLeft > 0 || nextRepeat > 0 ||
+        txFrequency != channelFrequency || nextBaud != txBaud || inverted != txInverted) {
+        return;
+    }
+
+    // the duty-cycle budget covers the transmission as a whole
+    if (Airtime_GetDeferral(Si4463_GetAirtimeMs(&radio, streamBytes + len)) != 0) {
+        return;
+    }
+
+    if (Si4463_AppendTx(&radio, data, len)) {
+        nextReady = false;
+        appendPending = true;
+        if (nextCanned >= 0) {
+            nextCanned = -1;
+        } else {
+            txSlot ^= 1;
+        }
+        streamBytes += len;
+        uart_printf("Page appended to the transmission on air: %d bytes\r\n", len);
+    }
+}
+
+// Start the page encoded in pocsag[txSlot]
+void transmitSlot(int repeat, uint16_t baud) {
+    pageLoaded = true;
+    txData = (uint8_t*)Pocsag_GetMsgPointer(&pocsag[txSlot]);
+    txSize = Pocsag_GetSize(&pocsag[txSlot]);
+    txInverted = TX_ENCODE_INVERTED;
+    txBaud = baud;
+    txFrequency = channelFrequency;
+    txRepeatsLeft = repeat + 1;
+    txCount = 0;
+    startNextTransmission();
+}
+
+// Start a canned message from flash, in the normal polarity it was encoded with
+void transmitCanned(int number, int repeat, uint16_t baud) {
+    const Canned_t* canned = Canned_Get(number);
+
+    Perf_Mark(PERF_STAGE_ENCODE);
+    uart_printf("Canned message %d: %d bytes\r\n", number, canned->size);
+
+    pageLoaded = true;
+    txData = canned->data;
+    txSize = canned->size;
+    txInverted = false;
+    txBaud = baud;
+    txFrequency = channelFrequency;
+    txRepeatsLeft = repeat + 1;
+    txCount = 0;
+    startNextTransmission();
+}
+
+// Grouping: send first and the queued pages at its data rate as one burst,
+// one preamble for all of them. The oldest page picks the rate, so the modem
+// only switches between bursts and neither rate waits for long. A page with
+// repeats or a canned message ends the burst, it goes out on its own.
+void transmitGroupBurst(const Page_t* first) {
+    Page_t page = *first;
+    bool queued = false;    // the first page has been taken from the queue already
+    int count = 0;
+
+    PocsagBurst_Init(&txBurst, TX_ENCODE_INVERTED);
+    for (;;) {
+        Pocsag_Encoder_t enc;
+        uint32_t codewords[32];
+        int words = 0;
+        int rc = page.numeric ? Pocsag_EncoderInitNumeric(&enc, page.address, page.source, page.text, 0, 0)
+                              : Pocsag_EncoderInit(&enc, page.address, page.source, page.text, 0, 0);
+
+        if (rc) {
+            words = Pocsag_EncoderGetCodewords(&enc, codewords, 32);
+        }
+        if (words == 0) {
+            uart_printf("Error in createpocsag! Error: %d\r\n", enc.error);
+        } else if (!PocsagBurst_Add(&txBurst, page.address, codewords, words)) {
+            // the burst is full, the page waits for the next one
+            break;
+        } else {
+            count++;
+        }
+        if (queued) {
+            PageQueue_PopBaud(&page, first->baud);
+        }
+
+        if (!PageQueue_PeekBaud(&page, first->baud) || page.repeat > 0 || page.canned >= 0) {
+            break;
+        }
+        queued = true;
+    }
+    Perf_Mark(PERF_STAGE_ENCODE);
+    if (count == 0) {
+        return;
+    }
+    uart_printf("Grouped %d page(s) at %u baud: %d bytes\r\n", count, first->baud, PocsagBurst_GetSize(&txBurst));
+
+    pageLoaded = true;
+    txData = PocsagBurst_GetData(&txBurst);
+    txSize = PocsagBurst_GetSize(&txBurst);
+    txInverted = TX_ENCODE_INVERTED;
+    txBaud = first->baud;
+    txFrequency = channelFrequency;
+    txRepeatsLeft = 1;
+    txCount = 0;
+    startNextTransmission();
+}
+
+// Send the pages gathered by the repeater as one transmission, one preamble for all
+void transmitRepeaterBurst(void) {
+    PocsagBurst_Init(&txBurst, TX_ENCODE_INVERTED);
+
+    int count = Repeater_BuildBurst(&txBurst);
+    if (count == 0) {
+        return;
+    }
+    uart_printf("Repeating %d page(s): %d bytes\r\n", count, PocsagBurst_GetSize(&txBurst));
+
+    Perf_BeginPage();
+    pageLoaded = true;
+    txData = PocsagBurst_GetData(&txBurst);
+    txSize = PocsagBurst_GetSize(&txBurst);
+    txInverted = TX_ENCODE_INVERTED;
+    txBaud = channelBaud;
+    txFrequency = (repeaterFrequency > 0.0f) ? repeaterFrequency : channelFrequency;
+    txRepeatsLeft = 1;
+    txCount = 0;
+    startNextTransmission();
+}
+
+// Put the current page on air, completion is reported through serviceRadio()
+void startNextTransmission(void) {
+    if (!pageLoaded || txRepeatsLeft <= 0) {
+        // a page loaded without a single transmission must not hold the queue
+        if (pageLoaded && txCount == 0) {
+            finishPage();
+        }
+        return;
+    }
+
+#ifdef POCSAG_RADIO_PREAMBLE
+    // the packet handler sends the preamble, in the polarity of the page
+    Si4463_SetPreamble(&radio, POCSAG_PREAMBLE_BYTES, txInverted);
+    if (radio2Present) {
+        Si4463_SetPreamble(&radio2, POCSAG_PREAMBLE_BYTES, txInverted);
+    }
+#endif
+    // the modem supplies the inversion the page was not encoded with
+    Si4463_SetTxInvert(&radio, txInverted != TX_INVERTED);
+    if (radio2Present) {
+        Si4463_SetTxInvert(&radio2, txInverted != TX_INVERTED);
+    }
+
+    // duty-cycle governor: hold the page until it fits in the hourly budget
+    uint32_t wait = Airtime_GetDeferral(Si4463_GetAirtimeMsAt(&radio, txSize, txBaud));
+    if (wait == AIRTIME_NEVER) {
+        uart_print("Page exceeds the duty-cycle budget, dropped\r\n");
+        finishPage();
+        return;
+    }
+    if (wait > 0) {
+        uart_printf("Duty cycle: transmission deferred by %lu ms\r\n", (unsigned long)wait);
+        Events_StartTimer(EVENT_TX_NEXT, wait);
+        return;
+    }
+
+    // the repeater output channel, the receiver cannot stay on the input meanwhile
+    if (txFrequency != radioFrequency) {
+        stopReceive();
+        tuneRadio(txFrequency);
+    }
+
+    // the data rate of the pages, a mixed queue switches it between transmissions
+    if (txBaud != radio.currentBaud) {
+        stopReceive();
+    }
+    setDataRate(txBaud);
+
+    // listen before talk: back off while someone else is on the channel
+    if (Lbt_IsEnabled()) {
+        int rssi;
+
+        if (Si4463_MeasureRssi(&radio, &rssi)) {
+            uint32_t backoff = Lbt_Assess(rssi);
+            if (backoff > 0) {
+                uart_printf("Channel busy (%d dBm), backing off %lu ms\r\n", rssi, (unsigned long)backoff);
+                Events_StartTimer(EVENT_TX_NEXT, backoff);
+                return;
+            }
+        }
+    }
 
-        uart_printf("POCSAG message created: %d bytes\r\n", pocsagSize);
+    txRepeatsLeft--;
+    txCount++;
 
-        for (int l = -1; l < repeat; l++) {
-            uart_printf("POCSAG SEND with SI4463 (transmission %d)\r\n", l + 2);
+    uart_printf("POCSAG SEND with SI4463 (transmission %d)\r\n", txCount);
 
-            // Transmit using SI4463
-            Si4463_TransmitPOCSAG(pocsagData, pocsagSize);
+    // half duplex: the monitor resumes once the queue is empty
+    stopReceive();
+
+    // repeats are timed from here, the first one from the command line
+    if (txCount > 1) {
+        Perf_BeginPage();
+    }
+
+    // simulcast: the second radio sends the same bytes on its own frequency
+    simulcastActive = radio2Present && simulcastFrequency > 0.0f;
+    txEnded = false;
+
+    bool started;
+    streamBytes = txSize;
+    if (directTxEnabled && !simulcastActive) {
+        // no FIFO to load, the timer clocks the bits straight onto GPIO0
+        started = Si4463_StartDirectTx(&radio, txData, txSize);
+    } else {
+        if (Si4463_LoadTx(&radio, txData, txSize)) {
+            Perf_Mark(PERF_STAGE_FIFO_LOAD);
+        }
+        if (simulcastActive && !Si4463_LoadTx(&radio2, txData, txSize)) {
+            simulcastActive = false;
+        }
+        // both FIFOs are loaded before either radio starts, keeping the starts close together
+        if (continuousEnabled && !simulcastActive) {
+            started = Si4463_StartStreamTx(&radio);
+        } else {
+            started = Si4463_StartTx(&radio);
+        }
+        if (started && simulcastActive && !Si4463_StartTx(&radio2)) {
+            simulcastActive = false;
+            uart_print("Simulcast transmission failed\r\n");
+        }
+    }
+    if (started) {
+        Airtime_TxStart();
+        Events_StartTimer(EVENT_RADIO_IRQ, RADIO_POLL_MS);
 
-            HAL_Delay(3000);
+        // continuous mode: a page encoded during a repeat gap may join this transmission
+        if (nextReady && continuousEnabled) {
+            Events_Set(EVENT_PAGE_QUEUE);
         }
+    } else {
+        uart_print("Transmission failed\r\n");
+        finishPage();
+    }
+}
+
+// Release the message buffer and let the next queued page in
+void finishPage(void) {
+    pageLoaded = false;
+    txRepeatsLeft = 0;
+    tuneRadio(channelFrequency);
+    Events_Set(EVENT_PAGE_QUEUE);
+}
+
+// Program the synthesizer only when the frequency changes
+void tuneRadio(float freq) {
+    if (freq != radioFrequency) {
+        Si4463_SetFrequency(&radio, freq);
+        radioFrequency = freq;
+    }
+}
+
+// Program the modem data rate only when it changes, on both radios for simulcast
+void setDataRate(uint16_t baud) {
+    if (baud != radio.currentBaud) {
+        Si4463_SetPOCSAGDataRate(&radio, baud);
+    }
+    if (radio2Present && baud != radio2.currentBaud) {
+        Si4463_SetPOCSAGDataRate(&radio2, baud);
+    }
+}
+
+bool isValidFrequency(float freq) {
+    return (freq >= 135.0F && freq <= 175.0F) ||
+           (freq >= 400.0F && freq <= 470.0F) ||
+           (freq >= 850.0F && freq <= 930.0F);
+}
+
+// Handle nIRQ / poll tick from the radio
+void serviceRadio(void) {
+    if (Si4463_IsReceiving(&radio)) {
+        serviceReceive();
+        return;
+    }
+
+    if (simulcastActive) {
+        Si4463_ServiceTx(&radio2);
+    }
+    if (Si4463_ServiceTx(&radio)) {
+        txEnded = true;
+    }
+
+    // the radio took the appended page, the buffer before it is free for the next one
+    if (appendPending && !Si4463_IsTxPending(&radio)) {
+        appendPending = false;
+        Events_Set(EVENT_PAGE_QUEUE);
+    }
+
+    // a simulcast page is done once the second radio has finished as well
+    if (txEnded && !(simulcastActive && Si4463_IsTransmitting(&radio2))) {
+        txEnded = false;
+        simulcastActive = false;
+        Perf_Mark(PERF_STAGE_TX_END);
+        Airtime_TxEnd();
+
+        if (txRepeatsLeft > 0) {
+            Events_StartTimer(EVENT_TX_NEXT, TX_REPEAT_GAP_MS);
+        } else {
+            uart_print("Transmission complete\r\n");
+            finishPage();
 
-        uart_print("Transmission complete\r\n");
+            // the next page is encoded already, put it on air without a round trip
+            // through the event loop
+            if (nextReady) {
+                servicePageQueue();
+            }
+        }
+    } else if (txEnded || Si4463_IsTransmitting(&radio)) {
+        // keep polling in case nIRQ is not wired
+        Events_StartTimer(EVENT_RADIO_IRQ, RADIO_POLL_MS);
     }
 }
 
 void parseAndSetFrequency(char* command) {
     int freq1 = 0, freq2 = 0;
+    int baud = channelBaud;
 
-    if (sscanf(command, "%*c %d %d", &freq1, &freq2) == 2) {
+    if (sscanf(command, "%*c %d %d %d", &freq1, &freq2, &baud) >= 2) {
         float newfreq = (float)freq1 + ((float)freq2) / 10000.0F;
 
+        if (baud != 512 && baud != 1200) {
+            uart_print("Error: baud must be 512 or 1200.\r\n");
+            return;
+        }
+
         // Validate frequency range
-        if ((newfreq >= 135.0F && newfreq <= 175.0F) ||
-            (newfreq >= 400.0F && newfreq <= 470.0F) ||
-            (newfreq >= 850.0F && newfreq <= 930.0F)) {
+        if (isValidFrequency(newfreq)) {
 
-            uart_printf("Switching to new frequency: %.4f MHz\r\n", newfreq);
+            uart_printf("Switching to new frequency: %.4f MHz, %d baud\r\n", newfreq, baud);
 
-            // Update SI4463 frequency
-            Si4463_SetFrequency(newfreq);
+            // Update SI4463 frequency, a page on air finishes on its own frequency.
+            // The data rate is set per transmission, queued pages keep theirs.
+            channelFrequency = newfreq;
+            channelBaud = baud;
+            if (!pageLoaded) {
+                tuneRadio(newfreq);
+            }
+
+            // the receiver only retunes on START_RX
+            if (Si4463_IsReceiving(&radio)) {
+                startReceive();
+            }
 
             uart_print("Frequency set successfully\r\n");
         } else {
@@ -212,10 +1082,482 @@ void parseAndSetFrequency(char* command) {
             uart_print("Valid ranges: 135-175 MHz, 400-470 MHz, 850-930 MHz\r\n");
         }
     } else {
-        uart_print("Invalid F command format. Use: F <freqmhz> <freq100Hz>\r\n");
-        uart_print("Example: F 433 9200 for 433.9200 MHz\r\n");
+        uart_print("Invalid F command format. Use: F <freqmhz> <freq100Hz> [baud]\r\n");
+        uart_print("Example: F 433 9200 for 433.9200 MHz, F 433 9200 512 for 512 baud pagers\r\n");
     }
 }
+
+// Print page pipeline timing: S to show, S R to reset
+void printStats(char* command) {
+    char arg = 0;
+
+    if (sscanf(command, "%*c %c", &arg) == 1 && (arg == 'R' || arg == 'r')) {
+        Perf_Reset();
+        radio.propSent = 0;
+        radio.propSkipped = 0;
+        uart_print("Statistics reset\r\n");
+        return;
+    }
+
+    uart_print("stage       count     min us     avg us     max us\r\n");
+    for (int i = 0; i < PERF_STAGE_COUNT; i++) {
+        const Perf_Stats_t* st = Perf_GetStats((Perf_Stage)i);
+
+        if (st->count == 0) {
+            uart_printf("%-8s %8d          -          -          -\r\n", Perf_GetStageName((Perf_Stage)i), 0);
+            continue;
+        }
+        uart_printf("%-8s %8lu %10lu %10lu %10lu\r\n", Perf_GetStageName((Perf_Stage)i),
+                    (unsigned long)st->count, (unsigned long)st->min_us,
+                    (unsigned long)(st->sum_us / st->count), (unsigned long)st->max_us);
+
+        // histogram, non-empty log2 buckets only: <upper bound us>:<count>
+        uart_print("  hist");
+        for (int b = 0; b < PERF_HIST_BUCKETS; b++) {
+            if (st->hist[b]) {
+                uart_printf(" <%lu:%u", 2UL << b, st->hist[b]);
+            }
+        }
+        uart_print("\r\n");
+    }
+
+    // property shadow: bytes the setters did not have to send
+    uart_printf("props    %8lu sent %lu skipped\r\n",
+                (unsigned long)radio.propSent, (unsigned long)radio.propSkipped);
+}
+
+// Show the duty-cycle budget: A to show, A <percent> to set the hourly limit
+void printAirtime(char* command) {
+    int percent = 0;
+
+    if (sscanf(command, "%*c %d", &percent) == 1) {
+        if (percent < 1 || percent > 100) {
+            uart_print("Invalid A command format. Use: A [limitpercent 1-100]\r\n");
+            return;
+        }
+        Airtime_SetLimit((uint8_t)percent);
+    }
+
+    uint32_t used = Airtime_GetUsedMs();
+    uint32_t budget = Airtime_GetBudgetMs();
+
+    uart_printf("Airtime last hour: %lu ms of %lu ms (limit %d%%), %lu ms left\r\n",
+                (unsigned long)used, (unsigned long)budget, Airtime_GetLimit(),
+                (unsigned long)((used < budget) ? budget - used : 0));
+    uart_printf("Pages queued: %d\r\n", PageQueue_Count());
+}
+
+// Listen on the channel while the transmitter is idle
+void startReceive(void) {
+    if (!monitorEnabled || pageLoaded) {
+        return;
+    }
+
+    PocsagDecoder_Flush(&rxDecoder);
+    rxSynced = false;
+    tuneRadio(channelFrequency);
+    setDataRate(channelBaud);
+    if (Si4463_StartRx(&radio, RX_SYNC_WORD)) {
+        Events_StartTimer(EVENT_RADIO_IRQ, RX_POLL_MS);
+    } else {
+        uart_print("Receiver start failed\r\n");
+    }
+}
+
+// Hand the radio back, a page being received is delivered as far as it got
+void stopReceive(void) {
+    if (Si4463_IsReceiving(&radio)) {
+        serviceReceive();
+        Si4463_StopRx(&radio);
+        Events_StopTimer(EVENT_RADIO_IRQ);
+    }
+    PocsagDecoder_Flush(&rxDecoder);
+}
+
+// Feed received bytes to the decoder, pages come back through onRxMessage()
+void serviceReceive(void) {
+    static uint8_t rxChunk[RX_CHUNK_LEN];
+    uint8_t len, events, rxEvents = 0;
+    uint32_t syncs = PocsagDecoder_GetStats(&rxDecoder)->syncs;
+
+    do {
+        len = Si4463_ServiceRx(&radio, rxChunk, sizeof(rxChunk), &events);
+        rxEvents |= events;
+        if (len > 0) {
+            // the radio strips the sync word it matched
+            if (!rxSynced) {
+                PocsagDecoder_Sync(&rxDecoder, RX_INVERTED);
+                rxSynced = true;
+            }
+            PocsagDecoder_PushBytes(&rxDecoder, rxChunk, len);
+        }
+    } while (len == sizeof(rxChunk));
+
+    if (rxEvents & SI4463_RX_OVERFLOW) {
+        // bytes are missing, let the decoder search for the next sync codeword
+        PocsagDecoder_Flush(&rxDecoder);
+    } else if (rxEvents & SI4463_RX_PACKET_END) {
+        // the radio hunts for a sync word again
+        rxSynced = false;
+    }
+
+    // batches still arriving, the repeater waits until the channel is quiet
+    if (PocsagDecoder_GetStats(&rxDecoder)->syncs != syncs) {
+        Repeater_ChannelActive();
+        if (Repeater_Pending() > 0) {
+            Events_StartTimer(EVENT_REPEAT, REPEATER_GATHER_MS);
+        }
+    }
+
+    // keep polling in case nIRQ is not wired
+    Events_StartTimer(EVENT_RADIO_IRQ, RX_POLL_MS);
+}
+
+// The TX start stage ends when the radio takes START_TX, not when the driver returns
+static void onTxStart(void *ctx) {
+    (void)ctx;
+    Perf_Mark(PERF_STAGE_TX_START);
+}
+
+// Queue a decoded page, printing is left to the main loop
+static void onRxMessage(void *ctx, const PocsagDecoder_Message_t *msg) {
+    uint8_t next = (rxPageHead + 1) % RX_PAGE_QUEUE_LEN;
+    (void)ctx;
+
+    // the repeater sends once the channel has been quiet for the gather time
+    if (Repeater_Offer(msg) || Repeater_Pending() > 0) {
+        Events_StartTimer(EVENT_REPEAT, REPEATER_GATHER_MS);
+    }
+
+    if (next == rxPageTail) {
+        rxPagesDropped++;
+        return;
+    }
+
+    RxPage_t* page = &rxPages[rxPageHead];
+    page->address = msg->address;
+    page->function = msg->function;
+    page->corrected = msg->corrected;
+    page->lost = msg->uncorrectable;
+
+    // the digits of a numeric page, the text of an alphanumeric one
+    strcpy(page->text, PocsagDecoder_GetText(msg));
+
+    rxPageHead = next;
+    Events_Set(EVENT_RX_PAGE);
+}
+
+void printReceivedPages(void) {
+    while (rxPageTail != rxPageHead) {
+        RxPage_t* page = &rxPages[rxPageTail];
+
+        uart_printf("RX %ld %d: %s", page->address, page->function, page->text);
+        if (page->corrected) {
+            uart_printf(" (%d bits corrected)", page->corrected);
+        }
+        if (page->lost) {
+            uart_printf(" (%d codewords lost)", page->lost);
+        }
+        uart_print("\r\n");
+
+        rxPageTail = (rxPageTail + 1) % RX_PAGE_QUEUE_LEN;
+    }
+}
+
+// Channel monitor: R to show, R 1 to decode the channel while idle, R 0 to stop
+void setMonitor(char* command) {
+    int on = 0;
+
+    if (sscanf(command, "%*c %d", &on) == 1) {
+        monitorEnabled = (on != 0);
+        if (monitorEnabled) {
+            startReceive();
+        } else {
+            stopReceive();
+        }
+    }
+
+    const PocsagDecoder_Stats_t* st = PocsagDecoder_GetStats(&rxDecoder);
+
+    uart_printf("Monitor %s%s\r\n", monitorEnabled ? "on" : "off",
+                Si4463_IsReceiving(&radio) ? ", receiving" : "");
+    uart_printf("Syncs %lu, codewords %lu, bits corrected %lu, uncorrectable %lu\r\n",
+                (unsigned long)st->syncs, (unsigned long)st->codewords,
+                (unsigned long)st->corrected, (unsigned long)st->uncorrectable);
+    uart_printf("Pages received %lu, dropped %lu\r\n",
+                (unsigned long)st->messages, (unsigned long)rxPagesDropped);
+}
+
+// Listen before talk: L to show, L <dBm> to enable with a threshold, L 0 to disable
+void setListenBeforeTalk(char* command) {
+    int threshold = 0;
+
+    if (sscanf(command, "%*c %d", &threshold) == 1) {
+        if (threshold == 0) {
+            Lbt_SetEnabled(false);
+        } else if (threshold < LBT_MIN_THRESHOLD_DBM || threshold > LBT_MAX_THRESHOLD_DBM) {
+            uart_printf("Invalid L command format. Use: L [threshold dBm %d..%d | 0 = off]\r\n",
+                        LBT_MIN_THRESHOLD_DBM, LBT_MAX_THRESHOLD_DBM);
+            return;
+        } else {
+            Lbt_SetThreshold(threshold);
+            Lbt_SetEnabled(true);
+        }
+    }
+
+    const Lbt_Stats_t* st = Lbt_GetStats();
+    int rssi;
+
+    if (Lbt_IsEnabled()) {
+        uart_printf("Listen before talk on, threshold %d dBm\r\n", Lbt_GetThreshold());
+    } else {
+        uart_print("Listen before talk off\r\n");
+    }
+    if (!Si4463_IsTransmitting(&radio) && Si4463_MeasureRssi(&radio, &rssi)) {
+        uart_printf("RSSI now %d dBm\r\n", rssi);
+    }
+    uart_printf("Checks %lu, busy %lu, sent busy %lu, backoff %lu ms\r\n",
+                (unsigned long)st->checks, (unsigned long)st->busy,
+                (unsigned long)st->gaveUp, (unsigned long)st->deferredMs);
+}
+
+// Repeater: D to show, D 1 [freqmhz freq100Hz] to repeat heard pages (on another
+// frequency), D 0 to stop, D R <first> <last> to limit to a RIC range, D R to clear
+void setRepeater(char* command) {
+    char arg = 0;
+    int on = 0, freq1 = 0, freq2 = 0;
+    long first = 0, last = 0;
+
+    if (sscanf(command, "%*c %c", &arg) == 1 && (arg == 'R' || arg == 'r')) {
+        int n = sscanf(command, "%*c %*c %ld %ld", &first, &last);
+
+        if (n == 2) {
+            if (!Repeater_AddRange(first, last)) {
+                uart_printf("Invalid range, up to %d ranges within 1..2097151\r\n", REPEATER_MAX_RANGES);
+                return;
+            }
+        } else if (n <= 0) {
+            Repeater_ClearRanges();
+        } else {
+            uart_print("Invalid D command format. Use: D R [<first> <last>]\r\n");
+            return;
+        }
+    } else {
+        int n = sscanf(command, "%*c %d %d %d", &on, &freq1, &freq2);
+
+        if (n == 3 && on) {
+            float newfreq = (float)freq1 + ((float)freq2) / 10000.0F;
+
+            if (!isValidFrequency(newfreq)) {
+                uart_print("Error: invalid frequency range.\r\n");
+                return;
+            }
+            repeaterFrequency = newfreq;
+        } else if (n == 2) {
+            uart_print("Invalid D command format. Use: D [0|1 [freqmhz freq100Hz]]\r\n");
+            return;
+        } else if (n == 1) {
+            repeaterFrequency = 0.0f;
+        }
+
+        if (n >= 1) {
+            Repeater_SetEnabled(on != 0);
+            if (on) {
+                // the repeater listens through the channel monitor
+                monitorEnabled = true;
+                startReceive();
+            }
+        }
+    }
+
+    const Repeater_Stats_t* st = Repeater_GetStats();
+
+    if (Repeater_IsEnabled()) {
+        if (repeaterFrequency > 0.0f) {
+            uart_printf("Repeater on, %.4f MHz -> %.4f MHz\r\n", channelFrequency, repeaterFrequency);
+        } else {
+            uart_printf("Repeater on, %.4f MHz\r\n", channelFrequency);
+        }
+    } else {
+        uart_print("Repeater off\r\n");
+    }
+    if (Repeater_GetRangeCount() == 0) {
+        uart_print("RIC all\r\n");
+    }
+    for (int i = 0; i < Repeater_GetRangeCount(); i++) {
+        const Repeater_Range_t* r = Repeater_GetRange(i);
+        uart_printf("RIC %ld-%ld\r\n", r->first, r->last);
+    }
+    uart_printf("Received %lu, filtered %lu, duplicates %lu, damaged %lu, dropped %lu\r\n",
+                (unsigned long)st->received, (unsigned long)st->filtered,
+                (unsigned long)st->duplicates, (unsigned long)st->damaged,
+                (unsigned long)st->dropped);
+    uart_printf("Forwarded %lu in %lu bursts, %d waiting\r\n",
+                (unsigned long)st->forwarded, (unsigned long)st->bursts, Repeater_Pending());
+}
+
+// Simulcast: M to show, M <freqmhz> <freq100Hz> to send every page on the
+// second radio as well, M 0 to stop
+void setSimulcast(char* command) {
+    int freq1 = 0, freq2 = 0;
+    int n = sscanf(command, "%*c %d %d", &freq1, &freq2);
+
+    if (n >= 1 && !radio2Present) {
+        uart_print("No second SI4463 on SPI2\r\n");
+        return;
+    }
+    if (n == 2) {
+        float newfreq = (float)freq1 + ((float)freq2) / 10000.0F;
+
+        if (!isValidFrequency(newfreq)) {
+            uart_print("Error: invalid frequency range.\r\n");
+            return;
+        }
+        // a simulcast in progress finishes on the old frequency
+        if (!Si4463_IsTransmitting(&radio2)) {
+            Si4463_SetFrequency(&radio2, newfreq);
+        }
+        simulcastFrequency = newfreq;
+    } else if (n == 1 && freq1 == 0) {
+        simulcastFrequency = 0.0f;
+    } else if (n == 1) {
+        uart_print("Invalid M command format. Use: M [<freqmhz> <freq100Hz> | 0]\r\n");
+        return;
+    }
+
+    if (!radio2Present) {
+        uart_print("Simulcast unavailable, no second SI4463\r\n");
+    } else if (simulcastFrequency > 0.0f) {
+        uart_printf("Simulcast on, %.4f MHz and %.4f MHz\r\n", channelFrequency, simulcastFrequency);
+    } else {
+        uart_print("Simulcast off\r\n");
+    }
+}
+
+// Direct mode TX: X to show, X 1 to clock pages onto GPIO0 of the first
+// radio from TIM2 instead of streaming them through the FIFO, X 0 to stop.
+// Simulcast pages keep using the FIFOs.
+void setDirectTx(char* command) {
+    int on = 0;
+
+    if (sscanf(command, "%*c %d", &on) == 1) {
+        if (on != 0 && on != 1) {
+            uart_print("Invalid X command format. Use: X [0|1]\r\n");
+            return;
+        }
+        directTxEnabled = on;
+    }
+
+    if (directTxEnabled) {
+        uart_print("Direct TX on, TIM2 clocks the data onto GPIO0 (PA8)\r\n");
+    } else {
+        uart_print("Direct TX off, pages stream through the TX FIFO\r\n");
+    }
+}
+
+// Continuous carrier: C to show, C 1 to append queued pages to the
+// transmission on air instead of starting a new one with its own preamble,
+// C 0 to stop. Each transmission is still started the usual way.
+void setContinuous(char* command) {
+    int on = 0;
+
+    if (sscanf(command, "%*c %d", &on) == 1) {
+        if (on != 0 && on != 1) {
+            uart_print("Invalid C command format. Use: C [0|1]\r\n");
+            return;
+        }
+        continuousEnabled = on;
+    }
+
+    if (continuousEnabled) {
+        uart_print("Continuous carrier on, queued pages are appended to the transmission on air\r\n");
+    } else {
+        uart_print("Continuous carrier off, every page starts with its own preamble\r\n");
+    }
+}
+
+// Page grouping: G <holdms> holds new pages that long and sends the queued
+// pages as one burst per data rate, G 0 sends every page on its own
+void setGrouping(char* command) {
+    int holdMs = 0;
+
+    if (sscanf(command, "%*c %d", &holdMs) == 1) {
+        if (holdMs < 0 || holdMs > GROUP_HOLD_MAX_MS) {
+            uart_printf("Invalid G command format. Use: G [holdms|0], up to %d ms\r\n", GROUP_HOLD_MAX_MS);
+            return;
+        }
+        groupHoldMs = (uint32_t)holdMs;
+        if (groupHoldMs == 0) {
+            Events_StopTimer(EVENT_GROUP);
+            Events_Set(EVENT_PAGE_QUEUE);
+        }
+    }
+
+    if (groupHoldMs > 0) {
+        uart_printf("Grouping on: pages are held %lu ms, one burst per data rate\r\n", (unsigned long)groupHoldMs);
+    } else {
+        uart_print("Grouping off, every page gets its own transmission\r\n");
+    }
+}
+
+#ifdef POCSAG_BENCH
+// Encoder benchmark: B [pages per mix], timed with the DWT cycle counter
+void runBenchmark(char* command) {
+    static PocsagBench_Result_t result;
+    int pages = 200;
+
+    if (sscanf(command, "%*c %d", &pages) == 1 && pages < 1) {
+        uart_print("Invalid B command format. Use: B [pages]\r\n");
+        return;
+    }
+
+    uart_printf("Encoder benchmark at %lu MHz\r\n", (unsigned long)(SystemCoreClock / 1000000));
+    uart_print("mix          pages  cyc/page      min      max  us/page  codewords/s  stack\r\n");
+    for (int m = 0; m < PocsagBench_MixCount; m++) {
+        const PocsagBench_Mix_t* mix = &PocsagBench_Mixes[m];
+        uint32_t n = pages;
+
+        // a sweep always covers every combination the same number of times
+        if (mix->sweep) {
+            n = (n + POCSAG_BENCH_SWEEP - 1) / POCSAG_BENCH_SWEEP * POCSAG_BENCH_SWEEP;
+        }
+        PocsagBench_Run(mix, n, 1, &result);
+
+        uint32_t avg = (uint32_t)(result.ticks / result.pages);
+        uart_printf("%-10s %7lu %9lu %8lu %8lu %8lu %12lu %6lu\r\n", mix->name,
+                    (unsigned long)result.pages, (unsigned long)avg,
+                    (unsigned long)result.minTicks, (unsigned long)result.maxTicks,
+                    (unsigned long)((uint64_t)avg * 1000000 / SystemCoreClock),
+                    (unsigned long)(result.ticks ? (uint64_t)result.codewords * SystemCoreClock / result.ticks : 0),
+                    (unsigned long)result.stackBytes);
+    }
+}
+#endif
+
+#ifdef SI4463_TRACE
+// SPI trace: T to dump (oldest first, for Host/pocsag_trace.c), T R to clear
+void dumpTrace(char* command) {
+    char arg = 0;
+    uint16_t count = Si4463Trace_GetCount();
+
+    if (sscanf(command, "%*c %c", &arg) == 1 && (arg == 'R' || arg == 'r')) {
+        Si4463Trace_Clear();
+        uart_print("Trace cleared\r\n");
+        return;
+    }
+
+    uart_printf("# SI4463 trace: unit %08lX%08lX%08lX, %u entries, %lu overwritten\r\n",
+                (unsigned long)HAL_GetUIDw2(), (unsigned long)HAL_GetUIDw1(), (unsigned long)HAL_GetUIDw0(),
+                count, (unsigned long)Si4463Trace_GetLost());
+    uart_print("# time_us bus type cmd len resp total_us cts_us polls\r\n");
+    for (uint16_t i = 0; i < count; i++) {
+        const Si4463Trace_Entry_t* e = Si4463Trace_Get(i);
+
+        uart_printf("@ %lu %u %c %02X %u %u %lu %lu %u\r\n", (unsigned long)e->timeUs, e->bus, e->type,
+                    e->cmd, e->len, e->resp, (unsigned long)e->totalUs, (unsigned long)e->ctsUs, e->polls);
+    }
+}
+#endif
 /* USER CODE END 0 */
 
 /**
@@ -250,24 +1592,83 @@ int main(void)
   MX_SPI1_Init();
   MX_USART1_UART_Init();
   /* USER CODE BEGIN 2 */
+  Events_Init();
+#ifdef SI4463_TRACE
+  Si4463Trace_Init();
+#endif
+  UartTx_Init(&huart1);
+  Clock_Init(&hspi1, &huart1);
+  Perf_Init();
+  Airtime_Init(AIRTIME_DEFAULT_LIMIT_PERCENT);
+  PageQueue_Init();
+  Lbt_Init(HAL_GetUIDw0() ^ HAL_GetUIDw1() ^ HAL_GetUIDw2());
+  Repeater_Init();
+
   // Initialize POCSAG
-  Pocsag_Init(&pocsag);
+  Pocsag_Init(&pocsag[0]);
+  Pocsag_Init(&pocsag[1]);
+  PocsagDecoder_Init(&rxDecoder, onRxMessage, NULL);
 
+  DirectTx_Init(DIRECT_TX_PORT, DIRECT_TX_PIN);
   setupSI4463();
+  setupSecondSI4463();
+
+  // scheduled power cycles cost airtime, keep an eye on the boot time
+  uart_printf("Boot: radio ready in %lu ms, %lu ms after reset\r\n",
+              (unsigned long)radio.bootMs, (unsigned long)HAL_GetTick());
 
   uart_print("\r\nPOCSAG text-message tool v0.1 (STM32F103 + SI4463)\r\n");
   uart_print("https://github.com/on1arf/pocsag\r\n");
   uart_print("Format:\r\n");
   uart_print("P <address> <source> <repeat> <message>\r\n");
-  uart_print("F <freqmhz> <freq100Hz>\r\n");
+  uart_print("F <freqmhz> <freq100Hz> [baud]\r\n");
+  uart_print("S [R]\r\n");
+  uart_print("A [limitpercent]\r\n");
+  uart_print("R [0|1]\r\n");
+  uart_print("L [dBm|0]\r\n");
+  uart_print("D [0|1 [freqmhz freq100Hz]] | D R [first last]\r\n");
+  uart_print("M [freqmhz freq100Hz|0]\r\n");
+  uart_print("X [0|1]\r\n");
+  uart_print("C [0|1]\r\n");
+  uart_print("G [holdms|0]\r\n");
+  uart_print("N [number [repeat]]\r\n");
+  uart_print("U [alias repeat [message]]\r\n");
+#ifdef POCSAG_BENCH
+  uart_print("B [pages]\r\n");
+#endif
+#ifdef SI4463_TRACE
+  uart_print("T [R]\r\n");
+#endif
+
+  uartRxStart();
   /* USER CODE END 2 */
 
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-    processPOCSAGCommand();
-    HAL_Delay(100);
+    // sleep until an interrupt raises an event, then run each handler to completion
+    uint32_t events = Events_Wait();
+
+    if (events & EVENT_UART_RX) {
+      processPOCSAGCommand();
+    }
+    if (events & EVENT_RADIO_IRQ) {
+      serviceRadio();
+    }
+    if (events & EVENT_RX_PAGE) {
+      printReceivedPages();
+    }
+    if (events & (EVENT_TX_NEXT | EVENT_PAGE_QUEUE | EVENT_REPEAT | EVENT_GROUP)) {
+      Clock_SetProfile(CLOCK_PROFILE_PERFORMANCE);
+      if (events & EVENT_TX_NEXT) {
+        startNextTransmission();
+      }
+      if (events & (EVENT_PAGE_QUEUE | EVENT_REPEAT | EVENT_GROUP)) {
+        servicePageQueue();
+      }
+      Clock_SetProfile(CLOCK_PROFILE_LOWPOWER);
+    }
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -418,12 +1819,16 @@ static void MX_GPIO_Init(void)
 
   /* USER CODE BEGIN MX_GPIO_Init_2 */
   // Configure additional SI4463 pins
-  // PB1 as input (NIRQ)
+  // PB1 as input (NIRQ), falling edge raises EVENT_RADIO_IRQ
+  // pulled up so an unconnected nIRQ stays quiet
   GPIO_InitStruct.Pin = GPIO_PIN_1;
-  GPIO_InitStruct.Mode = GPIO_MODE_INPUT;
-  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
+  GPIO_InitStruct.Pull = GPIO_PULLUP;
   HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
 
+  HAL_NVIC_SetPriority(EXTI1_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(EXTI1_IRQn);
+
   // PB10 as output (CS)
   GPIO_InitStruct.Pin = GPIO_PIN_10;
   GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
@@ -0,0 +1,87 @@
+/*
+ * pagequeue.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "pagequeue.h"
+#include <string.h>
+
+// FIFO of pages, only used from the main loop
+static Page_t pages[PAGEQUEUE_LEN];
+static int head = 0;
+static int count = 0;
+
+void PageQueue_Init(void) {
+    head = 0;
+    count = 0;
+}
+
+// Append a page, fails when the queue is full
+bool PageQueue_Push(const Page_t* page) {
+    if (page == NULL || count >= PAGEQUEUE_LEN) {
+        return false;
+    }
+
+    memcpy(&pages[(head + count) % PAGEQUEUE_LEN], page, sizeof(Page_t));
+    count++;
+    return true;
+}
+
+// Remove the oldest page
+bool PageQueue_Pop(Page_t* page) {
+    if (page == NULL || count == 0) {
+        return false;
+    }
+
+    memcpy(page, &pages[head], sizeof(Page_t));
+    head = (head + 1) % PAGEQUEUE_LEN;
+    count--;
+    return true;
+}
+
+// Look at the oldest page with the given data rate, it stays queued
+bool PageQueue_PeekBaud(Page_t* page, uint16_t baud) {
+    if (page == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const Page_t* p = &pages[(head + i) % PAGEQUEUE_LEN];
+
+        if (p->baud == baud) {
+            memcpy(page, p, sizeof(Page_t));
+            return true;
+        }
+    }
+    return false;
+}
+
+// Remove the oldest page with the given data rate, the pages before it keep their order
+bool PageQueue_PopBaud(Page_t* page, uint16_t baud) {
+    if (page == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int slot = (head + i) % PAGEQUEUE_LEN;
+
+        if (pages[slot].baud == baud) {
+            memcpy(page, &pages[slot], sizeof(Page_t));
+            // close the gap from the head side
+            for (; i > 0; i--) {
+                int prev = (head + i - 1) % PAGEQUEUE_LEN;
+
+                memcpy(&pages[(head + i) % PAGEQUEUE_LEN], &pages[prev], sizeof(Page_t));
+            }
+            head = (head + 1) % PAGEQUEUE_LEN;
+            count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+int PageQueue_Count(void) {
+    return count;
+}
@@ -0,0 +1,138 @@
+/*
+ * perf.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "perf.h"
+#include "main.h"
+#include <string.h>
+
+static Perf_Stats_t stats[PERF_STAGE_COUNT];
+
+static const char* const stageNames[PERF_STAGE_COUNT] = {
+    "parse", "queue", "encode", "fifo", "txstart", "txend", "to-air"
+};
+
+// Current page: microseconds accumulated since the last mark / page start.
+// Cycles are folded into microseconds whenever the core clock changes, so a
+// stage spanning a clock profile switch is still measured correctly.
+static bool pageActive = false;
+static uint32_t lastCycles = 0;
+static uint32_t lastTick = 0;
+static uint32_t sinceMarkUs = 0;
+static uint32_t sincePageUs = 0;
+static uint32_t cycleRemainder = 0;
+
+// Private function prototypes
+static void perf_accumulate(void);
+static void perf_record(Perf_Stage stage, uint32_t us);
+
+// Enable the DWT cycle counter. The core clock is gated in WFI sleep and
+// the counter stops with it, the time spent asleep is then taken from
+// SysTick (see perf_accumulate). -DPOCSAG_PERF_SLEEP sets DBG_SLEEP instead,
+// keeping the clock running in sleep for exact figures at some extra
+// sleep current.
+void Perf_Init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#ifdef POCSAG_PERF_SLEEP
+    HAL_DBGMCU_EnableDBGSleepMode();
+#endif
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    Perf_Reset();
+}
+
+// Clear all statistics
+void Perf_Reset(void) {
+    memset(stats, 0, sizeof(stats));
+    for (int i = 0; i < PERF_STAGE_COUNT; i++) {
+        stats[i].min_us = UINT32_MAX;
+    }
+    pageActive = false;
+}
+
+// Start timing a page (or a repeat of it)
+void Perf_BeginPage(void) {
+    pageActive = true;
+    lastCycles = DWT->CYCCNT;
+    lastTick = HAL_GetTick();
+    cycleRemainder = 0;
+    sinceMarkUs = 0;
+    sincePageUs = 0;
+}
+
+// Record the end of a stage
+void Perf_Mark(Perf_Stage stage) {
+    if (!pageActive || stage >= PERF_STAGE_COUNT) return;
+
+    perf_accumulate();
+    perf_record(stage, sinceMarkUs);
+    sinceMarkUs = 0;
+
+    if (stage == PERF_STAGE_TX_START) {
+        perf_record(PERF_STAGE_TO_AIR, sincePageUs);
+    } else if (stage == PERF_STAGE_TX_END) {
+        pageActive = false;
+    }
+}
+
+// Called before SystemCoreClock changes, converts elapsed cycles at the old rate
+void Perf_ClockChanging(void) {
+    if (pageActive) {
+        perf_accumulate();
+    }
+}
+
+const Perf_Stats_t* Perf_GetStats(Perf_Stage stage) {
+    if (stage >= PERF_STAGE_COUNT) return NULL;
+    return &stats[stage];
+}
+
+const char* Perf_GetStageName(Perf_Stage stage) {
+    if (stage >= PERF_STAGE_COUNT) return "?";
+    return stageNames[stage];
+}
+
+// Private functions
+static void perf_accumulate(void) {
+    uint32_t now = DWT->CYCCNT;
+    uint32_t tick = HAL_GetTick();
+    uint32_t cyclesPerUs = SystemCoreClock / 1000000U;
+    uint32_t cycles = (now - lastCycles) + cycleRemainder;
+    uint32_t us = cycles / cyclesPerUs;
+
+    cycleRemainder = cycles - us * cyclesPerUs;
+
+    // n SysTicks mean at least n - 2 ms have passed, more than the cycles
+    // show when the counter stood still in sleep. One tick may still have
+    // been pending at the previous mark, hence 2 rather than 1.
+    uint32_t ticks = tick - lastTick;
+    if (ticks > 2 && (ticks - 2) * 1000U > us) {
+        us = (ticks - 2) * 1000U;
+        cycleRemainder = 0;
+    }
+
+    lastCycles = now;
+    lastTick = tick;
+    sinceMarkUs += us;
+    sincePageUs += us;
+}
+
+static void perf_record(Perf_Stage stage, uint32_t us) {
+    Perf_Stats_t *s = &stats[stage];
+    int bucket = 0;
+
+    s->count++;
+    s->sum_us += us;
+    if (us < s->min_us) s->min_us = us;
+    if (us > s->max_us) s->max_us = us;
+
+    while ((us >> (bucket + 1)) != 0 && bucket < PERF_HIST_BUCKETS - 1) {
+        bucket++;
+    }
+    if (s->hist[bucket] < UINT16_MAX) {
+        s->hist[bucket]++;
+    }
+}
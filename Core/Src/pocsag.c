@@ -4,11 +4,26 @@
  *  Created on: Oct 21, 2025
  *      Author: peter
  */
-#include "pocsag.h"
+#include "Pocsag.h"
 #include <string.h>
 
+#define POCSAG_SYNC 0x7CD215D8
+#define POCSAG_IDLE 0x7A89C197
+
+// messages can be up to 40 chars (+ terminating EOT) or 40 digits
+#define POCSAG_MAX_TEXT 40
+
+// numeric pagers know 16 characters, sent as their index in this table
+static const char numericchars[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '*', 'U', ' ', '-', ')', '('
+};
+
 // Private function prototypes
-static void replaceline(Pocsag_t* pocsag, int line, uint32_t val);
+static int createpocsag(Pocsag_t* pocsag, long int address, int source, const char* text, int option_batch2, int option_invert, bool numeric);
+static int encoderinit(Pocsag_Encoder_t* enc, long int address, int source, const char* text, int option_batch2, int option_invert, bool numeric);
+static uint32_t messageline(const Pocsag_Encoder_t* enc, int index);
+static uint32_t numericline(const Pocsag_Encoder_t* enc, int index);
+static int numericcode(char c);
 static uint8_t flip7charbitorder(uint8_t c_in);
 static uint32_t createcrc(uint32_t in);
 
@@ -47,324 +62,306 @@ void* Pocsag_GetMsgPointer(Pocsag_t* pocsag) {
 }
 
 // creates pocsag message in pocsagmsg structure
-int Pocsag_CreatePocsag(Pocsag_t* pocsag, long int address, int source, char* text, int option_batch2, int option_invert) {
-    if (pocsag == NULL || text == NULL) {
-        return POCSAG_FAILED;
-    }
-
-    int txtlen;
-    uint8_t c; // temporary var for character being processed
-    int stop; // temp var
+int Pocsag_CreatePocsag(Pocsag_t* pocsag, long int address, int source, const char* text, int option_batch2, int option_invert) {
+    return createpocsag(pocsag, address, source, text, option_batch2, option_invert, false);
+}
 
-    char lastchar; // memorize last char of input text
-    uint8_t txtcoded[56]; // encoded text can be up to 56 octets
-    int txtcodedlen;
+// creates a numeric message for numeric pagers, digits are 0-9, '*', 'U',
+// ' ', '-', ')' and '('. No digits at all makes a tone-only page.
+int Pocsag_CreatePocsagNumeric(Pocsag_t* pocsag, long int address, int source, const char* digits, int option_batch2, int option_invert) {
+    return createpocsag(pocsag, address, source, digits, option_batch2, option_invert, true);
+}
 
-    // local vars to encode address line
-    int currentframe;
-    uint32_t addressline;
+// Check the parameters and set up the encoder, the codewords are produced by
+// Pocsag_EncoderNext(). Same checks and error codes as Pocsag_CreatePocsag.
+int Pocsag_EncoderInit(Pocsag_Encoder_t* enc, long int address, int source, const char* text, int option_batch2, int option_invert) {
+    return encoderinit(enc, address, source, text, option_batch2, option_invert, false);
+}
 
-    // counters to encode text
-    int bitcount_in, bitcount_out, bytecount_in, bytecount_out;
+// As Pocsag_EncoderInit for a numeric message, see Pocsag_CreatePocsagNumeric
+int Pocsag_EncoderInitNumeric(Pocsag_Encoder_t* enc, long int address, int source, const char* digits, int option_batch2, int option_invert) {
+    return encoderinit(enc, address, source, digits, option_batch2, option_invert, true);
+}
 
-    // table to convert size to n-times 1 bit mask
-    const uint8_t size2mask[7] = {0x01, 0x03, 0x07, 0x0f, 0x1f, 0x3f, 0x7f};
+// Next codeword of the transmission, false when it is complete
+bool Pocsag_EncoderNext(Pocsag_Encoder_t* enc, uint32_t* codeword) {
+    int slot, line;
+    uint32_t cw;
 
-    // some sanity checks
-    txtlen = strlen(text);
-    if (txtlen > 40) {
-        // messages can be up to 40 chars (+ terminating EOT)
-        txtlen = 40;
+    if (enc == NULL || codeword == NULL) {
+        return false;
     }
 
-    // reinit state to 0 (no message)
-    pocsag->state = 0;
-    pocsag->error = POCSAGRC_UNDETERMINED;
-    pocsag->size = 0;
-
-    // some sanity checks for the address
-    // addresses are 21 bits
-    if ((address > 0x1FFFFF) || (address <= 0)) {
-        pocsag->error = POCSAGRC_INVALIDADDRESS;
-        return POCSAG_FAILED;
-    }
-
-    // source is 2 bits
-    if ((source < 0) || (source > 3)) {
-        pocsag->error = POCSAGRC_INVALIDSOURCE;
-        return POCSAG_FAILED;
+    // part 0.1: frame synchronization pattern, unless the transmitter sends it
+    // pattern 0x55 is inverse of 0xaa
+    if (enc->preamble > 0) {
+        enc->preamble--;
+        *codeword = 0xaaaaaaaa ^ enc->invert;
+        return true;
     }
 
-    // option "batch2" goes from 0 to 2
-    if ((option_batch2 < 0) || (option_batch2 > 2)) {
-        pocsag->error = POCSAGRC_INVALIDBATCH2OPT;
-        return POCSAG_FAILED;
+    // a batch is the sync codeword followed by 16 lines
+    if (enc->pos >= enc->batches * 17) {
+        return false;
     }
+    slot = enc->pos % 17;
+    line = (enc->pos / 17) * 16 + slot - 1;
+    enc->pos++;
+
+    if (slot == 0) {
+        // part 0.2: batch synchronization
+        // 0111 1100 1101 0010 0001 0101 1101 1000
+        cw = POCSAG_SYNC;
+    } else {
+        if (enc->batch2copy) {
+            line %= 16;
+        }
 
-    // option "invert" should be 0 or 1
-    if ((option_invert < 0) || (option_invert > 1)) {
-        pocsag->error = POCSAGRC_INVALIDINVERTOPT;
-        return POCSAG_FAILED;
+        if (line == enc->addressline) {
+            cw = enc->addresscw;
+        } else if (line > enc->addressline && line <= enc->lastline) {
+            cw = messageline(enc, line - enc->addressline - 1);
+        } else {
+            // all other lines are "idle-pattern"
+            cw = POCSAG_IDLE;
+        }
     }
 
-    // replace terminating \0 by EOT
-    lastchar = text[txtlen];
-    text[txtlen] = 0x04; // EOT (end of transmission)
-    txtlen++; // increase size by 1 (for EOT)
+    // invert bits if needed
+    *codeword = cw ^ enc->invert;
+    return true;
+}
 
-    // now we know everything is OK. Set state to 1 (message)
-    pocsag->state = 1;
+// Message size in octets, as Pocsag_GetSize
+int Pocsag_EncoderGetSize(Pocsag_Encoder_t* enc) {
+    if (enc == NULL || enc->batches == 0) return 0;
+    return enc->batches == 1 ? POCSAG_MSG_SIZE_1BATCH : POCSAG_MSG_SIZE_2BATCH;
+}
 
-    // create packet
+// The address codeword and the message codewords after it, without frame
+// layout and in normal polarity, as PocsagBurst_Add() takes them. Returns
+// the number of codewords, 0 when they do not fit in max.
+int Pocsag_EncoderGetCodewords(Pocsag_Encoder_t* enc, uint32_t* codewords, int max) {
+    int count;
 
-    // part 0.1: frame synchronization pattern
-    if (option_invert == 0) {
-        memset(pocsag->Pocsagmsg.sync, 0xaa, 72);
-    } else {
-        memset(pocsag->Pocsagmsg.sync, 0x55, 72); // pattern 0x55 is inverse of 0xaa
-    }
+    if (enc == NULL || codewords == NULL || enc->batches == 0) return 0;
 
-    // part 0.2: batch synchronization
-    // a batch begins with a sync codeword
-    // 0111 1100 1101 0010 0001 0101 1101 1000
-    pocsag->Pocsagmsg.synccw1[0] = 0x7c;  pocsag->Pocsagmsg.synccw1[1] = 0xd2;
-    pocsag->Pocsagmsg.synccw1[2] = 0x15;  pocsag->Pocsagmsg.synccw1[3] = 0xd8;
+    count = enc->lastline - enc->addressline + 1;
+    if (count > max) return 0;
 
-    pocsag->Pocsagmsg.synccw2[0] = 0x7c;  pocsag->Pocsagmsg.synccw2[1] = 0xd2;
-    pocsag->Pocsagmsg.synccw2[2] = 0x15;  pocsag->Pocsagmsg.synccw2[3] = 0xd8;
+    codewords[0] = enc->addresscw;
+    for (int l = 1; l < count; l++) {
+        codewords[l] = messageline(enc, l - 1);
+    }
+    return count;
+}
 
-    // invert bits if needed
-    if (option_invert == 1) {
-        pocsag->Pocsagmsg.synccw1[0] ^= 0xff; pocsag->Pocsagmsg.synccw1[1] ^= 0xff;
-        pocsag->Pocsagmsg.synccw1[2] ^= 0xff; pocsag->Pocsagmsg.synccw1[3] ^= 0xff;
+// Encode a message straight into a sink, no message buffer is needed. On
+// failure error (if not NULL) gets the reason, POCSAGRC_SINKABORTED when the
+// sink stopped it half way.
+int Pocsag_Encode(long int address, int source, const char* text, int option_batch2, int option_invert,
+                  Pocsag_Sink_t sink, void* ctx, int* error) {
+    Pocsag_Encoder_t enc;
+    uint32_t cw;
 
-        pocsag->Pocsagmsg.synccw2[0] ^= 0xff; pocsag->Pocsagmsg.synccw2[1] ^= 0xff;
-        pocsag->Pocsagmsg.synccw2[2] ^= 0xff; pocsag->Pocsagmsg.synccw2[3] ^= 0xff;
+    if (error != NULL) {
+        *error = POCSAGRC_UNDETERMINED;
     }
-
-    // part 0.3: init batches with all "idle-pattern"
-    for (int l = 0; l < 16; l++) {
-        pocsag->Pocsagmsg.batch1[l] = 0x7a89c197;
-        pocsag->Pocsagmsg.batch2[l] = 0x7a89c197;
+    if (sink == NULL) {
+        return POCSAG_FAILED;
     }
 
-    // part 1: address line
-    currentframe = ((address & 0x7) << 1);
-    addressline = address >> 3;
-
-    // add address source
-    addressline <<= 2;
-    addressline += source;
+    if (!Pocsag_EncoderInit(&enc, address, source, text, option_batch2, option_invert)) {
+        if (error != NULL) {
+            *error = enc.error;
+        }
+        return POCSAG_FAILED;
+    }
 
-    // replace address line
-    replaceline(pocsag, currentframe, createcrc(addressline << 11));
+    while (Pocsag_EncoderNext(&enc, &cw)) {
+        if (!sink(ctx, cw)) {
+            if (error != NULL) {
+                *error = POCSAGRC_SINKABORTED;
+            }
+            return POCSAG_FAILED;
+        }
+    }
+    return POCSAG_SUCCESS;
+}
 
-    // part 2.1: convert text to pocsag format
-    // init vars
-    memset(txtcoded, 0x00, 56); // 56 octets, all "0x00"
+// Private functions
+// Encode into the message buffer of pocsag
+static int createpocsag(Pocsag_t* pocsag, long int address, int source, const char* text, int option_batch2, int option_invert, bool numeric) {
+    Pocsag_Encoder_t enc;
+    uint8_t* out;
+    uint32_t cw;
 
-    bitcount_out = 7; // 1 char can contain up to 7 bits
-    bytecount_out = 0;
+    if (pocsag == NULL || text == NULL) {
+        return POCSAG_FAILED;
+    }
 
-    bitcount_in = 7;
-    bytecount_in = 0;
-    c = flip7charbitorder(text[0]); // start with first char
+    // reinit state to 0 (no message)
+    pocsag->state = 0;
+    pocsag->size = 0;
 
-    txtcodedlen = 0;
-    txtcoded[0] = 0x80; // output, initialize as empty with leftmost bit="1"
+    if (!encoderinit(&enc, address, source, text, option_batch2, option_invert, numeric)) {
+        pocsag->error = enc.error;
+        return POCSAG_FAILED;
+    }
 
-    // loop for all chars
-    stop = 0;
+    // now we know everything is OK. Set state to 1 (message)
+    pocsag->state = 1;
+    pocsag->error = POCSAGRC_UNDETERMINED;
 
-    while (!stop) {
-        int bits2copy;
-        uint8_t t; // temporary var bits to be copied
+    // copying is done octet per octet to be architecture / endian independent
+    out = (uint8_t*)&pocsag->Pocsagmsg;
+    while (Pocsag_EncoderNext(&enc, &cw)) {
+        out[0] = (cw >> 24) & 0xff; out[1] = (cw >> 16) & 0xff;
+        out[2] = (cw >> 8) & 0xff; out[3] = cw & 0xff;
+        out += 4;
+    }
 
-        // how many bits to copy?
-        // minimum of "bits available for input" and "bits that can be stored"
-        if (bitcount_in > bitcount_out) {
-            bits2copy = bitcount_out;
-        } else {
-            bits2copy = bitcount_in;
-        }
+    pocsag->size = Pocsag_EncoderGetSize(&enc);
+    return POCSAG_SUCCESS;
+}
 
-        // copy "bits2copy" bits, shifted the left if needed
-        t = c & (size2mask[bits2copy-1] << (bitcount_in - bits2copy));
-
-        // where to place ?
-        // move left to write if needed
-        if (bitcount_in > bitcount_out) {
-            // move to right and export
-            t >>= (bitcount_in - bitcount_out);
-        } else if (bitcount_in < bitcount_out) {
-            // move to left
-            t <<= (bitcount_out - bitcount_in);
-        }
 
-        // now copy bits
-        txtcoded[txtcodedlen] |= t;
-
-        // decrease bit counters
-        bitcount_in -= bits2copy;
-        bitcount_out -= bits2copy;
-
-        // outbound queue is full
-        if (bitcount_out == 0) {
-            // go to next position in txtcoded
-            bytecount_out++;
-            txtcodedlen++;
-
-            // data is stored in codeblocks, each containing 20 bits of useful data
-            if (bytecount_out == 1) {
-                // 2nd char of codeword:
-                // all 8 bits used, init with all 0
-                txtcoded[txtcodedlen] = 0x00;
-                bitcount_out = 8;
-            } else if (bytecount_out == 2) {
-                // 3rd char of codeword:
-                // only 5 bits used, init with all 0
-                txtcoded[txtcodedlen] = 0x00;
-                bitcount_out = 5;
-            } else if (bytecount_out >= 3) {
-                // 1st char of codeword (wrap around of "bytecount_out" value)
-                // init with leftmost bit as "1"
-                txtcoded[txtcodedlen] = 0x80;
-                bitcount_out = 7;
-
-                // wrap around "bytecount_out" value
-                bytecount_out = 0;
-            }
-        }
+static int encoderinit(Pocsag_Encoder_t* enc, long int address, int source, const char* text, int option_batch2, int option_invert, bool numeric) {
+    int txtlen;
+    int codewords;
+    uint32_t addressline;
 
-        // ingress queue is empty
-        if (bitcount_in == 0) {
-            bytecount_in++;
-
-            // any more text ?
-            if (bytecount_in < txtlen) {
-                // reinit vars
-                c = flip7charbitorder(text[bytecount_in]);
-                bitcount_in = 7; // only use 7 bits of every char
-            } else {
-                // no more text
-                // done, so ... stop!!
-                stop = 1;
-                continue;
-            }
-        }
+    if (enc == NULL) {
+        return POCSAG_FAILED;
     }
 
-    // increase txtcodedlen. Was used as index (0 to ...) above. Add one to
-    // make it indicate a length
-    txtcodedlen++;
-
-    // Part 2.2: copy coded message into pocsag message
-    // now insert text message
-    for (int l = 0; l < txtcodedlen; l += 3) {
-        uint32_t t;
+    // nothing to send until everything is checked
+    enc->error = POCSAGRC_UNDETERMINED;
+    enc->batches = 0;
+    enc->preamble = 0;
+    enc->pos = 0;
 
-        // move up to next frame
-        currentframe++;
+    if (text == NULL) {
+        return POCSAG_FAILED;
+    }
 
-        // copying is done octet per octet to be architecture / endian independent
-        t = (uint32_t)txtcoded[l] << 24; // copy octet to bits 24 to 31 in 32 bit struct
-        t |= (uint32_t)txtcoded[l+1] << 16; // copy octet to bits 16 to 23 in 32 bit struct
-        t |= (uint32_t)txtcoded[l+2] << 11; // copy octet to bits 11 to 15 in 32 bit struct
+    // some sanity checks for the address
+    // addresses are 21 bits
+    if ((address > 0x1FFFFF) || (address <= 0)) {
+        enc->error = POCSAGRC_INVALIDADDRESS;
+        return POCSAG_FAILED;
+    }
 
-        replaceline(pocsag, currentframe, createcrc(t));
+    // source is 2 bits
+    if ((source < 0) || (source > 3)) {
+        enc->error = POCSAGRC_INVALIDSOURCE;
+        return POCSAG_FAILED;
+    }
 
-        // note: move up 3 chars at a time (see "for" above)
+    // option "batch2" goes from 0 to 2
+    if ((option_batch2 < 0) || (option_batch2 > 2)) {
+        enc->error = POCSAGRC_INVALIDBATCH2OPT;
+        return POCSAG_FAILED;
     }
 
-    // invert bits if needed
-    if (option_invert) {
-        for (int l = 0; l < 16; l++) {
-            pocsag->Pocsagmsg.batch1[l] ^= 0xffffffff;
-        }
+    // option "invert" should be 0 or 1
+    if ((option_invert < 0) || (option_invert > 1)) {
+        enc->error = POCSAGRC_INVALIDINVERTOPT;
+        return POCSAG_FAILED;
+    }
 
-        for (int l = 0; l < 16; l++) {
-            pocsag->Pocsagmsg.batch2[l] ^= 0xffffffff;
+    // the text is cut at 40 chars, an EOT takes the place of the terminating \0
+    for (txtlen = 0; txtlen < POCSAG_MAX_TEXT && text[txtlen] != '\0'; txtlen++) {
+        if (numeric && numericcode(text[txtlen]) < 0) {
+            enc->error = POCSAGRC_INVALIDDIGIT;
+            return POCSAG_FAILED;
         }
     }
+    enc->text = text;
+    enc->numeric = numeric;
+    enc->txtlen = numeric ? txtlen : txtlen + 1;
 
-    // convert to make endian/architecture independent
-    for (int l = 0; l < 16; l++) {
-        int32_t t1;
-
-        // structure to convert int32 to architecture / endian independent 4-char array
-        union {
-            int32_t i;
-            uint8_t c[4];
-        } t2;
+    // part 1: address line, in the frame given by the lowest 3 address bits
+    enc->addressline = (address & 0x7) << 1;
+    addressline = address >> 3;
 
-        // batch 1
-        t1 = pocsag->Pocsagmsg.batch1[l];
+    // add address source
+    addressline <<= 2;
+    addressline += source;
+    enc->addresscw = createcrc(addressline << 11);
 
-        // left most octet
-        t2.c[0] = (t1 >> 24) & 0xff; t2.c[1] = (t1 >> 16) & 0xff;
-        t2.c[2] = (t1 >> 8) & 0xff; t2.c[3] = t1 & 0xff;
+    // part 2: text lines follow the address line, 20 bits each. A text that
+    // ends exactly at the end of a line still gets one more, empty line.
+    // Digits take 4 bits, 5 to a line, and need no EOT.
+    if (numeric) {
+        codewords = (enc->txtlen + 4) / 5;
+    } else {
+        codewords = 7 * enc->txtlen / 20 + 1;
+    }
+    enc->lastline = enc->addressline + codewords;
 
-        // copy back
-        pocsag->Pocsagmsg.batch1[l] = t2.i;
+    // a message that fits in batch 1, batch2 option:
+    // 0: truncate to one batch
+    // 1: copy batch1 to batch2
+    // 2: leave batch2 as "idle"
+    enc->batches = (enc->lastline >= 16 || option_batch2 != 0) ? 2 : 1;
+    enc->batch2copy = (enc->lastline < 16 && option_batch2 == 1);
 
-        // batch 2
-        t1 = pocsag->Pocsagmsg.batch2[l];
+    enc->invert = option_invert ? 0xffffffff : 0;
+    enc->preamble = POCSAG_MSG_PREAMBLE / 4;
+    return POCSAG_SUCCESS;
+}
 
-        // left most octet
-        t2.c[0] = (t1 >> 24) & 0xff; t2.c[1] = (t1 >> 16) & 0xff;
-        t2.c[2] = (t1 >> 8) & 0xff; t2.c[3] = t1 & 0xff;
 
-        // copy back
-        pocsag->Pocsagmsg.batch2[l] = t2.i;
+// Text line: leftmost bit "1", then 20 bits of text, the 7 bits of each char
+// least significant first. Past the EOT the line is padded with 0.
+static uint32_t messageline(const Pocsag_Encoder_t* enc, int index) {
+    if (enc->numeric) {
+        return numericline(enc, index);
     }
 
-    // done
-    // return
-
-    // reset last char in input char (was overwritten at the beginning of the function)
-    text[txtlen] = lastchar;
-
-    // If only one single batch used
-    if (currentframe < 16) {
-        // batch2 option:
-        // 0: truncate to one batch
-        // 1: copy batch1 to batch2
-        // 2: leave batch2 as "idle"
-
-        if (option_batch2 == 0) {
-            // done. set length to one single batch (140 octets)
-            pocsag->size = 140;
-            return POCSAG_SUCCESS;
-        } else if (option_batch2 == 1) {
-            memcpy(pocsag->Pocsagmsg.batch2, pocsag->Pocsagmsg.batch1, 64); // 16 codewords of 32 bits
-        }
+    int bitpos = index * 20;
+    int first = bitpos / 7;
+    uint32_t bits = 0;
+
+    // 20 bits span at most 4 chars, collected with the first bit at bit 27
+    for (int l = first; l < first + 4; l++) {
+        uint8_t c = 0x00;
 
-        // return for (option_batch2 == 1) or (option_batch2 == 2)
-        // set length to 2 batches (208 octets)
-        pocsag->size = 208;
-        return POCSAG_SUCCESS;
+        if (l < enc->txtlen - 1) {
+            c = enc->text[l];
+        } else if (l == enc->txtlen - 1) {
+            c = 0x04; // EOT (end of transmission)
+        }
+        bits = (bits << 7) | flip7charbitorder(c);
     }
+    bits = (bits >> (8 - bitpos % 7)) & 0xfffff;
 
-    // more than one batch found
-    // length = 2 batches (208 octets)
-    pocsag->size = 208;
-    return POCSAG_SUCCESS;
+    return createcrc(0x80000000 | (bits << 11));
 }
 
-// Private functions
-static void replaceline(Pocsag_t* pocsag, int line, uint32_t val) {
-    if (pocsag == NULL) return;
+// Numeric line: leftmost bit "1", then 5 digits of 4 bits, each least
+// significant bit first. The last line is padded with spaces.
+static uint32_t numericline(const Pocsag_Encoder_t* enc, int index) {
+    uint32_t bits = 0;
 
-    // sanity checks
-    if ((line < 0) || (line > 32)) {
-        return;
+    for (int l = index * 5; l < index * 5 + 5; l++) {
+        int d = (l < enc->txtlen) ? numericcode(enc->text[l]) : 0x0c;
+
+        bits = (bits << 4) | ((d & 0x1) << 3) | ((d & 0x2) << 1) | ((d & 0x4) >> 1) | ((d & 0x8) >> 3);
     }
 
-    if (line < 16) {
-        pocsag->Pocsagmsg.batch1[line] = val;
-    } else {
-        pocsag->Pocsagmsg.batch2[line-16] = val;
+    return createcrc(0x80000000 | (bits << 11));
+}
+
+// Code of a numeric character, -1 if numeric pagers cannot show it
+static int numericcode(char c) {
+    for (int l = 0; l < 16; l++) {
+        if (numericchars[l] == c) {
+            return l;
+        }
     }
+    return -1;
 }
 
 static uint8_t flip7charbitorder(uint8_t c_in) {
@@ -0,0 +1,169 @@
+/*
+ * pocsag_bench.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#ifdef POCSAG_BENCH
+
+#include "pocsag_bench.h"
+#include "Pocsag.h"
+#include <string.h>
+
+// POCSAG_BENCH_NATIVE: built without the HAL, the platform supplies the timer
+#ifndef POCSAG_BENCH_NATIVE
+#include "main.h"
+#endif
+
+// Stack below the caller painted before each page to find the high-water mark
+#define BENCH_STACK_PAINT   1024
+#define BENCH_STACK_PATTERN 0xA5
+
+const PocsagBench_Mix_t PocsagBench_Mixes[] = {
+    // name      min  max  batch2 invert sweep
+    { "sweep",     0,  40,   -1,    -1,  true  },
+    { "short",     0,  10,    0,     1,  false },   // alerts and call-back numbers
+    { "typical",   0,  40,    0,     1,  false },   // as sent by the P command
+    { "long",     30,  40,    0,     1,  false },
+    { "random",    0,  40,   -1,    -1,  false },
+};
+const int PocsagBench_MixCount = sizeof(PocsagBench_Mixes) / sizeof(PocsagBench_Mixes[0]);
+
+static Pocsag_t benchPocsag;
+static uint32_t rngState;
+
+// Private function prototypes
+static uint32_t bench_rng(void);
+static uint8_t* bench_stackBase(void);
+static void bench_paintStack(uint8_t *base);
+static uint32_t bench_stackUsed(uint8_t *base);
+
+// Encode "pages" pages of the mix and collect timing
+void PocsagBench_Run(const PocsagBench_Mix_t *mix, uint32_t pages, uint32_t seed, PocsagBench_Result_t *result) {
+    uint8_t *base = bench_stackBase();
+    uint32_t overhead = UINT32_MAX;
+    char text[POCSAG_BENCH_MAXLEN + 8];
+
+    memset(result, 0, sizeof(PocsagBench_Result_t));
+    result->minTicks = UINT32_MAX;
+    rngState = seed ? seed : 1;
+    Pocsag_Init(&benchPocsag);
+
+    // one page up front so caches (and a host's lazy symbol binding) are warm
+    strcpy(text, "warm-up");
+    Pocsag_CreatePocsag(&benchPocsag, 8, 0, text, 0, 0);
+
+    // cost of reading the timer twice, removed from every sample
+    for (int i = 0; i < 16; i++) {
+        uint32_t t0 = PocsagBench_GetTicks();
+        uint32_t t1 = PocsagBench_GetTicks();
+        if (t1 - t0 < overhead) {
+            overhead = t1 - t0;
+        }
+    }
+
+    for (uint32_t n = 0; n < pages; n++) {
+        int len, frame, batch2, invert;
+
+        if (mix->sweep) {
+            uint32_t i = n % POCSAG_BENCH_SWEEP;
+            len = i % (POCSAG_BENCH_MAXLEN + 1);
+            i /= POCSAG_BENCH_MAXLEN + 1;
+            frame = i % 8;
+            i /= 8;
+            invert = i % 2;
+            batch2 = i / 2;
+        } else {
+            len = mix->minLen + bench_rng() % (mix->maxLen - mix->minLen + 1);
+            frame = bench_rng() % 8;
+            invert = mix->invert >= 0 ? mix->invert : (int)(bench_rng() % 2);
+            batch2 = mix->batch2 >= 0 ? mix->batch2 : (int)(bench_rng() % 3);
+        }
+
+        long address = ((long)(bench_rng() % 0x3FFFF) << 3) | frame;
+        if (address == 0) {
+            address = 8;
+        }
+        for (int i = 0; i < len; i++) {
+            text[i] = (char)(0x20 + bench_rng() % 95);
+        }
+        text[len] = '\0';
+
+        int source = bench_rng() % 4;
+
+        // interrupts would show up in both the timing and the painted stack
+#ifndef POCSAG_BENCH_NATIVE
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+#endif
+        // stack first, in a separate call: reading the timer may use stack itself
+        bench_paintStack(base);
+        Pocsag_CreatePocsag(&benchPocsag, address, source, text, batch2, invert);
+        uint32_t stack = bench_stackUsed(base);
+
+        uint32_t t0 = PocsagBench_GetTicks();
+        Pocsag_CreatePocsag(&benchPocsag, address, source, text, batch2, invert);
+        uint32_t t1 = PocsagBench_GetTicks();
+#ifndef POCSAG_BENCH_NATIVE
+        __set_PRIMASK(primask);
+#endif
+
+        uint32_t ticks = t1 - t0;
+        ticks = ticks > overhead ? ticks - overhead : 0;
+
+        result->pages++;
+        result->codewords += Pocsag_GetSize(&benchPocsag) > POCSAG_MSG_SIZE_1BATCH ? 32 : 16;
+        result->ticks += ticks;
+        if (ticks < result->minTicks) result->minTicks = ticks;
+        if (ticks > result->maxTicks) result->maxTicks = ticks;
+        if (stack > result->stackBytes) result->stackBytes = stack;
+        result->lenTicks[len] += ticks;
+        result->lenPages[len]++;
+    }
+}
+
+#ifndef POCSAG_BENCH_NATIVE
+// DWT cycle counter, enabled by Perf_Init()
+uint32_t PocsagBench_GetTicks(void) {
+    return DWT->CYCCNT;
+}
+
+uint32_t PocsagBench_GetTickRate(void) {
+    return SystemCoreClock;
+}
+#endif
+
+// Private functions
+static uint32_t bench_rng(void) {
+    // xorshift32
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+// Frame of a function called from PocsagBench_Run, where the encoder's frame starts
+__attribute__((noinline)) static uint8_t* bench_stackBase(void) {
+    return (uint8_t*)__builtin_frame_address(0);
+}
+
+// Paint the stack below base, leaving room for this function's own frame
+__attribute__((noinline)) static void bench_paintStack(uint8_t *base) {
+    volatile uint8_t *p = base - 64 - BENCH_STACK_PAINT;
+
+    while (p < base - 64) {
+        *p++ = BENCH_STACK_PATTERN;
+    }
+}
+
+// Stack used below base: distance to the deepest byte no longer painted
+__attribute__((noinline)) static uint32_t bench_stackUsed(uint8_t *base) {
+    volatile uint8_t *p = base - 64 - BENCH_STACK_PAINT;
+
+    while (p < base - 64 && *p == BENCH_STACK_PATTERN) {
+        p++;
+    }
+    return (uint32_t)(base - (uint8_t*)p);
+}
+
+#endif // POCSAG_BENCH
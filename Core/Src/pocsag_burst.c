@@ -0,0 +1,93 @@
+/*
+ * pocsag_burst.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "pocsag_burst.h"
+#include <string.h>
+
+#define POCSAG_SYNC 0x7CD215D8
+#define POCSAG_IDLE 0x7A89C197
+
+// Private function prototypes
+static void putword(PocsagBurst_t* burst, int offset, uint32_t cw);
+
+// Start an empty burst, invert as in Pocsag_CreatePocsag
+void PocsagBurst_Init(PocsagBurst_t* burst, bool invert) {
+    if (burst == NULL) return;
+
+#if POCSAG_BURST_PREAMBLE > 0
+    memset(burst->data, invert ? 0x55 : 0xAA, POCSAG_BURST_PREAMBLE);
+#endif
+    burst->batches = 0;
+    burst->used = 0;
+    burst->messages = 0;
+    burst->invert = invert;
+}
+
+// Append a message: the address codeword followed by count - 1 message
+// codewords, all with BCH and parity. Returns false, leaving the burst as it
+// was, when the message does not fit.
+bool PocsagBurst_Add(PocsagBurst_t* burst, long address, const uint32_t* codewords, int count) {
+    int slot, needed;
+
+    if (burst == NULL || codewords == NULL || count < 1) {
+        return false;
+    }
+
+    // address codeword goes into its frame, in the next batch if that frame has passed
+    slot = (burst->used / 16) * 16 + (int)(address & 0x7) * 2;
+    if (slot < burst->used) {
+        slot += 16;
+    }
+
+    needed = (slot + count + 15) / 16;
+    if (needed > POCSAG_BURST_MAX_BATCHES) {
+        return false;
+    }
+
+    // open new batches filled with idle codewords
+    while (burst->batches < needed) {
+        int offset = POCSAG_BURST_PREAMBLE + burst->batches * POCSAG_BURST_BATCHSIZE;
+
+        putword(burst, offset, POCSAG_SYNC);
+        for (int l = 0; l < 16; l++) {
+            putword(burst, offset + 4 + l * 4, POCSAG_IDLE);
+        }
+        burst->batches++;
+    }
+
+    for (int l = 0; l < count; l++) {
+        int s = slot + l;
+        putword(burst, POCSAG_BURST_PREAMBLE + (s / 16) * POCSAG_BURST_BATCHSIZE + 4 + (s % 16) * 4, codewords[l]);
+    }
+    burst->used = slot + count;
+    burst->messages++;
+
+    return true;
+}
+
+// Get Size
+int PocsagBurst_GetSize(PocsagBurst_t* burst) {
+    if (burst == NULL || burst->batches == 0) return 0;
+    return POCSAG_BURST_PREAMBLE + burst->batches * POCSAG_BURST_BATCHSIZE;
+}
+
+// Get Data
+uint8_t* PocsagBurst_GetData(PocsagBurst_t* burst) {
+    if (burst == NULL) return NULL;
+    return burst->data;
+}
+
+// Private functions
+// Store a codeword most significant octet first
+static void putword(PocsagBurst_t* burst, int offset, uint32_t cw) {
+    if (burst->invert) {
+        cw ^= 0xFFFFFFFF;
+    }
+    burst->data[offset] = (cw >> 24) & 0xFF;
+    burst->data[offset + 1] = (cw >> 16) & 0xFF;
+    burst->data[offset + 2] = (cw >> 8) & 0xFF;
+    burst->data[offset + 3] = cw & 0xFF;
+}
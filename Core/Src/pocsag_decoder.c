@@ -0,0 +1,364 @@
+/*
+ * pocsag_decoder.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "pocsag_decoder.h"
+#include <string.h>
+
+#define POCSAG_SYNC 0x7CD215D8
+#define POCSAG_IDLE 0x7A89C197
+
+// BCH(31,21) generator polynomial x^10+x^9+x^8+x^6+x^5+x^3+1
+#define BCH_POLY 0x769
+
+// Receiver states
+#define STATE_SEARCH    0   // looking for the sync codeword
+#define STATE_BATCH     1   // receiving the 16 codewords of a batch
+#define STATE_NEXTSYNC  2   // expecting the sync codeword of the next batch
+
+// Syndrome to error pattern: bits 0-4 first position, 5-9 second position,
+// 10-11 number of errors (0 = not correctable)
+static uint16_t bchTable[1024];
+static bool bchTableReady = false;
+
+static const char numericChars[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '*', 'U', ' ', '-', ')', '('
+};
+
+// Private function prototypes
+static uint16_t bchsyndrome(uint32_t cw);
+static void buildbchtable(void);
+static int countbits(uint32_t x);
+static int parity(uint32_t x);
+static uint8_t flipbitorder(uint8_t c_in, int bits);
+static void processcodeword(PocsagDecoder_t* dec, uint32_t cw);
+static void finishmessage(PocsagDecoder_t* dec);
+
+// Initialize decoder, onMessage is called for every complete message
+void PocsagDecoder_Init(PocsagDecoder_t* dec, void (*onMessage)(void *ctx, const PocsagDecoder_Message_t *msg), void *ctx) {
+    if (dec == NULL) return;
+
+    if (!bchTableReady) {
+        buildbchtable();
+    }
+
+    memset(dec, 0, sizeof(PocsagDecoder_t));
+    dec->state = STATE_SEARCH;
+    dec->onMessage = onMessage;
+    dec->ctx = ctx;
+}
+
+// Feed one received bit
+void PocsagDecoder_PushBit(PocsagDecoder_t* dec, int bit) {
+    uint32_t cw;
+
+    dec->stats.bits++;
+    dec->shift = (dec->shift << 1) | (bit & 1);
+
+    switch (dec->state) {
+    case STATE_SEARCH:
+        if (countbits(dec->shift ^ POCSAG_SYNC) <= POCSAG_DECODER_SYNC_ERRORS) {
+            dec->inverted = false;
+        } else if (countbits(~dec->shift ^ POCSAG_SYNC) <= POCSAG_DECODER_SYNC_ERRORS) {
+            dec->inverted = true;
+        } else {
+            break;
+        }
+        dec->stats.syncs++;
+        dec->state = STATE_BATCH;
+        dec->bitCount = 0;
+        dec->cwIndex = 0;
+        break;
+
+    case STATE_BATCH:
+        if (++dec->bitCount < 32) break;
+        dec->bitCount = 0;
+
+        processcodeword(dec, dec->inverted ? ~dec->shift : dec->shift);
+        if (++dec->cwIndex == 16) {
+            dec->state = STATE_NEXTSYNC;
+        }
+        break;
+
+    case STATE_NEXTSYNC:
+        if (++dec->bitCount < 32) break;
+        dec->bitCount = 0;
+
+        cw = dec->inverted ? ~dec->shift : dec->shift;
+        if (countbits(cw ^ POCSAG_SYNC) <= POCSAG_DECODER_SYNC_ERRORS) {
+            // transmission continues with another batch
+            dec->stats.syncs++;
+            dec->state = STATE_BATCH;
+            dec->cwIndex = 0;
+        } else {
+            finishmessage(dec);
+            dec->state = STATE_SEARCH;
+        }
+        break;
+    }
+}
+
+// Feed bytes as sent by the radio, most significant bit first
+void PocsagDecoder_PushBytes(PocsagDecoder_t* dec, const uint8_t *data, int len) {
+    if (dec == NULL || data == NULL) return;
+
+    for (int i = 0; i < len; i++) {
+        uint8_t c = data[i];
+        for (int b = 7; b >= 0; b--) {
+            PocsagDecoder_PushBit(dec, (c >> b) & 1);
+        }
+    }
+}
+
+// End of transmission: deliver a pending message and restart sync search
+void PocsagDecoder_Flush(PocsagDecoder_t* dec) {
+    if (dec == NULL) return;
+
+    finishmessage(dec);
+    dec->state = STATE_SEARCH;
+    dec->shift = 0;
+}
+
+// The radio matched a sync codeword in hardware and stripped it from the data,
+// the next bit starts a batch
+void PocsagDecoder_Sync(PocsagDecoder_t* dec, bool inverted) {
+    if (dec == NULL) return;
+
+    // a partial batch cannot be continued, the sync is not where it was expected
+    if (dec->state == STATE_BATCH || dec->inverted != inverted) {
+        finishmessage(dec);
+    }
+
+    dec->stats.syncs++;
+    dec->inverted = inverted;
+    dec->state = STATE_BATCH;
+    dec->bitCount = 0;
+    dec->cwIndex = 0;
+}
+
+// Correct up to 2 bit errors in a codeword (BCH + even parity).
+// Returns the number of corrected bits, or -1 when not correctable.
+int PocsagDecoder_CorrectCodeword(uint32_t *cw) {
+    int errors = 0;
+
+    if (!bchTableReady) {
+        buildbchtable();
+    }
+
+    uint16_t syndrome = bchsyndrome(*cw);
+    if (syndrome != 0) {
+        uint16_t fix = bchTable[syndrome];
+
+        errors = fix >> 10;
+        if (errors == 0) {
+            return -1;
+        }
+        *cw ^= 1UL << (fix & 0x1F);
+        if (errors == 2) {
+            *cw ^= 1UL << ((fix >> 5) & 0x1F);
+        }
+    }
+
+    // remaining parity error is in the parity bit itself
+    if (parity(*cw)) {
+        if (errors == 2) {
+            return -1;
+        }
+        *cw ^= 1;
+        errors++;
+    }
+
+    return errors;
+}
+
+// Get Stats
+const PocsagDecoder_Stats_t* PocsagDecoder_GetStats(PocsagDecoder_t* dec) {
+    if (dec == NULL) return NULL;
+    return &dec->stats;
+}
+
+// The interpretation that fits the page: digits for a numeric page, text otherwise
+const char* PocsagDecoder_GetText(const PocsagDecoder_Message_t* msg) {
+    if (msg == NULL) return "";
+    return msg->isNumeric ? msg->numeric : msg->text;
+}
+
+// Private functions
+static void processcodeword(PocsagDecoder_t* dec, uint32_t cw) {
+    int errors;
+
+    dec->stats.codewords++;
+
+    errors = PocsagDecoder_CorrectCodeword(&cw);
+    if (errors < 0) {
+        dec->stats.uncorrectable++;
+        if (dec->inMessage) {
+            dec->msg.uncorrectable++;
+        }
+        return;
+    }
+    dec->stats.corrected += errors;
+
+    // idle codeword ends a message
+    if (cw == POCSAG_IDLE) {
+        finishmessage(dec);
+        return;
+    }
+
+    // address codeword: 18 address bits, the lower 3 bits are the frame number
+    if ((cw & 0x80000000) == 0) {
+        finishmessage(dec);
+
+        memset(&dec->msg, 0, sizeof(PocsagDecoder_Message_t));
+        dec->msg.address = (long)(((cw >> 13) & 0x3FFFF) << 3) | (dec->cwIndex >> 1);
+        dec->msg.function = (cw >> 11) & 0x3;
+        dec->msg.inverted = dec->inverted;
+        dec->msg.corrected = errors;
+        dec->msg.raw[0] = cw;
+        dec->msg.rawCount = 1;
+        dec->inMessage = true;
+        dec->alphaBits = 0;
+        dec->alphaCount = 0;
+        dec->alphaDone = false;
+        dec->alphaEnded = false;
+        dec->alphaPrintable = true;
+        dec->textLen = 0;
+        dec->numericLen = 0;
+        return;
+    }
+
+    // message codeword without an address: nothing to attach it to
+    if (!dec->inMessage) {
+        return;
+    }
+
+    dec->msg.codewords++;
+    dec->msg.corrected += errors;
+    if (dec->msg.rawCount < POCSAG_DECODER_MAXCW) {
+        dec->msg.raw[dec->msg.rawCount++] = cw;
+    }
+
+    // 20 data bits, first transmitted bit in bit 19
+    uint32_t data = (cw >> 11) & 0xFFFFF;
+
+    // numeric: 5 digits of 4 bits, each sent least significant bit first
+    for (int d = 0; d < 5; d++) {
+        uint8_t nibble = flipbitorder((data >> (16 - 4 * d)) & 0xF, 4);
+        if (dec->numericLen < POCSAG_DECODER_MAXTEXT) {
+            dec->msg.numeric[dec->numericLen++] = numericChars[nibble];
+        }
+    }
+
+    // alphanumeric: 7 bit characters, least significant bit first, may span codewords
+    for (int b = 19; b >= 0; b--) {
+        dec->alphaBits = (dec->alphaBits << 1) | ((data >> b) & 1);
+        if (++dec->alphaCount < 7) continue;
+
+        char c = (char)flipbitorder(dec->alphaBits, 7);
+        dec->alphaBits = 0;
+        dec->alphaCount = 0;
+
+        // after the end of the text only padding may follow
+        if (dec->alphaDone) {
+            if (c != 0x00 && c != 0x04) {
+                dec->alphaEnded = false;
+            }
+            continue;
+        }
+        if (c == 0x04 || c == 0x03 || c == 0x00) {
+            // EOT, ETX (or zero padding) terminates the text
+            dec->alphaDone = true;
+            dec->alphaEnded = (c != 0x00);
+        } else if (dec->textLen < POCSAG_DECODER_MAXTEXT) {
+            if ((c < 0x20 && c != '\r' && c != '\n') || c == 0x7F) {
+                dec->alphaPrintable = false;
+            }
+            dec->msg.text[dec->textLen++] = c;
+        }
+    }
+}
+
+static void finishmessage(PocsagDecoder_t* dec) {
+    if (!dec->inMessage) return;
+
+    dec->msg.text[dec->textLen] = '\0';
+
+    // numeric messages are padded with spaces
+    while (dec->numericLen > 0 && dec->msg.numeric[dec->numericLen - 1] == ' ') {
+        dec->numericLen--;
+    }
+    dec->msg.numeric[dec->numericLen] = '\0';
+
+    // Alphanumeric pages end their text with EOT (ETX on some systems) and
+    // pad the rest with zero bits, down to the bits short of a whole
+    // character. The text reading of numeric data rarely does and usually
+    // holds control characters. The function bits are no help, pagers are
+    // set up with any function for either type.
+    if (dec->alphaBits != 0) {
+        dec->alphaEnded = false;
+    }
+    dec->msg.isNumeric = dec->msg.codewords > 0 && !(dec->alphaPrintable && dec->alphaEnded);
+
+    dec->inMessage = false;
+    dec->stats.messages++;
+    if (dec->onMessage) {
+        dec->onMessage(dec->ctx, &dec->msg);
+    }
+}
+
+// Remainder of the 31 BCH bits (parity bit excluded) divided by the generator
+static uint16_t bchsyndrome(uint32_t cw) {
+    uint32_t r = cw & 0xFFFFFFFE;
+
+    for (int bit = 31; bit >= 11; bit--) {
+        if (r & (1UL << bit)) {
+            r ^= (uint32_t)BCH_POLY << (bit - 10);
+        }
+    }
+
+    return (r >> 1) & 0x3FF;
+}
+
+// Every single and double bit error in bits 1..31 has its own syndrome
+static void buildbchtable(void) {
+    memset(bchTable, 0, sizeof(bchTable));
+
+    for (int i = 1; i < 32; i++) {
+        uint16_t s1 = bchsyndrome(1UL << i);
+        bchTable[s1] = (1 << 10) | i;
+
+        for (int j = i + 1; j < 32; j++) {
+            uint16_t s2 = bchsyndrome((1UL << i) | (1UL << j));
+            bchTable[s2] = (2 << 10) | (j << 5) | i;
+        }
+    }
+
+    bchTableReady = true;
+}
+
+static int countbits(uint32_t x) {
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    x = (x + (x >> 4)) & 0x0F0F0F0F;
+    return (int)((x * 0x01010101) >> 24);
+}
+
+static int parity(uint32_t x) {
+    x ^= x >> 16;
+    x ^= x >> 8;
+    x ^= x >> 4;
+    return (0x6996 >> (x & 0xF)) & 1;
+}
+
+static uint8_t flipbitorder(uint8_t c_in, int bits) {
+    uint8_t c_out = 0;
+
+    for (int l = 0; l < bits; l++) {
+        c_out = (c_out << 1) | (c_in & 0x01);
+        c_in >>= 1;
+    }
+
+    return c_out;
+}
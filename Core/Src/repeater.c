@@ -0,0 +1,210 @@
+/*
+ * repeater.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "repeater.h"
+#include "main.h"
+#include <string.h>
+
+// A stored message, kept as the corrected codewords so numeric, alphanumeric
+// and tone-only pages are repeated exactly as received
+typedef struct {
+    long address;
+    int count;
+    uint32_t codewords[POCSAG_DECODER_MAXCW];
+} Repeater_Message_t;
+
+typedef struct {
+    long address;
+    uint32_t hash;
+    uint32_t tick;
+} Repeater_Seen_t;
+
+static bool enabled = false;
+static Repeater_Range_t ranges[REPEATER_MAX_RANGES];
+static int rangeCount = 0;
+
+// FIFO of messages to repeat
+static Repeater_Message_t store[REPEATER_STORE_LEN];
+static int head = 0;
+static int count = 0;
+static uint32_t lastActivity = 0;
+
+// Recently stored messages
+static Repeater_Seen_t seen[REPEATER_DEDUP_LEN];
+static int seenNext = 0;
+
+static Repeater_Stats_t stats;
+
+// Private function prototypes
+static bool repeater_inRange(long address);
+static uint32_t repeater_hash(const uint32_t* codewords, int n);
+static bool repeater_seen(long address, uint32_t hash, uint32_t now);
+
+void Repeater_Init(void) {
+    enabled = false;
+    rangeCount = 0;
+    head = 0;
+    count = 0;
+    seenNext = 0;
+    memset(seen, 0, sizeof(seen));
+    memset(&stats, 0, sizeof(stats));
+}
+
+void Repeater_SetEnabled(bool on) {
+    enabled = on;
+}
+
+bool Repeater_IsEnabled(void) {
+    return enabled;
+}
+
+// Add an inclusive RIC range, fails when invalid or all slots are used
+bool Repeater_AddRange(long first, long last) {
+    if (first < 1 || last > 0x1FFFFF || first > last || rangeCount >= REPEATER_MAX_RANGES) {
+        return false;
+    }
+    ranges[rangeCount].first = first;
+    ranges[rangeCount].last = last;
+    rangeCount++;
+    return true;
+}
+
+void Repeater_ClearRanges(void) {
+    rangeCount = 0;
+}
+
+int Repeater_GetRangeCount(void) {
+    return rangeCount;
+}
+
+const Repeater_Range_t* Repeater_GetRange(int index) {
+    if (index < 0 || index >= rangeCount) return NULL;
+    return &ranges[index];
+}
+
+// Hand over a decoded message, returns true when it was stored for repeating
+bool Repeater_Offer(const PocsagDecoder_Message_t* msg) {
+    uint32_t now = HAL_GetTick();
+    uint32_t hash;
+
+    // every message keeps the gather time running, the channel is still busy
+    lastActivity = now;
+
+    if (!enabled || msg == NULL) {
+        return false;
+    }
+    stats.received++;
+
+    if (!repeater_inRange(msg->address)) {
+        stats.filtered++;
+        return false;
+    }
+    // a missing codeword would shift everything after it
+    if (msg->uncorrectable > 0 || msg->rawCount != msg->codewords + 1) {
+        stats.damaged++;
+        return false;
+    }
+
+    hash = repeater_hash(msg->raw, msg->rawCount);
+    if (repeater_seen(msg->address, hash, now)) {
+        stats.duplicates++;
+        return false;
+    }
+    if (count >= REPEATER_STORE_LEN) {
+        stats.dropped++;
+        return false;
+    }
+
+    Repeater_Message_t* m = &store[(head + count) % REPEATER_STORE_LEN];
+    m->address = msg->address;
+    m->count = msg->rawCount;
+    memcpy(m->codewords, msg->raw, msg->rawCount * sizeof(uint32_t));
+    count++;
+
+    seen[seenNext].address = msg->address;
+    seen[seenNext].hash = hash;
+    seen[seenNext].tick = now;
+    seenNext = (seenNext + 1) % REPEATER_DEDUP_LEN;
+
+    return true;
+}
+
+// The input carries POCSAG batches, keep gathering
+void Repeater_ChannelActive(void) {
+    lastActivity = HAL_GetTick();
+}
+
+int Repeater_Pending(void) {
+    return count;
+}
+
+// Messages are waiting and the input has been quiet for the gather time
+bool Repeater_IsReady(void) {
+    return count > 0 && HAL_GetTick() - lastActivity >= REPEATER_GATHER_MS;
+}
+
+// Move as many stored messages into burst as fit, in the order received.
+// Returns the number of messages added.
+int Repeater_BuildBurst(PocsagBurst_t* burst) {
+    int added = 0;
+
+    while (count > 0) {
+        Repeater_Message_t* m = &store[head];
+
+        if (!PocsagBurst_Add(burst, m->address, m->codewords, m->count)) {
+            break;
+        }
+        head = (head + 1) % REPEATER_STORE_LEN;
+        count--;
+        added++;
+    }
+
+    if (added > 0) {
+        stats.forwarded += added;
+        stats.bursts++;
+    }
+    return added;
+}
+
+const Repeater_Stats_t* Repeater_GetStats(void) {
+    return &stats;
+}
+
+// Private functions
+static bool repeater_inRange(long address) {
+    if (rangeCount == 0) {
+        return true;
+    }
+    for (int i = 0; i < rangeCount; i++) {
+        if (address >= ranges[i].first && address <= ranges[i].last) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// FNV-1a over the codewords
+static uint32_t repeater_hash(const uint32_t* codewords, int n) {
+    uint32_t hash = 2166136261UL;
+
+    for (int i = 0; i < n; i++) {
+        for (int b = 0; b < 32; b += 8) {
+            hash ^= (codewords[i] >> b) & 0xFF;
+            hash *= 16777619UL;
+        }
+    }
+    return hash;
+}
+
+static bool repeater_seen(long address, uint32_t hash, uint32_t now) {
+    for (int i = 0; i < REPEATER_DEDUP_LEN; i++) {
+        if (seen[i].hash == hash && seen[i].address == address && seen[i].tick != 0 &&
+            now - seen[i].tick < REPEATER_DEDUP_MS) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,252 +1,1084 @@
 #include "si4463_driver.h"
 #include "radio_config_Si4463.h"
+#include "si4463_trace.h"
+#include "direct_tx.h"
+#include "uart_tx.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
 
-// STM32 HAL handles
-static SPI_HandleTypeDef *hspi_si4463 = NULL;
-static GPIO_TypeDef* SDN_PORT = NULL;
-static uint16_t SDN_PIN = 0;
-static GPIO_TypeDef* NIRQ_PORT = NULL;
-static uint16_t NIRQ_PIN = 0;
-static GPIO_TypeDef* CS_PORT = NULL;
-static uint16_t CS_PIN = 0;
-
 // Buffer for debug messages
 #define DEBUG_BUFLEN 128
 static char debugBuff[DEBUG_BUFLEN];
 
+// TX FIFO size and refill threshold (TX_FIFO_ALMOST_EMPTY fires below this)
+#define SI4463_FIFO_SIZE 64
+#define SI4463_TX_THRESHOLD 32
+
+// RX FIFO almost-full threshold (RX_FIFO_ALMOST_FULL fires at this fill level)
+#define SI4463_RX_THRESHOLD 32
+
+// The radio matches the first sync word in hardware and then streams whatever
+// follows for RX_LEN bytes (the 13 bit maximum), the caller finds the end of
+// the transmission and any later sync words in the data itself
+#define SI4463_RX_STREAM_LEN 0x1FFF
+
+// Sync word bit errors accepted by the radio
+#define SI4463_RX_SYNC_ERRORS 2
+
+// RSSI settling time after entering RX (averaged over a few bits at 1200 bps)
+#define SI4463_RSSI_SETTLE_MS 4
+
+// RSSI register to dBm: value / 2 - MODEM_RSSI_COMP (default 0x40) - 70
+#define SI4463_RSSI_OFFSET_DB 134
+
+// Maximum time to wait for CTS after a command
+#define SI4463_CTS_TIMEOUT_MS 100
+
+// SDN must be held high for at least 10 us to reset the chip
+#define SI4463_SDN_PULSE_US 10
+
+// The power-on reset takes about 6 ms after SDN is released
+#define SI4463_POR_TIMEOUT_MS 20
+
+// Reference crystal frequency
+#define SI4463_XO_HZ 30000000.0
+
+// MODEM_MAP_CONTROL: invert the TX data bits ahead of the modulator
+#define SI4463_MAP_ENINV_TXBIT 0x20
+
+// MODEM_MOD_TYPE: FSK from the packet handler, or 2FSK following the level
+// of GPIO0 in asynchronous direct mode (TX_DIRECT_MODE_TYPE async,
+// TX_DIRECT_MODE_GPIO 0, MOD_SOURCE direct)
+#define SI4463_MOD_TYPE_PACKET 0x03
+#define SI4463_MOD_TYPE_DIRECT 0x8A
+
+// GPIO_PIN_CFG mode of GPIO0 in direct mode
+#define SI4463_GPIO_INPUT 0x04
+
+// Direct TX gives up when the bit clock lags the system tick by this much
+#define SI4463_DIRECT_TIMEOUT_MS 200
+
+// Continuous transmission: TX_LEN is set to its 13 bit maximum and the
+// packet is cut with CHANGE_STATE once the data has left the FIFO. A tail of
+// alternating bits (read as preamble by a pager) behind the data gives the
+// service call that does it SI4463_STREAM_TAIL_MS of slack before the FIFO
+// would underflow.
+#define SI4463_TX_LEN_MAX        0x1FFF
+#define SI4463_STREAM_TAIL_MS    30
+#define SI4463_STREAM_TAIL_MAX   16
+#define SI4463_STREAM_TAIL_BYTE  0x55
+
+// SET_PROPERTY carries at most 12 values
+#define SI4463_PROP_MAX 12
+
+// Unchanged bytes between two changed ones are resent up to this gap,
+// a further SET_PROPERTY costs its 4 byte header and a CTS poll
+#define SI4463_PROP_MERGE_GAP 4
+
 // Debug print functions for SI4463 driver
 static void si4463_print(const char* message) {
-    // You might want to use a different UART for debug messages
-    // For now, using huart1 - adjust if needed
-    extern UART_HandleTypeDef huart1;
-    HAL_UART_Transmit(&huart1, (uint8_t*)message, strlen(message), HAL_MAX_DELAY);
+    UartTx_Write((const uint8_t*)message, strlen(message));
 }
 
+// Private function prototypes
+static bool si4463_pollCts(Si4463_t *radio, uint8_t *resp, uint8_t respLen, uint32_t timeoutMs, uint16_t *polls);
+static void si4463_delayUs(uint32_t us);
+static void si4463_stopDirectTx(Si4463_t *radio);
+static uint16_t si4463_directRefill(void *ctx, const uint8_t **data);
+static bool si4463_nextChunk(Si4463_t *radio);
+static void si4463_endStream(Si4463_t *radio);
+
+// Tail of a continuous transmission
+static uint8_t si4463_tail[SI4463_STREAM_TAIL_MAX];
+
 static void si4463_printf(const char* format, ...) {
-    extern UART_HandleTypeDef huart1;
     va_list args;
     va_start(args, format);
     int len = vsnprintf(debugBuff, DEBUG_BUFLEN, format, args);
     va_end(args);
 
     if (len > 0 && len < DEBUG_BUFLEN) {
-        HAL_UART_Transmit(&huart1, (uint8_t*)debugBuff, len, HAL_MAX_DELAY);
+        UartTx_Write((const uint8_t*)debugBuff, len);
     }
 }
 
 // Initialize SI4463 for STM32
-void Si4463_Init(SPI_HandleTypeDef *hspi, GPIO_TypeDef* sdn_port, uint16_t sdn_pin,
+bool Si4463_Init(Si4463_t *radio, SPI_HandleTypeDef *hspi, GPIO_TypeDef* sdn_port, uint16_t sdn_pin,
                  GPIO_TypeDef* nirq_port, uint16_t nirq_pin,
                  GPIO_TypeDef* cs_port, uint16_t cs_pin) {
-    hspi_si4463 = hspi;
-    SDN_PORT = sdn_port;
-    SDN_PIN = sdn_pin;
-    NIRQ_PORT = nirq_port;
-    NIRQ_PIN = nirq_pin;
-    CS_PORT = cs_port;
-    CS_PIN = cs_pin;
+    memset(radio, 0, sizeof(Si4463_t));
+    radio->currentBaud = 1200;
+    radio->hspi = hspi;
+    radio->sdnPort = sdn_port;
+    radio->sdnPin = sdn_pin;
+    radio->nirqPort = nirq_port;
+    radio->nirqPin = nirq_pin;
+    radio->csPort = cs_port;
+    radio->csPin = cs_pin;
 
     // Configure CS pin as output high
-    HAL_GPIO_WritePin(CS_PORT, CS_PIN, GPIO_PIN_SET);
+    HAL_GPIO_WritePin(radio->csPort, radio->csPin, GPIO_PIN_SET);
 
-    // Reset and configure
-    Si4463_Reset();
-    HAL_Delay(100);
-    Si4463_Configure();
+    // Reset and configure, an empty socket would hang waiting for CTS
+    uint32_t start = HAL_GetTick();
+    if (!Si4463_Reset(radio)) {
+        si4463_print("SI4463: Not found\r\n");
+        return false;
+    }
+    Si4463_Configure(radio);
+    radio->bootMs = HAL_GetTick() - start;
 
-    si4463_print("SI4463: Initialized\r\n");
+    si4463_printf("SI4463: Ready in %lu ms\r\n", (unsigned long)radio->bootMs);
+    return true;
 }
 
-// Reset SI4463
-void Si4463_Reset(void) {
-    HAL_GPIO_WritePin(SDN_PORT, SDN_PIN, GPIO_PIN_SET);
-    HAL_Delay(10);
-    HAL_GPIO_WritePin(SDN_PORT, SDN_PIN, GPIO_PIN_RESET);
-    HAL_Delay(100); // Wait for boot
+// Check that an SI4463 answers PART_INFO
+bool Si4463_Probe(Si4463_t *radio) {
+    uint8_t partInfo[8] = {0};
+
+    if (!Si4463_Command(radio, (uint8_t[]){0x01}, 1, partInfo, sizeof(partInfo))) {
+        return false;
+    }
+    // PART is 0x4460..0x4464 across the family, a floating MISO reads 0xFFFF
+    return partInfo[1] == 0x44 && (partInfo[2] & 0xF0) == 0x60;
 }
 
-// Configure SI4463 with radio config
-void Si4463_Configure(void) {
+// Pulse SDN and wait until the chip has booted, properties return to their defaults.
+// Returns false when no SI4463 answers within SI4463_POR_TIMEOUT_MS.
+bool Si4463_Reset(Si4463_t *radio) {
+    Si4463_InvalidateProperties(radio);
+    HAL_GPIO_WritePin(radio->sdnPort, radio->sdnPin, GPIO_PIN_SET);
+    si4463_delayUs(SI4463_SDN_PULSE_US);
+    HAL_GPIO_WritePin(radio->sdnPort, radio->sdnPin, GPIO_PIN_RESET);
+
+    // CTS reads 0x00 until the power-on reset has finished, a MISO that
+    // floats high during reset is caught by the part number check
+    uint32_t start = HAL_GetTick();
+    do {
+        uint32_t traceStart = Si4463Trace_Cycles();
+        uint16_t polls = 0;
+        bool cts = si4463_pollCts(radio, NULL, 0, SI4463_POR_TIMEOUT_MS, &polls);
+
+        Si4463Trace_Record(radio->hspi, cts ? SI4463_TRACE_COMMAND : SI4463_TRACE_TIMEOUT, 0x44, 1, 0,
+                           traceStart, traceStart, polls);
+        if (cts && Si4463_Probe(radio)) {
+            return true;
+        }
+    } while (HAL_GetTick() - start <= SI4463_POR_TIMEOUT_MS);
+
+    return false;
+}
+
+// Replay the radio configuration, consecutive SET_PROPERTY entries of one
+// group are merged into a single command and go through the property shadow
+void Si4463_Configure(Si4463_t *radio) {
     const uint8_t *config = RADIO_CONFIGURATION_DATA_ARRAY;
-    uint8_t len;
-    uint8_t cmd[16];
+    uint8_t values[SI4463_PROP_MAX];
+    uint8_t group = 0, start = 0, count = 0;
+    bool rawProperties = false;
 
     while (*config != 0x00) {
-        len = *config++;
-        memcpy(cmd, config, len);
+        uint8_t len = *config++;
+        const uint8_t *cmd = config;
         config += len;
-        Si4463_Write(cmd, len);
 
-        // Wait for CTS
-        uint8_t cts = 0;
-        while (cts != 0xFF) {
-            Si4463_Read((uint8_t[]){0x44}, 1, &cts, 1);
-            HAL_Delay(1);
+        if (cmd[0] == 0x11 && len > 4 && cmd[2] == len - 4 && cmd[2] <= SI4463_PROP_MAX) {
+            // flush the pending run unless this entry continues it
+            if (count > 0 && (cmd[1] != group || cmd[3] != (uint8_t)(start + count) ||
+                              count + cmd[2] > SI4463_PROP_MAX)) {
+                Si4463_SetProperties(radio, group, start, values, count);
+                count = 0;
+            }
+            if (count == 0) {
+                group = cmd[1];
+                start = cmd[3];
+            }
+            memcpy(&values[count], &cmd[4], cmd[2]);
+            count += cmd[2];
+            continue;
+        }
+
+        if (count > 0) {
+            Si4463_SetProperties(radio, group, start, values, count);
+            count = 0;
+        }
+        // other commands, and malformed SET_PROPERTY entries, are sent as they are
+        if (cmd[0] == 0x11) {
+            rawProperties = true;
         }
+        Si4463_Command(radio, (uint8_t*)cmd, len, NULL, 0);
+    }
+    if (count > 0) {
+        Si4463_SetProperties(radio, group, start, values, count);
+    }
+
+    // properties written behind the shadow's back
+    if (rawProperties) {
+        Si4463_InvalidateProperties(radio);
     }
-    si4463_print("SI4463: Basic configuration complete\r\n");
 }
 
 // Configure specifically for POCSAG transmission
-void Si4463_ConfigureForPOCSAG(void) {
+void Si4463_ConfigureForPOCSAG(Si4463_t *radio) {
     // Set up for 1200 baud FSK modulation typical for POCSAG
-    Si4463_SetPOCSAGDataRate(1200);
+    Si4463_SetPOCSAGDataRate(radio, 1200);
 
     // Set deviation ~4.5 kHz for POCSAG
-    uint8_t dev_cfg[] = {
-        0x11, 0x20, 0x01, 0x0A, 0x52, // ~4.5 kHz deviation
-    };
-    Si4463_Write(dev_cfg, sizeof(dev_cfg));
+    uint8_t dev_cfg[] = {0x52}; // MODEM group, 0x0A: ~4.5 kHz deviation
+    Si4463_SetProperties(radio, 0x20, 0x0A, dev_cfg, sizeof(dev_cfg));
 
-    // Configure for FSK modulation
+    // Configure for FSK modulation, normal polarity until Si4463_SetTxInvert()
     uint8_t modem_cfg[] = {
-        0x11, 0x20, 0x07, 0x00, // MODEM_MOD_TYPE
-        0x03,                   // FSK mode
+        SI4463_MOD_TYPE_PACKET, // MODEM_MOD_TYPE: FSK mode
         0x00, 0x00, 0x00, 0x00, 0x00
     };
-    Si4463_Write(modem_cfg, sizeof(modem_cfg));
+    Si4463_SetProperties(radio, 0x20, 0x00, modem_cfg, sizeof(modem_cfg));
+    radio->txInvert = false;
+
+    // TX FIFO almost-empty threshold for streaming messages longer than the FIFO,
+    // RX FIFO almost-full threshold for streaming received data
+    uint8_t thresholds[] = {
+        SI4463_TX_THRESHOLD,    // PKT group, PKT_TX_THRESHOLD
+        SI4463_RX_THRESHOLD     // PKT_RX_THRESHOLD
+    };
+    Si4463_SetProperties(radio, 0x12, 0x0B, thresholds, sizeof(thresholds));
+
+    // Route packet handler interrupts to nIRQ
+    uint8_t int_cfg[] = {
+        0x01,                   // INT_CTL group, INT_CTL_ENABLE: PH interrupts
+        0x33                    // INT_CTL_PH_ENABLE: PACKET_SENT | PACKET_RX |
+                                // TX_FIFO_ALMOST_EMPTY | RX_FIFO_ALMOST_FULL
+    };
+    Si4463_SetProperties(radio, 0x01, 0x00, int_cfg, sizeof(int_cfg));
+
+    // The POCSAG encoder sends its own preamble and sync codewords unless
+    // the caller hands the preamble to the radio with Si4463_SetPreamble()
+    Si4463_SetPreamble(radio, 0, false);
+    uint8_t sync_cfg[] = {
+        0x80 | (SI4463_RX_SYNC_ERRORS << 4) | 0x03  // SYNC group, SYNC_CONFIG: SKIP_TX, as Si4463_StartRx()
+    };
+    Si4463_SetProperties(radio, 0x11, 0x00, sync_cfg, sizeof(sync_cfg));
 
     si4463_print("SI4463: Configured for POCSAG\r\n");
 }
 
 // Set POCSAG data rate (512 or 1200 baud)
-void Si4463_SetPOCSAGDataRate(uint16_t baudRate) {
+void Si4463_SetPOCSAGDataRate(Si4463_t *radio, uint16_t baudRate) {
     uint32_t dataRateReg;
+    uint32_t sent = radio->propSent;
 
     if (baudRate == 512) {
         dataRateReg = 0x800000; // 512 bps
     } else {
         dataRateReg = 0x1DCD65; // 1200 bps (default)
+        baudRate = 1200;
     }
+    radio->currentBaud = baudRate;
 
-    uint8_t rate_cmd[] = {
-        0x11, 0x20, 0x04, 0x03, // SET_PROPERTY, MODEM group, DATA_RATE
+    uint8_t rate[] = {          // MODEM group, DATA_RATE
         (uint8_t)((dataRateReg >> 24) & 0xFF),
         (uint8_t)((dataRateReg >> 16) & 0xFF),
         (uint8_t)((dataRateReg >> 8) & 0xFF),
         (uint8_t)(dataRateReg & 0xFF)
     };
-    Si4463_Write(rate_cmd, sizeof(rate_cmd));
+    Si4463_SetProperties(radio, 0x20, 0x03, rate, sizeof(rate));
 
+    // nothing to report when the radio was already at this rate
+    if (radio->propSent == sent) {
+        return;
+    }
     si4463_printf("SI4463: Data rate set to %d bps\r\n", baudRate);
 }
 
+// One write frame, not traced on its own
+static void si4463_transmit(Si4463_t *radio, uint8_t *data, uint8_t len) {
+    HAL_GPIO_WritePin(radio->csPort, radio->csPin, GPIO_PIN_RESET);
+    HAL_SPI_Transmit(radio->hspi, data, len, HAL_MAX_DELAY);
+    HAL_GPIO_WritePin(radio->csPort, radio->csPin, GPIO_PIN_SET);
+}
+
+// Let the packet handler send lengthBytes of alternating bits ahead of the
+// FIFO data, 0x55 bytes when inverted and 0xAA otherwise. 0 = no preamble.
+void Si4463_SetPreamble(Si4463_t *radio, uint8_t lengthBytes, bool inverted) {
+    uint8_t length[] = {lengthBytes};       // PREAMBLE group, PREAMBLE_TX_LENGTH
+    uint8_t config[] = {                    // PREAMBLE_CONFIG: 1010 pattern, length in bytes,
+        (uint8_t)(0x11 | (inverted ? 0x00 : 0x20))   // FIRST_1 unless inverted
+    };
+
+    Si4463_SetProperties(radio, 0x10, 0x00, length, sizeof(length));
+    Si4463_SetProperties(radio, 0x10, 0x04, config, sizeof(config));
+    radio->preambleLen = lengthBytes;
+    radio->preambleInverted = inverted;
+}
+
 // Write to SI4463
-void Si4463_Write(uint8_t *data, uint8_t len) {
-    if (!hspi_si4463 || !data || len == 0) return;
+void Si4463_Write(Si4463_t *radio, uint8_t *data, uint8_t len) {
+    if (!radio->hspi || !data || len == 0) return;
 
-    HAL_GPIO_WritePin(CS_PORT, CS_PIN, GPIO_PIN_RESET);
-    HAL_SPI_Transmit(hspi_si4463, data, len, HAL_MAX_DELAY);
-    HAL_GPIO_WritePin(CS_PORT, CS_PIN, GPIO_PIN_SET);
+    uint32_t traceStart = Si4463Trace_Cycles();
+    si4463_transmit(radio, data, len);
+    Si4463Trace_Record(radio->hspi, SI4463_TRACE_WRITE, data[0], len, 0, traceStart, 0, 0);
 }
 
 // Read from SI4463
-void Si4463_Read(uint8_t *cmd, uint8_t cmdLen, uint8_t *data, uint8_t dataLen) {
-    if (!hspi_si4463 || !cmd || !data || cmdLen == 0 || dataLen == 0) return;
+void Si4463_Read(Si4463_t *radio, uint8_t *cmd, uint8_t cmdLen, uint8_t *data, uint8_t dataLen) {
+    if (!radio->hspi || !cmd || !data || cmdLen == 0 || dataLen == 0) return;
 
-    HAL_GPIO_WritePin(CS_PORT, CS_PIN, GPIO_PIN_RESET);
+    uint32_t traceStart = Si4463Trace_Cycles();
+    HAL_GPIO_WritePin(radio->csPort, radio->csPin, GPIO_PIN_RESET);
 
     // Send command
-    HAL_SPI_Transmit(hspi_si4463, cmd, cmdLen, HAL_MAX_DELAY);
+    HAL_SPI_Transmit(radio->hspi, cmd, cmdLen, HAL_MAX_DELAY);
 
     // Read response
-    HAL_SPI_Receive(hspi_si4463, data, dataLen, HAL_MAX_DELAY);
+    HAL_SPI_Receive(radio->hspi, data, dataLen, HAL_MAX_DELAY);
+
+    HAL_GPIO_WritePin(radio->csPort, radio->csPin, GPIO_PIN_SET);
+    Si4463Trace_Record(radio->hspi, SI4463_TRACE_READ, cmd[0], cmdLen, dataLen, traceStart, 0, 0);
+}
+
+// Send a command and wait for CTS, optionally reading back its response
+bool Si4463_Command(Si4463_t *radio, uint8_t *cmd, uint8_t cmdLen, uint8_t *resp, uint8_t respLen) {
+    if (!radio->hspi || !cmd || cmdLen == 0) return false;
+
+    uint32_t traceStart = Si4463Trace_Cycles();
+    si4463_transmit(radio, cmd, cmdLen);
+
+    uint32_t traceCts = Si4463Trace_Cycles();
+    uint16_t polls = 0;
+    if (si4463_pollCts(radio, resp, respLen, SI4463_CTS_TIMEOUT_MS, &polls)) {
+        Si4463Trace_Record(radio->hspi, SI4463_TRACE_COMMAND, cmd[0], cmdLen, resp ? respLen : 0,
+                           traceStart, traceCts, polls);
+        return true;
+    }
+
+    Si4463Trace_Record(radio->hspi, SI4463_TRACE_TIMEOUT, cmd[0], cmdLen, 0, traceStart, traceCts, polls);
+    si4463_printf("SI4463: CTS timeout (cmd 0x%02X)\r\n", cmd[0]);
+    return false;
+}
+
+// Poll READ_CMD_BUFF until CTS, then read respLen response bytes
+static bool si4463_pollCts(Si4463_t *radio, uint8_t *resp, uint8_t respLen, uint32_t timeoutMs, uint16_t *polls) {
+    uint8_t readCmd = 0x44; // READ_CMD_BUFF
+    uint32_t start = HAL_GetTick();
+
+    while (1) {
+        uint8_t cts = 0;
+
+        if (polls && *polls < UINT16_MAX) (*polls)++;
+        HAL_GPIO_WritePin(radio->csPort, radio->csPin, GPIO_PIN_RESET);
+        HAL_SPI_Transmit(radio->hspi, &readCmd, 1, HAL_MAX_DELAY);
+        HAL_SPI_Receive(radio->hspi, &cts, 1, HAL_MAX_DELAY);
+        if (cts == 0xFF) {
+            // response bytes follow CTS within the same chip-select frame
+            if (resp && respLen > 0) {
+                HAL_SPI_Receive(radio->hspi, resp, respLen, HAL_MAX_DELAY);
+            }
+            HAL_GPIO_WritePin(radio->csPort, radio->csPin, GPIO_PIN_SET);
+            return true;
+        }
+        HAL_GPIO_WritePin(radio->csPort, radio->csPin, GPIO_PIN_SET);
+
+        if (HAL_GetTick() - start > timeoutMs) {
+            return false;
+        }
+    }
+}
+
+// Busy-wait for short delays below the 1 ms HAL tick, at least us microseconds
+static void si4463_delayUs(uint32_t us) {
+    // a volatile down-count takes more than 3 cycles per pass on the Cortex-M3
+    volatile uint32_t n = SystemCoreClock / 1000000U * us / 3 + 1;
 
-    HAL_GPIO_WritePin(CS_PORT, CS_PIN, GPIO_PIN_SET);
+    while (n--) {
+    }
 }
 
 // Set Frequency for POCSAG
-void Si4463_SetFrequency(float freq) {
-    // SI4463 frequency calculation (assumes 30 MHz crystal)
-    uint32_t freq_val = (uint32_t)(freq * 1000000.0f / 30.0f * 524288.0f);
-
-    uint8_t cmd[8] = {
-        0x11, // SET_PROPERTY
-        0x20, // FREQ_CONTROL group
-        0x04, // Number of bytes
-        0x00, // FREQ_CONTROL_INTE
-        (uint8_t)((freq_val >> 16) & 0xFF), // FREQ_CONTROL_FRAC_2
-        (uint8_t)((freq_val >> 8) & 0xFF),  // FREQ_CONTROL_FRAC_1
-        (uint8_t)(freq_val & 0xFF),         // FREQ_CONTROL_FRAC_0
-        0x00  // Channel step size
+void Si4463_SetFrequency(Si4463_t *radio, float freq) {
+    // SI4463 frequency calculation (assumes 30 MHz crystal, high performance
+    // synthesizer): freq = (INTE + FRAC / 2^19) * 2 * 30 MHz / OUTDIV
+    uint8_t outdiv, band;
+    uint32_t sent = radio->propSent;
+
+    if (freq < 200.0f) {
+        outdiv = 24; band = 5;
+    } else if (freq < 600.0f) {
+        outdiv = 8; band = 2;
+    } else {
+        outdiv = 4; band = 0;
+    }
+    double n = (double)freq * 1000000.0 * outdiv / (2.0 * SI4463_XO_HZ);
+    uint8_t inte = (uint8_t)n - 1;
+    uint32_t frac = (uint32_t)((n - inte) * 524288.0);
+
+    uint8_t values[4] = {
+        inte,                               // FREQ_CONTROL_INTE
+        (uint8_t)((frac >> 16) & 0xFF),     // FREQ_CONTROL_FRAC_2
+        (uint8_t)((frac >> 8) & 0xFF),      // FREQ_CONTROL_FRAC_1
+        (uint8_t)(frac & 0xFF)              // FREQ_CONTROL_FRAC_0
+    };
+    uint8_t clkgen[] = {
+        (uint8_t)(0x08 | band)              // MODEM group, MODEM_CLKGEN_BAND: SY_SEL high performance
     };
 
-    Si4463_Write(cmd, 8);
+    // FREQ_CONTROL group 0x40, the MODEM group holds the modulation settings
+    Si4463_SetProperties(radio, 0x20, 0x51, clkgen, sizeof(clkgen));
+    Si4463_SetProperties(radio, 0x40, 0x00, values, sizeof(values));
 
-    // Wait for CTS
-    uint8_t cts = 0;
-    while (cts != 0xFF) {
-        Si4463_Read((uint8_t[]){0x44}, 1, &cts, 1);
-        HAL_Delay(1);
+    if (radio->propSent == sent) {
+        return;
     }
-
     si4463_printf("SI4463: Frequency set to %.3f MHz\r\n", freq);
 }
 
-// Transmit POCSAG data
-void Si4463_TransmitPOCSAG(uint8_t *data, uint16_t len) {
+// Invert the transmitted data in the modem (MODEM_MAP_CONTROL ENINV_TXBIT):
+// FIFO data and the radio's preamble go on air in the opposite polarity, so
+// encoded buffers can stay in normal polarity. Reception is not affected.
+void Si4463_SetTxInvert(Si4463_t *radio, bool invert) {
+    uint8_t map[] = {
+        invert ? SI4463_MAP_ENINV_TXBIT : 0x00  // MODEM group, MODEM_MAP_CONTROL
+    };
+
+    Si4463_SetProperties(radio, 0x20, 0x01, map, sizeof(map));
+    radio->txInvert = invert;
+}
+
+// Find the shadow entry of a property, NULL when its value is unknown
+static Si4463_Property_t *si4463_shadowFind(Si4463_t *radio, uint8_t group, uint8_t index) {
+    for (uint8_t i = 0; i < radio->shadowCount; i++) {
+        if (radio->shadow[i].group == group && radio->shadow[i].index == index) {
+            return &radio->shadow[i];
+        }
+    }
+    return NULL;
+}
+
+// Check whether the radio is known to hold value
+static bool si4463_shadowMatches(Si4463_t *radio, uint8_t group, uint8_t index, uint8_t value) {
+    Si4463_Property_t *prop = si4463_shadowFind(radio, group, index);
+    return prop && prop->value == value;
+}
+
+// Remember a written value, properties beyond the shadow size are not cached
+static void si4463_shadowStore(Si4463_t *radio, uint8_t group, uint8_t index, uint8_t value) {
+    Si4463_Property_t *prop = si4463_shadowFind(radio, group, index);
+
+    if (!prop) {
+        if (radio->shadowCount >= SI4463_SHADOW_SIZE) {
+            return;
+        }
+        prop = &radio->shadow[radio->shadowCount++];
+        prop->group = group;
+        prop->index = index;
+    }
+    prop->value = value;
+}
+
+// Drop a property whose value is no longer certain
+static void si4463_shadowForget(Si4463_t *radio, uint8_t group, uint8_t index) {
+    Si4463_Property_t *prop = si4463_shadowFind(radio, group, index);
+
+    if (prop) {
+        *prop = radio->shadow[--radio->shadowCount];
+    }
+}
+
+// Send one SET_PROPERTY and update the shadow with its values
+static bool si4463_writeProperties(Si4463_t *radio, uint8_t group, uint8_t start, const uint8_t *values, uint8_t count) {
+    uint8_t cmd[4 + SI4463_PROP_MAX] = {0x11, group, count, start}; // SET_PROPERTY
+    bool ok;
+
+    memcpy(&cmd[4], values, count);
+    ok = Si4463_Command(radio, cmd, 4 + count, NULL, 0);
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (ok) {
+            si4463_shadowStore(radio, group, (uint8_t)(start + i), values[i]);
+        } else {
+            si4463_shadowForget(radio, group, (uint8_t)(start + i));
+        }
+    }
+    radio->propSent += count;
+    return ok;
+}
+
+// Set count consecutive properties, only the bytes that differ from the shadow are sent
+bool Si4463_SetProperties(Si4463_t *radio, uint8_t group, uint8_t start, const uint8_t *values, uint8_t count) {
+    uint8_t i = 0;
+    bool ok = true;
+
+    if (!values) return false;
+
+    while (i < count) {
+        if (si4463_shadowMatches(radio, group, (uint8_t)(start + i), values[i])) {
+            radio->propSkipped++;
+            i++;
+            continue;
+        }
+
+        // extend the run over nearby changes, up to one command's worth
+        uint8_t first = i;
+        uint8_t last = i;
+        for (uint8_t j = i + 1; j < count && j - first < SI4463_PROP_MAX; j++) {
+            if (si4463_shadowMatches(radio, group, (uint8_t)(start + j), values[j])) {
+                if (j - last > SI4463_PROP_MERGE_GAP) {
+                    break;
+                }
+                continue;
+            }
+            last = j;
+        }
+
+        if (!si4463_writeProperties(radio, group, (uint8_t)(start + first), &values[first], last - first + 1)) {
+            ok = false;
+        }
+        i = last + 1;
+    }
+    return ok;
+}
+
+// Forget every shadowed value, the next write of each property goes to the radio
+void Si4463_InvalidateProperties(Si4463_t *radio) {
+    radio->shadowCount = 0;
+}
+
+// Top up the TX FIFO with as much pending data as fits
+static void si4463_fillTxFifo(Si4463_t *radio) {
+    if (radio->txPos >= radio->txLen && !si4463_nextChunk(radio)) return;
+
+    uint8_t space = Si4463_GetTxFifoSpace(radio);
+
+    // a continuous transmission goes on with the next chunk while there is room
+    while (space > 0) {
+        uint16_t chunk = radio->txLen - radio->txPos;
+        if (chunk > space) {
+            chunk = space;
+        }
+
+        uint8_t fifo_cmd = 0x66; // WRITE_TX_FIFO
+        uint32_t traceStart = Si4463Trace_Cycles();
+        HAL_GPIO_WritePin(radio->csPort, radio->csPin, GPIO_PIN_RESET);
+        HAL_SPI_Transmit(radio->hspi, &fifo_cmd, 1, HAL_MAX_DELAY);
+        HAL_SPI_Transmit(radio->hspi, (uint8_t*)&radio->txData[radio->txPos], chunk, HAL_MAX_DELAY);
+        HAL_GPIO_WritePin(radio->csPort, radio->csPin, GPIO_PIN_SET);
+        Si4463Trace_Record(radio->hspi, SI4463_TRACE_WRITE, fifo_cmd, (uint8_t)(chunk + 1), 0, traceStart, 0, 0);
+
+        radio->txPos += chunk;
+        space -= chunk;
+        if (radio->txPos >= radio->txLen && !si4463_nextChunk(radio)) {
+            break;
+        }
+    }
+}
+
+// Continuous transmission: move on to the chunk queued by Si4463_AppendTx(),
+// its predecessor is in the FIFO and no longer needed. Without one the tail
+// closes the packet, TX_FIFO_ALMOST_EMPTY then fires once only part of the
+// tail is left in the FIFO.
+static bool si4463_nextChunk(Si4463_t *radio) {
+    if (!radio->txStream || radio->txClosing) {
+        return false;
+    }
+
+    if (radio->txNextData) {
+        radio->txData = radio->txNextData;
+        radio->txLen = radio->txNextLen;
+        radio->txNextData = NULL;
+        radio->txNextLen = 0;
+    } else {
+        uint8_t threshold = SI4463_FIFO_SIZE + 1 - radio->txTail;    // PKT_TX_THRESHOLD
+
+        memset(si4463_tail, SI4463_STREAM_TAIL_BYTE, sizeof(si4463_tail));
+        radio->txData = si4463_tail;
+        radio->txLen = radio->txTail;
+        radio->txClosing = true;
+        Si4463_SetProperties(radio, 0x12, 0x0B, &threshold, 1);
+    }
+    radio->txPos = 0;
+    return true;
+}
+
+// Cut a continuous transmission and restore the refill threshold
+static void si4463_endStream(Si4463_t *radio) {
+    uint8_t ready[] = {0x34, 0x03};     // CHANGE_STATE: READY
+    Si4463_Command(radio, ready, sizeof(ready), NULL, 0);
+
+    uint8_t threshold = SI4463_TX_THRESHOLD;
+    Si4463_SetProperties(radio, 0x12, 0x0B, &threshold, 1);
+    radio->txStream = false;
+    radio->txClosing = false;
+    radio->txNextData = NULL;
+    radio->txNextLen = 0;
+}
+
+// Reset the TX FIFO and pre-load it with the start of a message.
+// The data buffer must stay valid until Si4463_ServiceTx(radio) reports completion.
+bool Si4463_LoadTx(Si4463_t *radio, const uint8_t *data, uint16_t len) {
     if (!data || len == 0) {
         si4463_print("SI4463: No data to transmit\r\n");
-        return;
+        return false;
+    }
+    if (radio->txActive) {
+        return false;
     }
 
+    radio->txData = data;
+    radio->txLen = len;
+    radio->txPos = 0;
+    radio->txTotal = len;
+    radio->txStream = false;
+    radio->txClosing = false;
+    radio->txNextData = NULL;
+    radio->txNextLen = 0;
+
     // Clear TX FIFO
     uint8_t clear_fifo[] = {0x15, 0x01}; // FIFO_INFO with clear TX
-    Si4463_Write(clear_fifo, sizeof(clear_fifo));
+    Si4463_Command(radio, clear_fifo, sizeof(clear_fifo), NULL, 0);
 
-    // Write data to TX FIFO
-    uint8_t fifo_cmd = 0x66; // WRITE_TX_FIFO
-    HAL_GPIO_WritePin(CS_PORT, CS_PIN, GPIO_PIN_RESET);
-    HAL_SPI_Transmit(hspi_si4463, &fifo_cmd, 1, HAL_MAX_DELAY);
-    HAL_SPI_Transmit(hspi_si4463, data, len, HAL_MAX_DELAY);
-    HAL_GPIO_WritePin(CS_PORT, CS_PIN, GPIO_PIN_SET);
+    // Pre-load the FIFO, the rest is streamed on TX_FIFO_ALMOST_EMPTY
+    si4463_fillTxFifo(radio);
 
-    // Start transmission
-    uint8_t tx_cmd[] = {0x31, 0x00, 0x00, 0x00, 0x00}; // START_TX command
-    Si4463_Write(tx_cmd, sizeof(tx_cmd));
+    return true;
+}
 
-    // Calculate transmission time (bits * 1000 / baudRate) + margin
-    uint32_t transmit_time_ms = (len * 8 * 1000 / 1200) + 100;
-    si4463_printf("SI4463: Transmitting %d bytes (~%lu ms)\r\n", len, transmit_time_ms);
+// Put the message loaded by Si4463_LoadTx(radio) on air and return immediately
+bool Si4463_StartTx(Si4463_t *radio) {
+    if (radio->txActive || radio->txLen == 0) {
+        return false;
+    }
 
-    // Wait for transmission to complete
-    HAL_Delay(transmit_time_ms);
+    // Drop stale interrupts so nIRQ only reports this transmission
+    Si4463_ClearInt(radio);
+
+    // START_TX leaves the receiver
+    radio->rxActive = false;
+
+    // Start transmission, return to READY when the packet is sent. A
+    // continuous transmission is cut before it reaches the maximum length.
+    uint16_t packetLen = radio->txStream ? SI4463_TX_LEN_MAX : radio->txLen;
+    uint8_t tx_cmd[] = {
+        0x31, 0x00, 0x30,         // START_TX, channel 0, TXCOMPLETE_STATE = READY
+        (uint8_t)(packetLen >> 8),       // TX_LEN
+        (uint8_t)(packetLen & 0xFF)
+    };
+    Si4463_Command(radio, tx_cmd, sizeof(tx_cmd), NULL, 0);
+    if (radio->txStartHook) {
+        radio->txStartHook(radio->txStartCtx);
+    }
+
+    radio->txActive = true;
+    radio->txStartTick = HAL_GetTick();
+
+    // Expected airtime (bits * 1000 / baudRate) plus margin before giving up
+    uint32_t transmit_time_ms = Si4463_GetAirtimeMs(radio, radio->txLen) + 100;
+    radio->txTimeoutMs = transmit_time_ms + 100;
+    si4463_printf("SI4463: Transmitting %d bytes (~%lu ms)\r\n", radio->txLen, (unsigned long)transmit_time_ms);
+
+    return true;
+}
+
+// Put the message loaded by Si4463_LoadTx(radio) on air as a continuous
+// transmission: Si4463_AppendTx(radio) adds to it while it is on air, and it
+// ends once no further data has been queued when the FIFO runs low.
+bool Si4463_StartStreamTx(Si4463_t *radio) {
+    if (radio->txActive || radio->txLen == 0) {
+        return false;
+    }
+
+    // a tail of about SI4463_STREAM_TAIL_MS, at least one byte beyond the last bit
+    uint32_t tail = (uint32_t)radio->currentBaud * SI4463_STREAM_TAIL_MS / 8000 + 2;
+    radio->txTail = (uint8_t)(tail > SI4463_STREAM_TAIL_MAX ? SI4463_STREAM_TAIL_MAX : tail);
+    radio->txStream = true;
+
+    if (!Si4463_StartTx(radio)) {
+        radio->txStream = false;
+        return false;
+    }
+    return true;
+}
+
+// Queue data behind a transmission started with Si4463_StartStreamTx() or
+// Si4463_StartDirectTx(). One chunk waits at a time, see Si4463_IsTxPending().
+// Returns false once the transmission has been closed, or when the packet
+// cannot grow by len bytes. The data must stay valid until it is no longer pending.
+bool Si4463_AppendTx(Si4463_t *radio, const uint8_t *data, uint16_t len) {
+    bool ok = false;
+
+    if (!data || len == 0) {
+        return false;
+    }
+
+    // DirectTx takes the chunk from its interrupt
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (radio->txActive && radio->txStream && !radio->txClosing && !radio->txNextData &&
+        (radio->txDirect || (uint32_t)radio->txTotal + len + radio->txTail <= SI4463_TX_LEN_MAX)) {
+        radio->txNextData = data;
+        radio->txNextLen = len;
+        ok = true;
+    }
+    __set_PRIMASK(primask);
+
+    if (ok && !radio->txDirect) {
+        radio->txTotal += len;
+        radio->txTimeoutMs = Si4463_GetAirtimeMs(radio, radio->txTotal + radio->txTail) + 200;
+    }
+    return ok;
+}
+
+// An appended chunk has not been taken yet, the buffer before it is still in use
+bool Si4463_IsTxPending(Si4463_t *radio) {
+    return radio->txNextData != NULL;
+}
+
+// Load and start a transmission, returns immediately
+bool Si4463_StartTransmit(Si4463_t *radio, const uint8_t *data, uint16_t len) {
+    return Si4463_LoadTx(radio, data, len) && Si4463_StartTx(radio);
+}
+
+// Put a message on air in asynchronous direct mode: the modem follows the
+// level of GPIO0, which DirectTx clocks from a timer interrupt at the data
+// rate. Neither the FIFO nor TX_LEN limit the length, the radio's preamble
+// setting is sent by DirectTx as well. The data buffer must stay valid until
+// Si4463_ServiceTx(radio) reports completion.
+bool Si4463_StartDirectTx(Si4463_t *radio, const uint8_t *data, uint16_t len) {
+    if (radio->txActive || !data || len == 0) {
+        return false;
+    }
+
+    Si4463_ClearInt(radio);
+    radio->rxActive = false;
+
+    // GPIO0 is the TX data input, other pins unchanged
+    uint8_t gpio_cfg[] = {0x13, SI4463_GPIO_INPUT, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    Si4463_Command(radio, gpio_cfg, sizeof(gpio_cfg), NULL, 0);
+
+    // the inversion is applied while clocking the bits out
+    uint8_t modem[] = {SI4463_MOD_TYPE_DIRECT, 0x00};   // MODEM_MOD_TYPE, MODEM_MAP_CONTROL
+    Si4463_SetProperties(radio, 0x20, 0x00, modem, sizeof(modem));
+
+    // TX until CHANGE_STATE, the length is not known to the radio
+    uint8_t tx_cmd[] = {0x31, 0x00, 0x30, 0x00, 0x00};
+    Si4463_Command(radio, tx_cmd, sizeof(tx_cmd), NULL, 0);
+
+    // further data can be appended until DirectTx runs out of it
+    radio->txStream = true;
+    radio->txClosing = false;
+    radio->txNextData = NULL;
+    radio->txNextLen = 0;
+    DirectTx_SetRefill(si4463_directRefill, radio);
+
+    if (!DirectTx_Start(data, len, radio->preambleInverted ? 0x55 : 0xAA, radio->preambleLen,
+                        radio->currentBaud, radio->txInvert)) {
+        si4463_stopDirectTx(radio);
+        return false;
+    }
+    if (radio->txStartHook) {
+        radio->txStartHook(radio->txStartCtx);
+    }
+
+    radio->txActive = true;
+    radio->txDirect = true;
+    radio->txData = data;
+    radio->txLen = len;
+    radio->txStartTick = HAL_GetTick();
+    si4463_printf("SI4463: Direct TX of %d bytes (~%lu ms)\r\n", len,
+                  (unsigned long)Si4463_GetAirtimeMs(radio, len));
+
+    return true;
+}
+
+// Register a function run right after START_TX, ahead of the driver's own
+// bookkeeping and prints, NULL removes it
+void Si4463_SetTxStartHook(Si4463_t *radio, Si4463_TxStartHook_t hook, void *ctx) {
+    radio->txStartHook = hook;
+    radio->txStartCtx = ctx;
+}
+
+// Leave direct mode: back to READY and FSK from the packet handler
+static void si4463_stopDirectTx(Si4463_t *radio) {
+    uint8_t ready[] = {0x34, 0x03};     // CHANGE_STATE: READY
+    Si4463_Command(radio, ready, sizeof(ready), NULL, 0);
+
+    uint8_t modem[] = {                 // MODEM_MOD_TYPE, MODEM_MAP_CONTROL
+        SI4463_MOD_TYPE_PACKET,
+        radio->txInvert ? SI4463_MAP_ENINV_TXBIT : 0x00
+    };
+    Si4463_SetProperties(radio, 0x20, 0x00, modem, sizeof(modem));
+    DirectTx_SetRefill(NULL, NULL);
+    radio->txDirect = false;
+    radio->txStream = false;
+    radio->txNextData = NULL;
+    radio->txNextLen = 0;
+}
+
+// DirectTx ran out of data: hand over the appended chunk, or close the transmission
+static uint16_t si4463_directRefill(void *ctx, const uint8_t **data) {
+    Si4463_t *radio = ctx;
+    uint16_t len = radio->txNextLen;
+
+    *data = radio->txNextData;
+    radio->txNextData = NULL;
+    radio->txNextLen = 0;
+    if (len == 0) {
+        radio->txClosing = true;
+    }
+    return len;
+}
+
+// Service the radio after nIRQ (or a poll tick): refill the FIFO and detect
+// the end of the packet. Returns true once when the transmission has finished.
+bool Si4463_ServiceTx(Si4463_t *radio) {
+    if (!radio->txActive) {
+        // RX interrupts are left to Si4463_ServiceRx(radio)
+        if (!radio->rxActive && Si4463_IsNIRQActive(radio)) {
+            Si4463_ClearInt(radio);
+        }
+        return false;
+    }
+
+    // direct mode: DirectTx raises EVENT_RADIO_IRQ after the last bit. The
+    // length may grow while on air, so only a bit clock that falls behind times out.
+    if (radio->txDirect) {
+        uint32_t clockedMs = DirectTx_GetBitsSent() * 1000 / radio->currentBaud;
+        bool timeout = HAL_GetTick() - radio->txStartTick > clockedMs + SI4463_DIRECT_TIMEOUT_MS;
+
+        if (DirectTx_IsActive() && !timeout) {
+            return false;
+        }
+        DirectTx_Stop();
+        si4463_stopDirectTx(radio);
+        radio->txActive = false;
+        si4463_print(timeout ? "SI4463: Transmission timeout\r\n" : "SI4463: Transmission complete\r\n");
+        return true;
+    }
+
+    uint8_t intStatus[8];
+    Si4463_GetIntStatus(radio, intStatus);
 
-    si4463_print("SI4463: Transmission complete\r\n");
+    if (intStatus[2] & 0x20) { // PH_PEND: PACKET_SENT
+        radio->txActive = false;
+        si4463_print("SI4463: Transmission complete\r\n");
+        return true;
+    }
+
+    si4463_fillTxFifo(radio);
+
+    // continuous transmission: cut it once the data is out and only tail is left
+    if (radio->txClosing && radio->txPos >= radio->txLen &&
+        Si4463_GetTxFifoSpace(radio) > SI4463_FIFO_SIZE - radio->txTail) {
+        si4463_endStream(radio);
+        radio->txActive = false;
+        si4463_print("SI4463: Transmission complete\r\n");
+        return true;
+    }
+
+    if (HAL_GetTick() - radio->txStartTick > radio->txTimeoutMs) {
+        if (radio->txStream) {
+            si4463_endStream(radio);
+        }
+        radio->txActive = false;
+        si4463_print("SI4463: Transmission timeout\r\n");
+        return true;
+    }
+
+    return false;
+}
+
+// Check if a transmission is in progress
+bool Si4463_IsTransmitting(Si4463_t *radio) {
+    return radio->txActive;
+}
+
+// Get the expected airtime of len bytes of FIFO data, plus the radio's
+// preamble, at the current data rate
+uint32_t Si4463_GetAirtimeMs(Si4463_t *radio, uint16_t len) {
+    return Si4463_GetAirtimeMsAt(radio, len, radio->currentBaud);
+}
+
+// As Si4463_GetAirtimeMs at another data rate, for a transmission that will
+// switch the rate when it starts
+uint32_t Si4463_GetAirtimeMsAt(Si4463_t *radio, uint16_t len, uint16_t baudRate) {
+    return ((uint32_t)len + radio->preambleLen) * 8 * 1000 / baudRate;
+}
+
+// Transmit POCSAG data (blocking)
+void Si4463_TransmitPOCSAG(Si4463_t *radio, uint8_t *data, uint16_t len) {
+    if (!Si4463_StartTransmit(radio, data, len)) {
+        return;
+    }
+
+    // Wait for transmission to complete
+    while (!Si4463_ServiceTx(radio)) {
+        HAL_Delay(1);
+    }
 }
 
 // Check if NIRQ is active (for RX applications)
-bool Si4463_IsNIRQActive(void) {
-    return (HAL_GPIO_ReadPin(NIRQ_PORT, NIRQ_PIN) == GPIO_PIN_RESET);
+bool Si4463_IsNIRQActive(Si4463_t *radio) {
+    return (HAL_GPIO_ReadPin(radio->nirqPort, radio->nirqPin) == GPIO_PIN_RESET);
+}
+
+// Hunt for syncWord and stream the data that follows into the RX FIFO,
+// serviced with Si4463_ServiceRx(radio) on nIRQ (or a poll tick)
+bool Si4463_StartRx(Si4463_t *radio, uint32_t syncWord) {
+    if (radio->txActive) {
+        return false;
+    }
+
+    // 4 byte sync word, not inserted on TX (the POCSAG encoder sends its own)
+    uint8_t sync_cfg[] = {        // SYNC group, SYNC_CONFIG + SYNC_BITS
+        0x80 | (SI4463_RX_SYNC_ERRORS << 4) | 0x03, // SKIP_TX, RX_ERRORS, LENGTH = 4 bytes
+        (uint8_t)((syncWord >> 24) & 0xFF),
+        (uint8_t)((syncWord >> 16) & 0xFF),
+        (uint8_t)((syncWord >> 8) & 0xFF),
+        (uint8_t)(syncWord & 0xFF)
+    };
+    Si4463_SetProperties(radio, 0x11, 0x00, sync_cfg, sizeof(sync_cfg));
+
+    // Clear RX FIFO and stale interrupts
+    uint8_t clear_fifo[] = {0x15, 0x02}; // FIFO_INFO with clear RX
+    Si4463_Command(radio, clear_fifo, sizeof(clear_fifo), NULL, 0);
+    Si4463_ClearInt(radio);
+
+    // After RX_LEN bytes go back to hunting for the next sync word
+    uint8_t rx_cmd[] = {
+        0x32, 0x00, 0x00,                       // START_RX, channel 0, start now
+        (uint8_t)(SI4463_RX_STREAM_LEN >> 8),   // RX_LEN
+        (uint8_t)(SI4463_RX_STREAM_LEN & 0xFF),
+        0x00,                                   // RXTIMEOUT_STATE = no change
+        0x08,                                   // RXVALID_STATE = RX
+        0x08                                    // RXINVALID_STATE = RX
+    };
+    if (!Si4463_Command(radio, rx_cmd, sizeof(rx_cmd), NULL, 0)) {
+        return false;
+    }
+
+    radio->rxActive = true;
+    return true;
+}
+
+// Leave RX, bytes still in the RX FIFO are discarded
+void Si4463_StopRx(Si4463_t *radio) {
+    if (!radio->rxActive) {
+        return;
+    }
+
+    uint8_t ready_cmd[] = {0x34, 0x03}; // CHANGE_STATE, READY
+    Si4463_Command(radio, ready_cmd, sizeof(ready_cmd), NULL, 0);
+    radio->rxActive = false;
+}
+
+// Drain the RX FIFO after nIRQ (or a poll tick). Returns the number of bytes
+// copied to data, call again while it returns maxLen. events reports
+// SI4463_RX_PACKET_END and SI4463_RX_OVERFLOW seen by this call.
+uint8_t Si4463_ServiceRx(Si4463_t *radio, uint8_t *data, uint8_t maxLen, uint8_t *events) {
+    uint8_t intStatus[8] = {0};
+    uint8_t count;
+
+    if (events) {
+        *events = 0;
+    }
+    if (!radio->rxActive || !data || maxLen == 0) {
+        return 0;
+    }
+
+    Si4463_GetIntStatus(radio, intStatus);
+
+    if (intStatus[6] & 0x20) { // CHIP_PEND: FIFO_UNDERFLOW_OVERFLOW_ERROR
+        // data was lost, start over with an empty FIFO
+        uint8_t clear_fifo[] = {0x15, 0x02};
+        Si4463_Command(radio, clear_fifo, sizeof(clear_fifo), NULL, 0);
+        si4463_print("SI4463: RX FIFO overflow\r\n");
+        if (events) {
+            *events |= SI4463_RX_OVERFLOW;
+        }
+        return 0;
+    }
+    if ((intStatus[2] & 0x10) && events) { // PH_PEND: PACKET_RX
+        *events |= SI4463_RX_PACKET_END;
+    }
+
+    count = Si4463_GetFifoInfo(radio);
+    if (count > maxLen) {
+        count = maxLen;
+    }
+    if (count > 0) {
+        Si4463_ReadRxFifo(radio, data, count);
+    }
+    return count;
 }
 
-// Other functions for RX capability (unchanged)
-void Si4463_StartRx(void) {
-    uint8_t cmd[] = {0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-    Si4463_Write(cmd, sizeof(cmd));
+// Clear channel assessment: current RSSI on the tuned frequency in dBm.
+// Enters RX for SI4463_RSSI_SETTLE_MS unless the receiver is already running.
+bool Si4463_MeasureRssi(Si4463_t *radio, int *rssiDbm) {
+    uint8_t modemStatus[8] = {0};
+    bool ok;
+
+    if (radio->txActive || !rssiDbm) {
+        return false;
+    }
+
+    if (!radio->rxActive) {
+        uint8_t rx_cmd[] = {0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}; // START_RX, no state changes
+        if (!Si4463_Command(radio, rx_cmd, sizeof(rx_cmd), NULL, 0)) {
+            return false;
+        }
+        HAL_Delay(SI4463_RSSI_SETTLE_MS);
+    }
+
+    // GET_MODEM_STATUS, 0xFF leaves the pending modem interrupts alone
+    ok = Si4463_Command(radio, (uint8_t[]){0x22, 0xFF}, 2, modemStatus, 8);
+
+    if (!radio->rxActive) {
+        uint8_t ready_cmd[] = {0x34, 0x03}; // CHANGE_STATE, READY
+        Si4463_Command(radio, ready_cmd, sizeof(ready_cmd), NULL, 0);
+    }
+    if (!ok) {
+        return false;
+    }
+
+    *rssiDbm = (int)modemStatus[2] / 2 - SI4463_RSSI_OFFSET_DB; // CURR_RSSI
+    return true;
+}
+
+// Check if the receiver is running
+bool Si4463_IsReceiving(Si4463_t *radio) {
+    return radio->rxActive;
 }
 
-bool Si4463_ReadRxFifo(uint8_t *data, uint8_t len) {
+bool Si4463_ReadRxFifo(Si4463_t *radio, uint8_t *data, uint8_t len) {
     if (!data || len == 0) return false;
-    uint8_t cmd[2] = {0x77, 0x00};
-    Si4463_Read(cmd, 2, data, len);
+
+    // every byte clocked after READ_RX_FIFO is FIFO data
+    uint8_t cmd = 0x77;
+    Si4463_Read(radio, &cmd, 1, data, len);
     return true;
 }
 
-void Si4463_GetIntStatus(uint8_t *intStatus) {
-    Si4463_Read((uint8_t[]){0x20}, 1, intStatus, 8);
+void Si4463_GetIntStatus(Si4463_t *radio, uint8_t *intStatus) {
+    // GET_INT_STATUS without arguments returns and clears all pending flags
+    Si4463_Command(radio, (uint8_t[]){0x20}, 1, intStatus, 8);
 }
 
-void Si4463_ClearInt(void) {
+void Si4463_ClearInt(Si4463_t *radio) {
     uint8_t dummy[8];
-    Si4463_Read((uint8_t[]){0x20}, 1, dummy, 8);
+    Si4463_Command(radio, (uint8_t[]){0x20}, 1, dummy, 8);
 }
 
-uint8_t Si4463_GetFifoInfo(void) {
-    uint8_t fifoInfo[2];
-    Si4463_Read((uint8_t[]){0x15}, 1, fifoInfo, 2);
+uint8_t Si4463_GetFifoInfo(Si4463_t *radio) {
+    uint8_t fifoInfo[2] = {0, 0};
+    Si4463_Command(radio, (uint8_t[]){0x15, 0x00}, 2, fifoInfo, 2);
     return fifoInfo[0]; // Return RX bytes available
 }
+
+uint8_t Si4463_GetTxFifoSpace(Si4463_t *radio) {
+    uint8_t fifoInfo[2] = {0, 0};
+    Si4463_Command(radio, (uint8_t[]){0x15, 0x00}, 2, fifoInfo, 2);
+    if (fifoInfo[1] > SI4463_FIFO_SIZE) {
+        return SI4463_FIFO_SIZE;
+    }
+    return fifoInfo[1]; // TX FIFO free space
+}
@@ -0,0 +1,118 @@
+/*
+ * si4463_trace.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#ifdef SI4463_TRACE
+
+#include "si4463_trace.h"
+#include <string.h>
+
+static Si4463Trace_Entry_t ring[SI4463_TRACE_DEPTH];
+static uint16_t head = 0;       // next slot written
+static uint16_t count = 0;
+static uint32_t lost = 0;       // entries overwritten since the last clear
+
+// Microsecond clock folded from the cycle counter, like perf.c, so the
+// timeline stays continuous across clock profile switches
+static uint32_t lastCycles = 0;
+static uint32_t lastTick = 0;
+static uint32_t cycleRemainder = 0;
+static uint32_t nowUs = 0;
+
+// Private function prototypes
+static void trace_accumulate(void);
+static uint32_t trace_cyclesToUs(uint32_t cycles);
+
+// Enable the cycle counter (Perf_Init() may not have run yet) and start the clock
+void Si4463Trace_Init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    lastCycles = DWT->CYCCNT;
+    lastTick = HAL_GetTick();
+    cycleRemainder = 0;
+    nowUs = 0;
+    Si4463Trace_Clear();
+}
+
+// Drop all recorded transactions, the clock keeps running
+void Si4463Trace_Clear(void) {
+    head = 0;
+    count = 0;
+    lost = 0;
+}
+
+// Called before SystemCoreClock changes, converts elapsed cycles at the old rate
+void Si4463Trace_ClockChanging(void) {
+    trace_accumulate();
+}
+
+// Record a transaction that started at startCycles and ends now,
+// CTS polling (if any) started at ctsCycles
+void Si4463Trace_Record(SPI_HandleTypeDef *hspi, uint8_t type, uint8_t cmd, uint8_t len, uint8_t resp,
+                        uint32_t startCycles, uint32_t ctsCycles, uint16_t polls) {
+    uint32_t end = DWT->CYCCNT;
+    Si4463Trace_Entry_t *e = &ring[head];
+
+    trace_accumulate();
+
+    e->totalUs = trace_cyclesToUs(end - startCycles);
+    e->ctsUs = polls ? trace_cyclesToUs(end - ctsCycles) : 0;
+    e->timeUs = nowUs - e->totalUs;
+    e->polls = polls;
+    e->cmd = cmd;
+    e->len = len;
+    e->resp = resp;
+    e->type = type;
+    e->bus = (hspi && hspi->Instance == SPI2) ? 2 : 1;
+
+    head = (head + 1) % SI4463_TRACE_DEPTH;
+    if (count < SI4463_TRACE_DEPTH) {
+        count++;
+    } else {
+        lost++;
+    }
+}
+
+uint16_t Si4463Trace_GetCount(void) {
+    return count;
+}
+
+uint32_t Si4463Trace_GetLost(void) {
+    return lost;
+}
+
+const Si4463Trace_Entry_t* Si4463Trace_Get(uint16_t index) {
+    if (index >= count) return NULL;
+    return &ring[(head + SI4463_TRACE_DEPTH - count + index) % SI4463_TRACE_DEPTH];
+}
+
+// Private functions
+static void trace_accumulate(void) {
+    uint32_t cycles = DWT->CYCCNT;
+    uint32_t tick = HAL_GetTick();
+    uint32_t cyclesPerUs = SystemCoreClock / 1000000U;
+    uint32_t elapsed = (cycles - lastCycles) + cycleRemainder;
+    uint32_t us = elapsed / cyclesPerUs;
+
+    cycleRemainder = elapsed - us * cyclesPerUs;
+
+    // the cycle counter wraps within a minute at 72 MHz, a longer quiet
+    // spell is counted in SysTick milliseconds instead
+    if (tick - lastTick > us / 1000 + 1) {
+        us = (tick - lastTick) * 1000;
+        cycleRemainder = 0;
+    }
+
+    lastCycles = cycles;
+    lastTick = tick;
+    nowUs += us;
+}
+
+static uint32_t trace_cyclesToUs(uint32_t cycles) {
+    return cycles / (SystemCoreClock / 1000000U);
+}
+
+#endif // SI4463_TRACE
@@ -0,0 +1,116 @@
+/*
+ * uart_tx.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "uart_tx.h"
+
+static UART_HandleTypeDef *uarttx_huart = NULL;
+
+// head is written by the main loop, tail advances when a chunk has been sent
+static uint8_t ring[UART_TX_RINGLEN];
+static volatile uint16_t head = 0;
+static volatile uint16_t tail = 0;
+static volatile uint16_t sending = 0;   // length of the chunk handed to the HAL
+static volatile bool hold = false;
+static bool txeWasEnabled = false;
+
+// Private function prototypes
+static void uarttx_start(void);
+
+void UartTx_Init(UART_HandleTypeDef *huart) {
+    uarttx_huart = huart;
+    head = tail = sending = 0;
+    hold = false;
+}
+
+void UartTx_Write(const uint8_t *data, uint16_t len) {
+    if (!uarttx_huart) {
+        return;
+    }
+
+    while (len > 0) {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint16_t used = (uint16_t)((head + UART_TX_RINGLEN - tail) % UART_TX_RINGLEN);
+        uint16_t room = UART_TX_RINGLEN - 1 - used;
+        uint16_t n = len < room ? len : room;
+
+        for (uint16_t i = 0; i < n; i++) {
+            ring[head] = *data++;
+            head = (head + 1) % UART_TX_RINGLEN;
+        }
+        len -= n;
+        uarttx_start();
+        __set_PRIMASK(primask);
+
+        if (len > 0) {
+            // the ring only drains from the interrupt, drop the rest if it is masked
+            if (primask) {
+                return;
+            }
+            __WFI();
+        }
+    }
+}
+
+void UartTx_Pause(uint32_t timeoutMs) {
+    if (!uarttx_huart) {
+        return;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    hold = true;
+    txeWasEnabled = __HAL_UART_GET_IT_SOURCE(uarttx_huart, UART_IT_TXE) != RESET;
+    __HAL_UART_DISABLE_IT(uarttx_huart, UART_IT_TXE);
+    __set_PRIMASK(primask);
+
+    uint32_t start = HAL_GetTick();
+    while (__HAL_UART_GET_FLAG(uarttx_huart, UART_FLAG_TC) == RESET) {
+        if (HAL_GetTick() - start > timeoutMs) {
+            break;
+        }
+    }
+}
+
+void UartTx_Resume(void) {
+    if (!uarttx_huart) {
+        return;
+    }
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    hold = false;
+    if (txeWasEnabled) {
+        txeWasEnabled = false;
+        __HAL_UART_ENABLE_IT(uarttx_huart, UART_IT_TXE);
+    }
+    // a chunk that completed during the hold is followed by the next one now
+    uarttx_start();
+    __set_PRIMASK(primask);
+}
+
+void UartTx_TxComplete(UART_HandleTypeDef *huart) {
+    if (huart != uarttx_huart) {
+        return;
+    }
+    tail = (tail + sending) % UART_TX_RINGLEN;
+    sending = 0;
+    uarttx_start();
+}
+
+// Private functions
+// Hand the next contiguous run of the ring to the HAL, interrupts masked or
+// called from the UART interrupt
+static void uarttx_start(void) {
+    if (hold || sending != 0 || head == tail) {
+        return;
+    }
+
+    uint16_t len = head > tail ? head - tail : UART_TX_RINGLEN - tail;
+    if (HAL_UART_Transmit_IT(uarttx_huart, &ring[tail], len) == HAL_OK) {
+        sending = len;
+    }
+}
@@ -0,0 +1,352 @@
+/*
+ * host_main.c
+ *
+ *  Runs the unmodified firmware on Linux. The serial port is either a
+ *  pseudo terminal (connect any terminal program to the printed path) or a
+ *  script of commands fed in one line at a time.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#define _GNU_SOURCE
+#include "host_hal.h"
+#include "si4463_model.h"
+#include "pocsag_decoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// Firmware entry point (main.c is compiled with -Dmain=firmware_main)
+int firmware_main(void);
+
+static const char *scriptPath = NULL;
+static const char *bitstreamPath = NULL;
+static const char *airPath = NULL;
+static bool radio = true;
+static bool radio2 = false;
+static bool decode = false;
+static PocsagDecoder_t decoder;
+static uint8_t decodeUnit = 0;     // radio whose transmission is being decoded
+static FILE *script = NULL;
+static int ptyFd = -1;
+static uint32_t speed = 1;
+static uint32_t idleExitMs = 10000;
+static bool quiet = false;
+static uint64_t scriptWaitUntil = 0;
+static volatile sig_atomic_t stopRequested = 0;
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  --pty               serial port on a pseudo terminal (default)\n"
+            "  --script FILE       feed commands from FILE ('-' for stdin), '#wait <ms>' pauses\n"
+            "  --speed N           in --pty mode, idle time runs N times faster than real time (default 1)\n"
+            "  --deterministic     ignore host CPU time, only modeled time advances\n"
+            "  --cpu-scale N       host CPU time is multiplied by N (default 20)\n"
+            "  --idle-exit-ms N    in --script mode, exit after N ms idle at end of script (default 10000)\n"
+            "  --no-radio          no SI4463 model on SPI1, reads return 0xFF\n"
+            "  --radio2            second SI4463 model on SPI2 for simulcast\n"
+            "  --cts-us N          SI4463 model command execution time (default 25)\n"
+            "  --bitstream FILE    write every transmission as hex to FILE at exit\n"
+            "  --decode            decode every transmission and print the pages found\n"
+            "  --air FILE          put the transmissions of a --bitstream FILE on air for the receiver\n"
+            "  --quiet             do not print the statistics at exit\n",
+            prog);
+}
+
+// One line per transmission: start time, bit rate, length and the bytes sent
+static void writeBitstream(void) {
+    FILE *f;
+
+    if (!bitstreamPath || !(f = fopen(bitstreamPath, "w"))) {
+        return;
+    }
+    for (size_t i = 0; i < Si4463Model_GetTxCount(); i++) {
+        const Si4463Model_Tx_t *tx = Si4463Model_GetTx(i);
+
+        fprintf(f, "%llu %lu %u%s ", (unsigned long long)tx->startUs, (unsigned long)tx->bitRate,
+                tx->len, tx->underflow ? " underflow" : "");
+        for (uint16_t n = 0; n < tx->len; n++) {
+            fprintf(f, "%02X", tx->data[n]);
+        }
+        fputc('\n', f);
+    }
+    fclose(f);
+}
+
+// Put the transmissions recorded by writeBitstream() on air, at their original times
+static bool loadAir(const char *path) {
+    static char line[16384];
+    static uint8_t data[8192];
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long long start;
+        unsigned long rate;
+        unsigned int len;
+        uint16_t n = 0;
+        char *hex = strrchr(line, ' ');
+
+        if (!hex || sscanf(line, "%llu %lu %u", &start, &rate, &len) != 3) {
+            continue;
+        }
+        for (hex++; hex[0] && hex[1] && hex[0] != '\n' && n < sizeof(data); hex += 2) {
+            unsigned int byte;
+            if (sscanf(hex, "%2x", &byte) != 1) break;
+            data[n++] = (uint8_t)byte;
+        }
+        Si4463Model_AddRx(start, (uint32_t)rate, data, n);
+    }
+    fclose(f);
+    return true;
+}
+
+static void printDecoded(void *ctx, const PocsagDecoder_Message_t *msg) {
+    (void)ctx;
+    fprintf(stderr, decodeUnit ? "[air %d] " : "[air] ", decodeUnit + 1);
+    fprintf(stderr, "address %ld function %d%s, %d bit errors corrected: %s\n", msg->address,
+            msg->function, msg->inverted ? " (inverted)" : "", msg->corrected, PocsagDecoder_GetText(msg));
+}
+
+static void decodeTx(const Si4463Model_Tx_t *tx) {
+    decodeUnit = tx->unit;
+    PocsagDecoder_PushBytes(&decoder, tx->data, tx->len);
+    PocsagDecoder_Flush(&decoder);
+}
+
+static void printRadioStats(void) {
+    const Si4463Model_Stats_t *r = Si4463Model_GetStats();
+
+    fprintf(stderr,
+            "[radio] commands %llu (unknown %llu, while busy %llu, before POR %llu, before POWER_UP %llu)\n"
+            "[radio] CTS polls %llu (busy %llu), wait avg %.1f us max %llu us\n"
+            "[radio] FIFO writes %llu (%llu bytes), overflows %llu, underflows %llu\n"
+            "[radio] TX %llu packets, %llu bytes, turnaround avg %.1f us, nIRQ %llu\n"
+            "[radio] RX %llu syncs, %llu packets, %llu bytes (%llu read), overflows %llu\n",
+            (unsigned long long)r->commands, (unsigned long long)r->unknownCommands,
+            (unsigned long long)r->commandsWhileBusy, (unsigned long long)r->commandsBeforePor,
+            (unsigned long long)r->commandsBeforePowerUp,
+            (unsigned long long)r->ctsPolls, (unsigned long long)r->ctsBusyPolls,
+            r->commands ? (double)r->ctsWaitUs / r->commands : 0.0, (unsigned long long)r->ctsWaitMaxUs,
+            (unsigned long long)r->fifoWrites, (unsigned long long)r->fifoBytes,
+            (unsigned long long)r->fifoOverflows, (unsigned long long)r->fifoUnderflows,
+            (unsigned long long)r->txCount, (unsigned long long)r->txBytes,
+            r->txCount ? (double)r->txTurnaroundUs / r->txCount : 0.0,
+            (unsigned long long)r->irqAssertions,
+            (unsigned long long)r->rxSyncs, (unsigned long long)r->rxPackets,
+            (unsigned long long)r->rxBytes, (unsigned long long)r->rxFifoReads,
+            (unsigned long long)r->rxOverflows);
+}
+
+static void printStats(void) {
+    const Host_Stats_t *s = Host_GetStats();
+
+    if (radio) {
+        writeBitstream();
+    }
+    if (quiet) {
+        return;
+    }
+    fprintf(stderr,
+            "\n[host] virtual time %.3f s, idle %.3f s, WFI %llu\n"
+            "[host] UART rx %llu bytes (%llu dropped), tx %llu bytes\n"
+            "[host] SPI %llu bytes, busy %.3f ms\n",
+            Host_NowUs() / 1e6, s->idleUs / 1e6, (unsigned long long)s->wfiCount,
+            (unsigned long long)s->uartRxBytes, (unsigned long long)s->uartRxDropped,
+            (unsigned long long)s->uartTxBytes,
+            (unsigned long long)s->spiBytes, s->spiBusyUs / 1e3);
+    if (radio) {
+        printRadioStats();
+    }
+}
+
+static void onSignal(int sig) {
+    (void)sig;
+    stopRequested = 1;
+}
+
+static void uartOutput(const uint8_t *data, size_t len) {
+    if (ptyFd >= 0) {
+        // nobody may be connected yet, drop output rather than block
+        if (write(ptyFd, data, len) < 0 && errno != EAGAIN && errno != EIO) {
+            perror("pty write");
+        }
+    } else {
+        fwrite(data, 1, len, stdout);
+        fflush(stdout);
+    }
+}
+
+static void openPty(void) {
+    struct termios tio;
+
+    ptyFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (ptyFd < 0 || grantpt(ptyFd) < 0 || unlockpt(ptyFd) < 0) {
+        perror("posix_openpt");
+        exit(1);
+    }
+    if (tcgetattr(ptyFd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(ptyFd, TCSANOW, &tio);
+    }
+    fcntl(ptyFd, F_SETFL, fcntl(ptyFd, F_GETFL) | O_NONBLOCK);
+
+    // keep the slave side open so the master does not report EIO between clients
+    int keep = open(ptsname(ptyFd), O_RDWR | O_NOCTTY);
+    (void)keep;
+    fprintf(stderr, "[host] serial port on %s\n", ptsname(ptyFd));
+}
+
+// Wait a little real time for terminal input while the firmware sleeps
+static void ptyIdle(uint64_t idle_us) {
+    struct pollfd pfd = { ptyFd, POLLIN, 0 };
+    uint8_t buf[256];
+    (void)idle_us;
+
+    if (stopRequested) {
+        exit(0);
+    }
+    if (poll(&pfd, 1, speed > 1 ? 0 : 1) > 0) {
+        ssize_t n = read(ptyFd, buf, sizeof(buf));
+        if (n > 0) {
+            Host_UartInput(buf, (size_t)n);
+            return;
+        }
+    }
+    if (speed > 1) {
+        struct timespec ts = { 0, 1000000L / speed };
+        nanosleep(&ts, NULL);
+    }
+}
+
+// Feed the next script line once the firmware has taken the previous one
+static void scriptIdle(uint64_t idle_us) {
+    char line[256];
+
+    if (stopRequested) {
+        exit(0);
+    }
+    if (Host_UartInputPending() > 0 || Host_NowUs() < scriptWaitUntil) {
+        return;
+    }
+
+    while (script) {
+        if (!fgets(line, sizeof(line), script)) {
+            if (script != stdin) {
+                fclose(script);
+            }
+            script = NULL;
+            break;
+        }
+
+        unsigned long waitMs;
+        if (sscanf(line, "#wait %lu", &waitMs) == 1) {
+            scriptWaitUntil = Host_NowUs() + (uint64_t)waitMs * 1000ULL;
+            return;
+        }
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+
+        size_t len = strcspn(line, "\r\n");
+        line[len++] = '\r';
+        line[len++] = '\n';
+        if (!quiet) {
+            fprintf(stderr, "[host] > %.*s\n", (int)(len - 2), line);
+        }
+        Host_UartInput((const uint8_t *)line, len);
+        return;
+    }
+
+    if (idle_us >= (uint64_t)idleExitMs * 1000ULL) {
+        exit(0);
+    }
+}
+
+int main(int argc, char **argv) {
+    Host_Config_t config = { true, 20 };
+    Si4463Model_Config_t radioConfig = { 6000, 15000, 25, 150, 0, -60, -120 };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--pty") == 0) {
+            scriptPath = NULL;
+        } else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) {
+            scriptPath = argv[++i];
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            speed = (uint32_t)strtoul(argv[++i], NULL, 0);
+            if (speed == 0) speed = 1;
+        } else if (strcmp(argv[i], "--deterministic") == 0) {
+            config.includeCpuTime = false;
+        } else if (strcmp(argv[i], "--cpu-scale") == 0 && i + 1 < argc) {
+            config.cpuScale = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--idle-exit-ms") == 0 && i + 1 < argc) {
+            idleExitMs = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--no-radio") == 0) {
+            radio = false;
+        } else if (strcmp(argv[i], "--radio2") == 0) {
+            radio2 = true;
+        } else if (strcmp(argv[i], "--cts-us") == 0 && i + 1 < argc) {
+            radioConfig.ctsLatencyUs = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--bitstream") == 0 && i + 1 < argc) {
+            bitstreamPath = argv[++i];
+        } else if (strcmp(argv[i], "--air") == 0 && i + 1 < argc) {
+            airPath = argv[++i];
+        } else if (strcmp(argv[i], "--decode") == 0) {
+            decode = true;
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    Host_Init(&config);
+    Host_SetUartOutput(uartOutput);
+    if (radio) {
+        // wiring as in main.c: SPI1, SDN on PB0, nIRQ on PB1, nSEL on PB10
+        Si4463Model_Init(&radioConfig);
+        Si4463Model_Attach(SPI1, GPIOB, GPIO_PIN_10, GPIOB, GPIO_PIN_0, GPIOB, GPIO_PIN_1);
+        // direct mode TX data on PA8
+        Si4463Model_AttachTxData(0, GPIOA, GPIO_PIN_8);
+        if (radio2) {
+            // second radio: SPI2, SDN on PB11, nIRQ on PA4, nSEL on PB12
+            Si4463Model_Attach(SPI2, GPIOB, GPIO_PIN_12, GPIOB, GPIO_PIN_11, GPIOA, GPIO_PIN_4);
+        }
+        if (decode) {
+            PocsagDecoder_Init(&decoder, printDecoded, NULL);
+            Si4463Model_SetTxHook(decodeTx);
+        }
+        if (airPath && !loadAir(airPath)) {
+            return 1;
+        }
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    atexit(printStats);
+
+    if (scriptPath) {
+        script = strcmp(scriptPath, "-") == 0 ? stdin : fopen(scriptPath, "r");
+        if (!script) {
+            perror(scriptPath);
+            return 1;
+        }
+        Host_SetIdleHook(scriptIdle);
+    } else {
+        openPty();
+        Host_SetIdleHook(ptyIdle);
+    }
+
+    return firmware_main();
+}
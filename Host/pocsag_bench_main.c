@@ -0,0 +1,73 @@
+/*
+ * pocsag_bench_main.c
+ *
+ *  Native run of the encoder benchmark in Core/Src/pocsag_bench.c, timed
+ *  with the monotonic clock. Compare with the B command on the target.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "pocsag_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+uint32_t PocsagBench_GetTicks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+uint32_t PocsagBench_GetTickRate(void) {
+    return 1000000000U;
+}
+
+int main(int argc, char **argv) {
+    uint32_t pages = 100000;
+    uint32_t seed = 1;
+    bool byLength = false;
+    static PocsagBench_Result_t result;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--pages") == 0 && i + 1 < argc) {
+            pages = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--by-length") == 0) {
+            byLength = true;
+        } else {
+            fprintf(stderr, "Usage: %s [--pages N] [--seed S] [--by-length]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    printf("mix          pages   ns/page      min      max   codewords/s  stack\n");
+    for (int m = 0; m < PocsagBench_MixCount; m++) {
+        const PocsagBench_Mix_t *mix = &PocsagBench_Mixes[m];
+        uint32_t n = pages;
+
+        // a sweep always covers every combination the same number of times
+        if (mix->sweep) {
+            n = (pages + POCSAG_BENCH_SWEEP - 1) / POCSAG_BENCH_SWEEP * POCSAG_BENCH_SWEEP;
+        }
+        PocsagBench_Run(mix, n, seed, &result);
+
+        double seconds = (double)result.ticks / PocsagBench_GetTickRate();
+        printf("%-10s %7lu %9.1f %8lu %8lu %13.0f %6lu\n", mix->name, (unsigned long)result.pages,
+               (double)result.ticks / result.pages, (unsigned long)result.minTicks,
+               (unsigned long)result.maxTicks, seconds > 0 ? result.codewords / seconds : 0.0,
+               (unsigned long)result.stackBytes);
+
+        if (byLength && mix->sweep) {
+            printf("  length  ns/page\n");
+            for (int l = 0; l <= POCSAG_BENCH_MAXLEN; l++) {
+                if (result.lenPages[l]) {
+                    printf("  %6d %8.1f\n", l, (double)result.lenTicks[l] / result.lenPages[l]);
+                }
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ * pocsag_canned.c
+ *
+ *  Build-time encoder for canned messages: reads a list of pages
+ *  (ADDRESS SOURCE TEXT per line) and writes a C file with each page
+ *  fully encoded into a const table, so the firmware sends them from
+ *  flash with the N command and never encodes them at runtime. Pages
+ *  are encoded with Pocsag_Encode() in normal polarity, the preamble is
+ *  left to the CANNED_PREAMBLE macro of canned.h.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "Pocsag.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_MESSAGES 100
+
+typedef struct {
+    FILE *out;
+    int skip;           // preamble words still to drop
+    int words;
+} Table_t;
+
+// Private function prototypes
+static bool canned_codeword(void *ctx, uint32_t codeword);
+static void canned_string(FILE *out, const char *text);
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s LIST OUTPUT\n"
+            "LIST holds one page per line, ADDRESS SOURCE TEXT, '#' starts a comment.\n"
+            "OUTPUT is the C file with the encoded pages, Core/Src/canned.c for the firmware.\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    static char line[256];
+    long addresses[MAX_MESSAGES];
+    int sources[MAX_MESSAGES];
+    static char texts[MAX_MESSAGES][41];
+    int count = 0;
+    int lineNo = 0;
+    FILE *in, *out;
+
+    if (argc != 3) {
+        usage(argv[0]);
+        return 2;
+    }
+    in = fopen(argv[1], "r");
+    if (!in) {
+        perror(argv[1]);
+        return 1;
+    }
+    out = fopen(argv[2], "wb");
+    if (!out) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    // the rest of Core uses CRLF line endings
+    fprintf(out, "/*\r\n"
+                 " * canned.c\r\n"
+                 " *\r\n"
+                 " *  Generated by pocsag_canned from canned.txt, do not edit. After\r\n"
+                 " *  changing the list run:\r\n"
+                 " *  ./build/pocsag_canned Core/Src/canned.txt Core/Src/canned.c\r\n"
+                 " */\r\n"
+                 "#include \"canned.h\"\r\n");
+
+    while (fgets(line, sizeof(line), in)) {
+        char *p = line;
+        char *end;
+        long address;
+        int source, error;
+        Table_t table = {out, POCSAG_MSG_PREAMBLE / 4, 0};
+
+        lineNo++;
+        line[strcspn(line, "\r\n")] = '\0';
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0' || *p == '#') {
+            continue;
+        }
+
+        address = strtol(p, &end, 0);
+        if (end == p) {
+            fprintf(stderr, "%s:%d: expected ADDRESS SOURCE TEXT\n", argv[1], lineNo);
+            return 1;
+        }
+        source = (int)strtol(end, &p, 0);
+        if (p == end || (*p != ' ' && *p != '\t' && *p != '\0')) {
+            fprintf(stderr, "%s:%d: expected ADDRESS SOURCE TEXT\n", argv[1], lineNo);
+            return 1;
+        }
+        if (*p != '\0') p++;
+        if (strlen(p) > 40) {
+            fprintf(stderr, "%s:%d: text longer than 40 characters\n", argv[1], lineNo);
+            return 1;
+        }
+        if (count >= MAX_MESSAGES) {
+            fprintf(stderr, "%s:%d: more than %d messages\n", argv[1], lineNo, MAX_MESSAGES);
+            return 1;
+        }
+
+        fprintf(out, "\r\nstatic const uint8_t canned%d[] = {\r\n    CANNED_PREAMBLE", count);
+        if (Pocsag_Encode(address, source, p, 0, 0, canned_codeword, &table, &error) != POCSAG_SUCCESS) {
+            fprintf(stderr, "%s:%d: invalid page, encoder error %d\n", argv[1], lineNo, error);
+            return 1;
+        }
+        fprintf(out, "\r\n};\r\n");
+
+        addresses[count] = address;
+        sources[count] = source;
+        strcpy(texts[count], p);
+        count++;
+    }
+    fclose(in);
+
+    fprintf(out, "\r\nstatic const Canned_t cannedMessages[] = {\r\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(out, "    {%ld, %d, ", addresses[i], sources[i]);
+        canned_string(out, texts[i]);
+        fprintf(out, ", canned%d, sizeof(canned%d)},\r\n", i, i);
+    }
+    if (count == 0) {
+        fprintf(out, "    {0, 0, \"\", NULL, 0},\r\n");
+    }
+    fprintf(out, "};\r\n"
+                 "\r\n"
+                 "int Canned_GetCount(void) {\r\n"
+                 "    return %d;\r\n"
+                 "}\r\n"
+                 "\r\n"
+                 "// Get a canned message, NULL for an unknown number\r\n"
+                 "const Canned_t* Canned_Get(int number) {\r\n"
+                 "    if (number < 0 || number >= Canned_GetCount()) return NULL;\r\n"
+                 "    return &cannedMessages[number];\r\n"
+                 "}\r\n", count);
+
+    if (fclose(out) != 0) {
+        perror(argv[2]);
+        return 1;
+    }
+    fprintf(stderr, "%d canned message(s) written to %s\n", count, argv[2]);
+    return 0;
+}
+
+// Pocsag_Encode() sink: one line per sync codeword, 16 frame codewords per batch
+static bool canned_codeword(void *ctx, uint32_t codeword) {
+    Table_t *table = ctx;
+
+    if (table->skip > 0) {
+        table->skip--;
+        return true;
+    }
+    if (table->words % 17 == 0) {
+        fprintf(table->out, "\r\n   ");
+    } else if (table->words % 17 % 4 == 1) {
+        fprintf(table->out, "\r\n       ");
+    }
+    fprintf(table->out, " 0x%02X, 0x%02X, 0x%02X, 0x%02X,", (unsigned)(codeword >> 24),
+            (unsigned)(codeword >> 16) & 0xFF, (unsigned)(codeword >> 8) & 0xFF, (unsigned)codeword & 0xFF);
+    table->words++;
+    return true;
+}
+
+// C string literal, quotes, backslashes and non-printable characters escaped
+static void canned_string(FILE *out, const char *text) {
+    fputc('"', out);
+    for (const unsigned char *c = (const unsigned char *)text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(out, "\\%c", *c);
+        } else if (*c < 0x20 || *c >= 0x7F) {
+            fprintf(out, "\\%03o", *c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
@@ -0,0 +1,170 @@
+/*
+ * pocsag_directory.c
+ *
+ *  Build the subscriber directory: reads the pager list (ALIAS ADDRESS
+ *  SOURCE TYPE BAUD per line), checks it and writes the table of
+ *  directory.h sorted by alias, so the firmware finds an alias with a
+ *  binary search. Aliases are stored in lower case and must be unique.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "directory.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ENTRIES 1000
+
+typedef struct {
+    char alias[DIRECTORY_ALIAS_MAX + 1];
+    long address;
+    int source;
+    bool numeric;
+    unsigned baud;
+    int line;
+} Entry_t;
+
+static Entry_t entries[MAX_ENTRIES];
+
+// Private function prototypes
+static int directory_sort(const void *a, const void *b);
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s LIST OUTPUT\n"
+            "LIST holds one pager per line, ALIAS ADDRESS SOURCE TYPE(A|N) BAUD(512|1200),\n"
+            "'#' starts a comment. OUTPUT is Core/Inc/directory_table.h for the firmware.\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    static char line[256];
+    int count = 0;
+    int lineNo = 0;
+    FILE *in, *out;
+
+    if (argc != 3) {
+        usage(argv[0]);
+        return 2;
+    }
+    in = fopen(argv[1], "r");
+    if (!in) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    while (fgets(line, sizeof(line), in)) {
+        char alias[64], type[8], extra[2];
+        Entry_t *e = &entries[count];
+        char *p = line;
+
+        lineNo++;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '\0' || *p == '\r' || *p == '\n' || *p == '#') {
+            continue;
+        }
+        if (count >= MAX_ENTRIES) {
+            fprintf(stderr, "%s:%d: more than %d entries\n", argv[1], lineNo, MAX_ENTRIES);
+            return 1;
+        }
+        if (sscanf(p, "%63s %ld %d %7s %u %1s", alias, &e->address, &e->source, type, &e->baud, extra) != 5) {
+            fprintf(stderr, "%s:%d: expected ALIAS ADDRESS SOURCE TYPE BAUD\n", argv[1], lineNo);
+            return 1;
+        }
+
+        if (strlen(alias) > DIRECTORY_ALIAS_MAX) {
+            fprintf(stderr, "%s:%d: alias longer than %d characters\n", argv[1], lineNo, DIRECTORY_ALIAS_MAX);
+            return 1;
+        }
+        for (char *c = alias; *c; c++) {
+            if (!isalnum((unsigned char)*c) && *c != '_' && *c != '-' && *c != '.') {
+                fprintf(stderr, "%s:%d: invalid character '%c' in alias\n", argv[1], lineNo, *c);
+                return 1;
+            }
+            *c = (char)tolower((unsigned char)*c);
+        }
+        strcpy(e->alias, alias);
+
+        // the checks of Pocsag_CreatePocsag and Si4463_SetPOCSAGDataRate
+        if (e->address <= 0 || e->address > 0x1FFFFF) {
+            fprintf(stderr, "%s:%d: address out of range 1-2097151\n", argv[1], lineNo);
+            return 1;
+        }
+        if (e->source < 0 || e->source > 3) {
+            fprintf(stderr, "%s:%d: source out of range 0-3\n", argv[1], lineNo);
+            return 1;
+        }
+        if (strcmp(type, "A") && strcmp(type, "a") && strcmp(type, "N") && strcmp(type, "n")) {
+            fprintf(stderr, "%s:%d: type must be A (alphanumeric) or N (numeric)\n", argv[1], lineNo);
+            return 1;
+        }
+        e->numeric = (type[0] == 'N' || type[0] == 'n');
+        if (e->baud != 512 && e->baud != 1200) {
+            fprintf(stderr, "%s:%d: baud must be 512 or 1200\n", argv[1], lineNo);
+            return 1;
+        }
+        e->line = lineNo;
+        count++;
+    }
+    fclose(in);
+
+    qsort(entries, count, sizeof(Entry_t), directory_sort);
+    for (int i = 1; i < count; i++) {
+        if (strcmp(entries[i - 1].alias, entries[i].alias) == 0) {
+            fprintf(stderr, "%s:%d: alias \"%s\" already used on line %d\n", argv[1],
+                    entries[i].line, entries[i].alias, entries[i - 1].line);
+            return 1;
+        }
+    }
+
+    out = fopen(argv[2], "wb");
+    if (!out) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    // the rest of Core uses CRLF line endings
+    fprintf(out, "/*\r\n"
+                 " * directory_table.h\r\n"
+                 " *\r\n"
+                 " *  Generated by pocsag_directory from directory.txt, do not edit. After\r\n"
+                 " *  changing the list run:\r\n"
+                 " *  ./build/pocsag_directory Core/Src/directory.txt Core/Inc/directory_table.h\r\n"
+                 " */\r\n"
+                 "\r\n"
+                 "#ifndef DIRECTORY_TABLE_H\r\n"
+                 "#define DIRECTORY_TABLE_H\r\n"
+                 "\r\n"
+                 "#include \"directory.h\"\r\n"
+                 "\r\n"
+                 "#define DIRECTORY_TABLE_SIZE %d\r\n"
+                 "\r\n"
+                 "// Sorted by alias for Directory_Find()\r\n"
+                 "static const Directory_Entry_t directoryTable[] = {\r\n", count);
+    for (int i = 0; i < count; i++) {
+        const Entry_t *e = &entries[i];
+
+        fprintf(out, "    {\"%s\", %ld, %d, %s, %u},\r\n", e->alias, e->address, e->source,
+                e->numeric ? "true" : "false", e->baud);
+    }
+    if (count == 0) {
+        fprintf(out, "    {\"\", 0, 0, false, 1200},\r\n");
+    }
+    fprintf(out, "};\r\n"
+                 "\r\n"
+                 "#endif // DIRECTORY_TABLE_H\r\n");
+
+    if (fclose(out) != 0) {
+        perror(argv[2]);
+        return 1;
+    }
+    fprintf(stderr, "%d entries written to %s\n", count, argv[2]);
+    return 0;
+}
+
+// Byte order of the lower case aliases, as Directory_Find() compares them
+static int directory_sort(const void *a, const void *b) {
+    return strcmp(((const Entry_t *)a)->alias, ((const Entry_t *)b)->alias);
+}
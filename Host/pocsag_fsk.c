@@ -0,0 +1,442 @@
+/*
+ * pocsag_fsk.c
+ *
+ *  Render POCSAG pages as a 2-FSK baseband recording for SDR tools:
+ *  stereo I/Q WAV, raw complex float (cf32) or the FM-demodulated NRZ audio
+ *  that decoders such as multimon-ng read. Pages are encoded like main.c
+ *  does, each codeword rendered as Pocsag_Encode() produces it, or taken
+ *  from a pocsag_host --bitstream file. Like the SI4463, a 1 bit is sent
+ *  as +deviation.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "Pocsag.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BLOCK_SAMPLES 65536
+#define AMPLITUDE     0.5f      // leaves headroom for --snr noise
+
+typedef enum {
+    FORMAT_WAV,     // stereo 16 bit I/Q WAV
+    FORMAT_CF32,    // raw interleaved float I/Q
+    FORMAT_AUDIO    // mono 16 bit WAV of the demodulated signal
+} Format_t;
+
+typedef struct {
+    FILE *f;
+    Format_t format;
+    uint32_t rate;
+    double deviation;
+    bool modemInvert;
+    double noise;               // noise amplitude per component, 0 = none
+
+    // NCO: samples of one bit are rot * step^k, step depends on the bit value
+    uint32_t tableBaud;
+    int tableLen;
+    float *stepRe[2], *stepIm[2];
+    double rotRe, rotIm;
+
+    // sample clock: bit n of the current burst ends at sample (n + 1) * rate / baud
+    uint64_t burstBits;
+    uint64_t burstSamples;
+
+    float re[BLOCK_SAMPLES], im[BLOCK_SAMPLES];
+    int fill;
+    uint64_t samples;
+    uint32_t rng;
+} Render_t;
+
+static Render_t r;
+
+// Private function prototypes
+static void render_flush(void);
+static void render_tables(uint32_t baud);
+static void render_begin(uint32_t baud);
+static void render_data(const uint8_t *data, int len);
+static void render_bytes(const uint8_t *data, int len, uint32_t baud);
+static bool render_codeword(void *ctx, uint32_t codeword);
+static void render_silence(uint32_t ms);
+static void render_header(void);
+static float render_gauss(void);
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options] -o FILE\n"
+            "  --page ADDR:SRC:TEXT  encode a page (repeatable)\n"
+            "  --random N            N random pages (soak test)\n"
+            "  --bitstream FILE      render the transmissions of a pocsag_host --bitstream file\n"
+            "  --format wav|cf32|audio  I/Q WAV (default), raw float I/Q, or demodulated audio WAV\n"
+            "  --rate HZ             sample rate (default 48000)\n"
+            "  --baud N              512 or 1200 (default 1200, bitstream files carry their own)\n"
+            "  --deviation HZ        FSK deviation (default 4500, as Si4463_ConfigureForPOCSAG)\n"
+            "  --gap MS              carrier off between pages (default 1000)\n"
+            "  --no-invert           encode with option_invert 0 (main.c uses 1)\n"
+            "  --modem-invert        send a 1 bit as -deviation\n"
+            "  --snr DB              add white Gaussian noise\n"
+            "  --seed S              random seed for --random and --snr\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    const char *outPath = NULL;
+    const char *bitstreamPath = NULL;
+    const char *pages[64];
+    int pageCount = 0;
+    long randomPages = 0;
+    uint32_t baud = 1200;
+    uint32_t gapMs = 1000;
+    int invert = 1;
+    double snr = INFINITY;
+    uint64_t pagesRendered = 0;
+
+    r.format = FORMAT_WAV;
+    r.rate = 48000;
+    r.deviation = 4500;
+    r.rng = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(a, "-o") == 0 && v) {
+            outPath = argv[++i];
+        } else if (strcmp(a, "--page") == 0 && v && pageCount < 64) {
+            pages[pageCount++] = argv[++i];
+        } else if (strcmp(a, "--random") == 0 && v) {
+            randomPages = strtol(argv[++i], NULL, 0);
+        } else if (strcmp(a, "--bitstream") == 0 && v) {
+            bitstreamPath = argv[++i];
+        } else if (strcmp(a, "--format") == 0 && v) {
+            i++;
+            if (strcmp(v, "wav") == 0) r.format = FORMAT_WAV;
+            else if (strcmp(v, "cf32") == 0) r.format = FORMAT_CF32;
+            else if (strcmp(v, "audio") == 0) r.format = FORMAT_AUDIO;
+            else { usage(argv[0]); return 2; }
+        } else if (strcmp(a, "--rate") == 0 && v) {
+            r.rate = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(a, "--baud") == 0 && v) {
+            baud = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(a, "--deviation") == 0 && v) {
+            r.deviation = atof(argv[++i]);
+        } else if (strcmp(a, "--gap") == 0 && v) {
+            gapMs = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(a, "--no-invert") == 0) {
+            invert = 0;
+        } else if (strcmp(a, "--modem-invert") == 0) {
+            r.modemInvert = true;
+        } else if (strcmp(a, "--snr") == 0 && v) {
+            snr = atof(argv[++i]);
+        } else if (strcmp(a, "--seed") == 0 && v) {
+            r.rng = (uint32_t)strtoul(argv[++i], NULL, 0);
+            if (r.rng == 0) r.rng = 1;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!outPath || r.rate == 0 || baud == 0 || (pageCount == 0 && randomPages == 0 && !bitstreamPath)) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (2.0 * r.deviation >= r.rate) {
+        fprintf(stderr, "sample rate too low for %.0f Hz deviation\n", r.deviation);
+        return 2;
+    }
+    if (isfinite(snr)) {
+        // SNR over the sample bandwidth, signal power AMPLITUDE^2
+        r.noise = AMPLITUDE / sqrt(2.0 * pow(10.0, snr / 10.0));
+    }
+
+    r.f = fopen(outPath, "wb");
+    if (!r.f) {
+        perror(outPath);
+        return 1;
+    }
+    render_header();
+
+    clock_t start = clock();
+
+    for (int p = 0; p < pageCount; p++) {
+        long address;
+        int source;
+        char text[48] = "";
+
+        if (sscanf(pages[p], "%ld:%d:%40[^\n]", &address, &source, text) < 2) {
+            fprintf(stderr, "invalid page \"%s\"\n", pages[p]);
+            return 1;
+        }
+        render_begin(baud);
+        if (Pocsag_Encode(address, source, text, 0, invert, render_codeword, NULL, NULL) != POCSAG_SUCCESS) {
+            fprintf(stderr, "invalid page \"%s\"\n", pages[p]);
+            return 1;
+        }
+        render_silence(gapMs);
+        pagesRendered++;
+    }
+
+    for (long p = 0; p < randomPages; p++) {
+        char text[48];
+        int len = r.rng % 41;
+
+        // xorshift32, shared with the noise generator
+        for (int c = 0; c <= len; c++) {
+            r.rng ^= r.rng << 13; r.rng ^= r.rng >> 17; r.rng ^= r.rng << 5;
+            text[c] = (char)(0x20 + r.rng % 95);
+        }
+        text[len] = '\0';
+        long address = 1 + r.rng % 0x1FFFFF;
+
+        render_begin(baud);
+        Pocsag_Encode(address, (r.rng >> 24) % 4, text, 0, invert, render_codeword, NULL, NULL);
+        render_silence(gapMs);
+        pagesRendered++;
+    }
+
+    if (bitstreamPath) {
+        static char line[8192];
+        static uint8_t data[4096];
+        FILE *in = fopen(bitstreamPath, "r");
+
+        if (!in) {
+            perror(bitstreamPath);
+            return 1;
+        }
+        while (fgets(line, sizeof(line), in)) {
+            unsigned long long startUs;
+            unsigned long lineBaud;
+            char *hex = strrchr(line, ' ');
+            int len = 0;
+
+            if (!hex || sscanf(line, "%llu %lu", &startUs, &lineBaud) != 2) continue;
+            for (hex++; len < (int)sizeof(data) && sscanf(hex, "%2hhx", &data[len]) == 1; hex += 2) {
+                len++;
+            }
+            render_bytes(data, len, lineBaud ? lineBaud : baud);
+            render_silence(gapMs);
+            pagesRendered++;
+        }
+        fclose(in);
+    }
+
+    render_flush();
+    render_header();
+    fclose(r.f);
+
+    double cpu = (double)(clock() - start) / CLOCKS_PER_SEC;
+    double seconds = (double)r.samples / r.rate;
+    fprintf(stderr, "%llu pages, %.1f s of signal (%llu samples) rendered in %.2f s (%.0fx real time)\n",
+            (unsigned long long)pagesRendered, seconds, (unsigned long long)r.samples, cpu,
+            cpu > 0 ? seconds / cpu : 0.0);
+    return 0;
+}
+
+// Precompute step^k for both tones: one complex multiply per sample
+static void render_tables(uint32_t baud) {
+    int len = (int)(r.rate / baud) + 2;
+
+    if (baud == r.tableBaud) return;
+
+    for (int t = 0; t < 2; t++) {
+        double freq = (t ? 1 : -1) * (r.modemInvert ? -1 : 1) * r.deviation;
+        double w = 2.0 * M_PI * freq / r.rate;
+
+        free(r.stepRe[t]);
+        free(r.stepIm[t]);
+        r.stepRe[t] = malloc(len * sizeof(float));
+        r.stepIm[t] = malloc(len * sizeof(float));
+        for (int k = 0; k < len; k++) {
+            r.stepRe[t][k] = (float)cos(w * k);
+            r.stepIm[t][k] = (float)sin(w * k);
+        }
+    }
+    r.tableBaud = baud;
+    r.tableLen = len;
+}
+
+// Start a burst at the given rate
+static void render_begin(uint32_t baud) {
+    render_tables(baud);
+    r.rotRe = AMPLITUDE;
+    r.rotIm = 0;
+    r.burstBits = 0;
+    r.burstSamples = 0;
+}
+
+// One burst: the bytes go out most significant bit first, phase continuous
+static void render_bytes(const uint8_t *data, int len, uint32_t baud) {
+    render_begin(baud);
+    render_data(data, len);
+}
+
+// Pocsag_Encode() sink, continues the burst opened by render_begin()
+static bool render_codeword(void *ctx, uint32_t codeword) {
+    uint8_t data[4] = {codeword >> 24, codeword >> 16, codeword >> 8, codeword};
+
+    (void)ctx;
+    render_data(data, 4);
+    return true;
+}
+
+// Continue the burst, phase continuous
+static void render_data(const uint8_t *data, int len) {
+    uint32_t baud = r.tableBaud;
+
+    for (int i = 0; i < len; i++) {
+        for (int b = 7; b >= 0; b--) {
+            int bit = (data[i] >> b) & 1;
+            uint64_t end = (r.burstBits + 1) * r.rate / baud;
+            int n = (int)(end - r.burstSamples);
+            const float *sr = r.stepRe[bit], *si = r.stepIm[bit];
+            float cr = (float)r.rotRe, ci = (float)r.rotIm;
+
+            while (n > 0) {
+                int chunk = BLOCK_SAMPLES - r.fill;
+                if (chunk > n) chunk = n;
+
+                float *outRe = r.re + r.fill, *outIm = r.im + r.fill;
+                int offset = (int)(end - r.burstSamples) - n;
+                if (r.format == FORMAT_AUDIO) {
+                    float level = (bit ^ r.modemInvert) ? AMPLITUDE : -AMPLITUDE;
+                    for (int k = 0; k < chunk; k++) {
+                        outRe[k] = level;
+                    }
+                } else {
+                    // independent iterations, the compiler vectorizes this loop
+                    for (int k = 0; k < chunk; k++) {
+                        outRe[k] = cr * sr[offset + k] - ci * si[offset + k];
+                        outIm[k] = cr * si[offset + k] + ci * sr[offset + k];
+                    }
+                }
+                r.fill += chunk;
+                n -= chunk;
+                if (r.fill == BLOCK_SAMPLES) render_flush();
+            }
+
+            // advance the phase by the whole bit and keep the amplitude exact
+            int total = (int)(end - r.burstSamples);
+            double nr = r.rotRe * sr[total] - r.rotIm * si[total];
+            double ni = r.rotRe * si[total] + r.rotIm * sr[total];
+            double mag = sqrt(nr * nr + ni * ni) / AMPLITUDE;
+            r.rotRe = nr / mag;
+            r.rotIm = ni / mag;
+
+            r.burstSamples = end;
+            r.burstBits++;
+        }
+    }
+}
+
+// Carrier off
+static void render_silence(uint32_t ms) {
+    uint64_t n = (uint64_t)r.rate * ms / 1000;
+
+    while (n > 0) {
+        int chunk = BLOCK_SAMPLES - r.fill;
+        if ((uint64_t)chunk > n) chunk = (int)n;
+        memset(r.re + r.fill, 0, chunk * sizeof(float));
+        memset(r.im + r.fill, 0, chunk * sizeof(float));
+        r.fill += chunk;
+        n -= chunk;
+        if (r.fill == BLOCK_SAMPLES) render_flush();
+    }
+}
+
+static void render_flush(void) {
+    static int16_t pcm[2 * BLOCK_SAMPLES];
+    static float iq[2 * BLOCK_SAMPLES];
+
+    if (r.noise > 0) {
+        for (int k = 0; k < r.fill; k++) {
+            r.re[k] += (float)(r.noise * render_gauss());
+            r.im[k] += (float)(r.noise * render_gauss());
+        }
+    }
+
+    switch (r.format) {
+    case FORMAT_WAV:
+        for (int k = 0; k < r.fill; k++) {
+            float i = r.re[k] > 1.0f ? 1.0f : (r.re[k] < -1.0f ? -1.0f : r.re[k]);
+            float q = r.im[k] > 1.0f ? 1.0f : (r.im[k] < -1.0f ? -1.0f : r.im[k]);
+            pcm[2 * k] = (int16_t)(i * 32767.0f);
+            pcm[2 * k + 1] = (int16_t)(q * 32767.0f);
+        }
+        fwrite(pcm, sizeof(int16_t), 2 * r.fill, r.f);
+        break;
+    case FORMAT_CF32:
+        for (int k = 0; k < r.fill; k++) {
+            iq[2 * k] = r.re[k];
+            iq[2 * k + 1] = r.im[k];
+        }
+        fwrite(iq, sizeof(float), 2 * r.fill, r.f);
+        break;
+    case FORMAT_AUDIO:
+        for (int k = 0; k < r.fill; k++) {
+            float a = r.re[k] > 1.0f ? 1.0f : (r.re[k] < -1.0f ? -1.0f : r.re[k]);
+            pcm[k] = (int16_t)(a * 32767.0f);
+        }
+        fwrite(pcm, sizeof(int16_t), r.fill, r.f);
+        break;
+    }
+
+    r.samples += r.fill;
+    r.fill = 0;
+}
+
+static void put16(uint8_t *p, uint16_t v) { p[0] = v & 0xFF; p[1] = v >> 8; }
+static void put32(uint8_t *p, uint32_t v) { put16(p, v & 0xFFFF); put16(p + 2, v >> 16); }
+
+// Written before the data and again with the final sizes at the end
+static void render_header(void) {
+    uint8_t h[44];
+    uint16_t channels = r.format == FORMAT_AUDIO ? 1 : 2;
+    uint64_t bytes = r.samples * channels * 2;
+
+    if (r.format == FORMAT_CF32) return;
+    if (bytes > 0xFFFFFFFFULL - 36) {
+        fprintf(stderr, "warning: WAV limited to 4 GB, header sizes are truncated\n");
+        bytes = 0xFFFFFFFFULL - 36;
+    }
+
+    memcpy(h, "RIFF", 4);
+    put32(h + 4, (uint32_t)(36 + bytes));
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put32(h + 16, 16);
+    put16(h + 20, 1);                           // PCM
+    put16(h + 22, channels);
+    put32(h + 24, r.rate);
+    put32(h + 28, r.rate * channels * 2);
+    put16(h + 32, channels * 2);
+    put16(h + 34, 16);
+    memcpy(h + 36, "data", 4);
+    put32(h + 40, (uint32_t)bytes);
+
+    fseek(r.f, 0, SEEK_SET);
+    fwrite(h, 1, sizeof(h), r.f);
+    fseek(r.f, 0, SEEK_END);
+}
+
+// Box-Muller on xorshift32
+static float render_gauss(void) {
+    static bool have = false;
+    static float spare;
+    double u, v;
+
+    if (have) {
+        have = false;
+        return spare;
+    }
+    r.rng ^= r.rng << 13; r.rng ^= r.rng >> 17; r.rng ^= r.rng << 5;
+    u = (r.rng + 1.0) / 4294967297.0;
+    r.rng ^= r.rng << 13; r.rng ^= r.rng >> 17; r.rng ^= r.rng << 5;
+    v = (r.rng + 1.0) / 4294967297.0;
+
+    double m = sqrt(-2.0 * log(u));
+    spare = (float)(m * sin(2.0 * M_PI * v));
+    have = true;
+    return (float)(m * cos(2.0 * M_PI * v));
+}
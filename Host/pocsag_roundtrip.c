@@ -0,0 +1,280 @@
+/*
+ * pocsag_roundtrip.c
+ *
+ *  Encode random pages with Pocsag_CreatePocsag(), optionally flip bits in
+ *  every codeword, decode them again and compare. Reports round-trips per
+ *  second and exits non-zero on the first mismatch. With --decode it prints
+ *  the pages found in a --bitstream file written by pocsag_host. Each page
+ *  is also encoded through Pocsag_Encode() and its codewords checked
+ *  against the buffer. --numeric sends digits to numeric pagers instead.
+ *  Complete pages must also be recognized as numeric or text, the way the
+ *  channel monitor prints them.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "Pocsag.h"
+#include "pocsag_decoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Offsets of the batches in the encoder output
+#define BATCH1_OFFSET 76
+#define BATCH2_OFFSET 144
+
+#define POCSAG_IDLE_CW 0x7A89C197UL
+
+// Pages the decoder may take for the wrong type (numeric or text)
+#define MAX_MISREAD_PPM 100
+
+typedef struct {
+    int count;
+    PocsagDecoder_Message_t msgs[4];
+} Received_t;
+
+// Pocsag_Encode() output compared with the Pocsag_CreatePocsag() buffer
+typedef struct {
+    const uint8_t *data;
+    int size;
+    int pos;
+} SinkCheck_t;
+
+static uint32_t rngState = 1;
+
+static uint32_t rng(void) {
+    // xorshift32
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void collect(void *ctx, const PocsagDecoder_Message_t *msg) {
+    Received_t *rx = ctx;
+
+    if (rx->count < 4) {
+        rx->msgs[rx->count] = *msg;
+    }
+    rx->count++;
+}
+
+static bool checkSink(void *ctx, uint32_t codeword) {
+    SinkCheck_t *check = ctx;
+    const uint8_t *p = check->data + check->pos;
+
+    if (check->pos + 4 > check->size ||
+        codeword != ((uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3])) {
+        return false;
+    }
+    check->pos += 4;
+    return true;
+}
+
+static void printMessage(void *ctx, const PocsagDecoder_Message_t *msg) {
+    (void)ctx;
+    printf("address %ld function %d%s corrected %d dropped %d: %s\n", msg->address, msg->function,
+           msg->inverted ? " inverted" : "", msg->corrected, msg->uncorrectable, PocsagDecoder_GetText(msg));
+}
+
+// Flip "errors" distinct random bits in each of the 16 codewords of a batch
+static void injectErrors(uint8_t *batch, int errors) {
+    for (int cw = 0; cw < 16; cw++) {
+        int first = -1;
+        for (int e = 0; e < errors; e++) {
+            int bit;
+            do {
+                bit = rng() % 32;
+            } while (bit == first);
+            first = bit;
+            batch[cw * 4 + bit / 8] ^= 0x80 >> (bit % 8);
+        }
+    }
+}
+
+// Decode the lines of a pocsag_host --bitstream file
+static int decodeFile(const char *path) {
+    static char line[8192];
+    PocsagDecoder_t dec;
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    PocsagDecoder_Init(&dec, printMessage, NULL);
+    while (fgets(line, sizeof(line), f)) {
+        char *hex = strrchr(line, ' ');
+        if (!hex) continue;
+
+        for (hex++; hex[0] && hex[1] && hex[0] != '\n'; hex += 2) {
+            unsigned int byte;
+            if (sscanf(hex, "%2x", &byte) != 1) break;
+            uint8_t b = (uint8_t)byte;
+            PocsagDecoder_PushBytes(&dec, &b, 1);
+        }
+        PocsagDecoder_Flush(&dec);
+    }
+    fclose(f);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    long count = 1000000;
+    int errors = 0;
+    long failures = 0;
+    long misread = 0;
+    bool numeric = false;
+    double encodeTime = 0, decodeTime = 0;
+    uint64_t bits = 0;
+    static Pocsag_t pocsag;
+    static PocsagDecoder_t dec;
+    Received_t rx;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = strtol(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--errors") == 0 && i + 1 < argc) {
+            errors = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            rngState = (uint32_t)strtoul(argv[++i], NULL, 0);
+            if (rngState == 0) rngState = 1;
+        } else if (strcmp(argv[i], "--numeric") == 0) {
+            numeric = true;
+        } else if (strcmp(argv[i], "--decode") == 0 && i + 1 < argc) {
+            return decodeFile(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--count N] [--errors 0-2] [--seed S] [--numeric] | --decode BITSTREAM\n", argv[0]);
+            return 2;
+        }
+    }
+    if (errors < 0 || errors > 2) {
+        fprintf(stderr, "--errors must be 0, 1 or 2\n");
+        return 2;
+    }
+
+    PocsagDecoder_Init(&dec, collect, &rx);
+    Pocsag_Init(&pocsag);
+
+    for (long n = 0; n < count; n++) {
+        char text[48];
+        int len = rng() % 41;
+        long address = 1 + rng() % 0x1FFFFF;
+        int source = rng() % 4;
+        int batch2 = rng() % 3;
+        int invert = rng() % 2;
+
+        // 2007664-2007671 with source 0 encode to the idle codeword, pagers never use them
+        if ((address >> 3) == ((POCSAG_IDLE_CW >> 13) & 0x3FFFF) && source == 0) {
+            source = 1;
+        }
+
+        for (int i = 0; i < len; i++) {
+            text[i] = numeric ? "0123456789*U -)("[rng() % 16] : (char)(0x20 + rng() % 95);
+        }
+        text[len] = '\0';
+
+        double t0 = nowSeconds();
+        int rc = numeric ? Pocsag_CreatePocsagNumeric(&pocsag, address, source, text, batch2, invert)
+                         : Pocsag_CreatePocsag(&pocsag, address, source, text, batch2, invert);
+        if (rc != POCSAG_SUCCESS) {
+            fprintf(stderr, "encode failed: address %ld error %d\n", address, Pocsag_GetError(&pocsag));
+            return 1;
+        }
+        double t1 = nowSeconds();
+
+        uint8_t *data = Pocsag_GetMsgPointer(&pocsag);
+        int size = Pocsag_GetSize(&pocsag);
+        SinkCheck_t check = {data, size, 0};
+        int sinkError;
+        if (!numeric && (Pocsag_Encode(address, source, text, batch2, invert, checkSink, &check, &sinkError) != POCSAG_SUCCESS ||
+                         check.pos != size)) {
+            fprintf(stderr, "sink output differs at octet %d: address %ld error %d\n", check.pos, address, sinkError);
+            return 1;
+        }
+        if (errors) {
+            injectErrors(data + BATCH1_OFFSET, errors);
+            if (size > BATCH2_OFFSET) {
+                injectErrors(data + BATCH2_OFFSET, errors);
+            }
+        }
+
+        double t2 = nowSeconds();
+        rx.count = 0;
+        PocsagDecoder_PushBytes(&dec, data, size);
+        PocsagDecoder_Flush(&dec);
+        double t3 = nowSeconds();
+
+        encodeTime += t1 - t0;
+        decodeTime += t3 - t2;
+        bits += (uint64_t)size * 8;
+
+        // the encoder drops text that does not fit in the two batches
+        int available = 32 - ((address & 0x7) * 2 + 1);
+        int expectLen = available * 20 / 7;
+        if (expectLen > len) {
+            expectLen = len;
+        }
+
+        // numeric messages are padded with spaces, the decoder strips them
+        if (numeric) {
+            while (expectLen > 0 && text[expectLen - 1] == ' ') {
+                expectLen--;
+            }
+        }
+
+        // batch2 option 1 repeats a single batch page in the second batch
+        bool ok = rx.count >= 1 && rx.count <= 2;
+        for (int m = 0; ok && m < rx.count; m++) {
+            const PocsagDecoder_Message_t *msg = &rx.msgs[m];
+            const char *got = numeric ? msg->numeric : msg->text;
+            ok = msg->address == address && msg->function == source &&
+                 msg->inverted == (invert != 0) && msg->uncorrectable == 0 &&
+                 (int)strlen(got) == expectLen && memcmp(got, text, expectLen) == 0;
+
+            // the page type the monitor prints it as: a tone-only page has none,
+            // a text cut short has no EOT to go by
+            if (ok && msg->codewords > 0 && expectLen == len && msg->isNumeric != numeric) {
+                misread++;
+            }
+        }
+
+        if (!ok) {
+            failures++;
+            if (failures <= 5) {
+                fprintf(stderr, "mismatch #%ld: address %ld source %d batch2 %d invert %d text \"%s\": %d message(s)",
+                        n, address, source, batch2, invert, text, rx.count);
+                if (rx.count > 0) {
+                    fprintf(stderr, ", got address %ld function %d %s \"%s\"",
+                            rx.msgs[0].address, rx.msgs[0].function, rx.msgs[0].isNumeric ? "digits" : "text",
+                            PocsagDecoder_GetText(&rx.msgs[0]));
+                }
+                fprintf(stderr, "\n");
+            }
+        }
+    }
+
+    const PocsagDecoder_Stats_t *s = PocsagDecoder_GetStats(&dec);
+    double total = encodeTime + decodeTime;
+    printf("%ld round-trips, %ld failures, %d bit error(s) per codeword\n", count, failures, errors);
+    printf("%ld page(s) taken for the wrong type (%s)\n", misread, numeric ? "digits read as text" : "text read as digits");
+    printf("codewords %lu, corrected bits %lu, uncorrectable %lu\n",
+           (unsigned long)s->codewords, (unsigned long)s->corrected, (unsigned long)s->uncorrectable);
+    printf("encode %.2f us/page, decode %.2f us/page (%.1f Mbit/s)\n",
+           encodeTime * 1e6 / count, decodeTime * 1e6 / count, bits / decodeTime / 1e6);
+    printf("%.0f round-trips per minute\n", total > 0 ? count * 60.0 / total : 0.0);
+
+    // numeric data can look like a text ending in EOT, rarely
+    if (misread > count * MAX_MISREAD_PPM / 1000000) {
+        fprintf(stderr, "more than %d ppm of the pages taken for the wrong type\n", MAX_MISREAD_PPM);
+        return 1;
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,295 @@
+/*
+ * pocsag_trace.c
+ *
+ *  Analyze SI4463 SPI trace dumps (the T command of a -DSI4463_TRACE
+ *  firmware): rebuild the radio command timeline and summarize the
+ *  latency and CTS wait of each command. The dump may be embedded in a
+ *  serial log, only '# SI4463 trace' headers and '@' lines are read.
+ *  Several dumps, one per unit, are summarized side by side.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_ENTRIES 65536
+#define MAX_KEYS    64
+
+typedef struct {
+    uint32_t timeUs;
+    uint32_t totalUs;
+    uint32_t ctsUs;
+    unsigned polls;
+    unsigned cmd;
+    unsigned len;
+    unsigned resp;
+    unsigned bus;
+    char type;
+} Entry_t;
+
+// Statistics per command byte and transaction type
+typedef struct {
+    unsigned cmd;
+    char type;
+    uint32_t count;
+    uint64_t bytes;
+    uint64_t sumUs;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t sumCtsUs;
+    uint32_t maxCtsUs;
+    uint64_t polls;
+} Stats_t;
+
+typedef struct {
+    const char *name;
+    char unit[64];
+    uint32_t lost;
+    Entry_t *entries;
+    int count;
+    Stats_t stats[MAX_KEYS];
+    int keys;
+} Dump_t;
+
+static bool optTimeline = false;
+
+// Private function prototypes
+static bool trace_load(Dump_t *d, const char *path);
+static void trace_timeline(const Dump_t *d);
+static void trace_collect(Dump_t *d);
+static void trace_summary(const Dump_t *d);
+static const char* trace_cmdName(unsigned cmd);
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [options] DUMP...\n"
+            "  --timeline    print every transaction with the idle gap before it\n"
+            "DUMP is a serial log holding the output of the T command, '-' reads stdin.\n"
+            "Each dump is summarized on its own, so units can be compared.\n",
+            prog);
+}
+
+int main(int argc, char **argv) {
+    int files = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--timeline")) {
+            optTimeline = true;
+        } else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
+            usage(argv[0]);
+            return 0;
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    for (int i = 1; i < argc; i++) {
+        Dump_t d;
+
+        if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            continue;
+        }
+        memset(&d, 0, sizeof(d));
+        if (!trace_load(&d, argv[i])) {
+            free(d.entries);
+            return 1;
+        }
+        if (files++) {
+            printf("\n");
+        }
+        if (optTimeline) {
+            trace_timeline(&d);
+        }
+        trace_collect(&d);
+        trace_summary(&d);
+        free(d.entries);
+    }
+
+    if (files == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    return 0;
+}
+
+// Read the last dump in a log, an earlier one is superseded by each new header
+static bool trace_load(Dump_t *d, const char *path) {
+    FILE *f = strcmp(path, "-") ? fopen(path, "r") : stdin;
+    char line[256];
+
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    d->name = path;
+    d->entries = malloc(MAX_ENTRIES * sizeof(Entry_t));
+    if (!d->entries) {
+        fprintf(stderr, "out of memory\n");
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), f)) {
+        Entry_t e;
+        unsigned long timeUs, totalUs, ctsUs, lost;
+        char *p = strstr(line, "# SI4463 trace:");
+
+        if (p) {
+            d->count = 0;
+            d->lost = 0;
+            strcpy(d->unit, "?");
+            if (sscanf(p, "# SI4463 trace: unit %63[0-9A-Fa-f], %*u entries, %lu overwritten", d->unit, &lost) == 2) {
+                d->lost = (uint32_t)lost;
+            }
+            continue;
+        }
+
+        p = strstr(line, "@ ");
+        if (!p || d->count >= MAX_ENTRIES) {
+            continue;
+        }
+        if (sscanf(p, "@ %lu %u %c %x %u %u %lu %lu %u", &timeUs, &e.bus, &e.type, &e.cmd,
+                   &e.len, &e.resp, &totalUs, &ctsUs, &e.polls) != 9) {
+            continue;
+        }
+        e.timeUs = (uint32_t)timeUs;
+        e.totalUs = (uint32_t)totalUs;
+        e.ctsUs = (uint32_t)ctsUs;
+        d->entries[d->count++] = e;
+    }
+
+    if (f != stdin) {
+        fclose(f);
+    }
+    if (d->count == 0) {
+        fprintf(stderr, "%s: no trace entries found\n", path);
+        return false;
+    }
+    return true;
+}
+
+// One line per transaction, times relative to the first one
+static void trace_timeline(const Dump_t *d) {
+    uint32_t t0 = d->entries[0].timeUs;
+    uint32_t lastEnd[3] = {t0, t0, t0};
+
+    printf("%s: unit %s\n", d->name, d->unit);
+    printf("      time ms    gap us bus  command            len resp  total us    cts us polls\n");
+    for (int i = 0; i < d->count; i++) {
+        const Entry_t *e = &d->entries[i];
+        unsigned bus = e->bus < 3 ? e->bus : 0;
+        int32_t gap = (int32_t)(e->timeUs - lastEnd[bus]);
+
+        printf("%13.3f %9ld %3u  %c %-16s %4u %4u %9lu %9lu %5u%s\n",
+               (e->timeUs - t0) / 1000.0, (long)(i ? gap : 0), e->bus, e->type, trace_cmdName(e->cmd),
+               e->len, e->resp, (unsigned long)e->totalUs, (unsigned long)e->ctsUs, e->polls,
+               e->type == 'X' ? "  CTS timeout" : "");
+        lastEnd[bus] = e->timeUs + e->totalUs;
+    }
+    printf("\n");
+}
+
+// Fold the entries into per-command statistics
+static void trace_collect(Dump_t *d) {
+    for (int i = 0; i < d->count; i++) {
+        const Entry_t *e = &d->entries[i];
+        Stats_t *s = NULL;
+
+        for (int k = 0; k < d->keys; k++) {
+            if (d->stats[k].cmd == e->cmd && d->stats[k].type == e->type) {
+                s = &d->stats[k];
+                break;
+            }
+        }
+        if (!s) {
+            if (d->keys >= MAX_KEYS) {
+                continue;
+            }
+            s = &d->stats[d->keys++];
+            s->cmd = e->cmd;
+            s->type = e->type;
+            s->minUs = UINT32_MAX;
+        }
+
+        s->count++;
+        s->bytes += e->len + e->resp;
+        s->sumUs += e->totalUs;
+        if (e->totalUs < s->minUs) s->minUs = e->totalUs;
+        if (e->totalUs > s->maxUs) s->maxUs = e->totalUs;
+        s->sumCtsUs += e->ctsUs;
+        if (e->ctsUs > s->maxCtsUs) s->maxCtsUs = e->ctsUs;
+        s->polls += e->polls;
+    }
+}
+
+// Per-command latency table, sorted by the time each command costs in total
+static void trace_summary(const Dump_t *d) {
+    const Entry_t *last = &d->entries[d->count - 1];
+    uint64_t span = (uint64_t)(last->timeUs - d->entries[0].timeUs) + last->totalUs;
+    uint64_t busy = 0, cts = 0;
+    int order[MAX_KEYS];
+
+    for (int k = 0; k < d->keys; k++) {
+        busy += d->stats[k].sumUs;
+        cts += d->stats[k].sumCtsUs;
+        order[k] = k;
+    }
+    for (int a = 1; a < d->keys; a++) {
+        for (int b = a; b > 0 && d->stats[order[b]].sumUs > d->stats[order[b - 1]].sumUs; b--) {
+            int t = order[b];
+            order[b] = order[b - 1];
+            order[b - 1] = t;
+        }
+    }
+
+    printf("%s: unit %s, %d transactions over %.3f ms (%lu overwritten before the dump)\n",
+           d->name, d->unit, d->count, span / 1000.0, (unsigned long)d->lost);
+    printf("radio time %.3f ms (%.1f%%), of which CTS wait %.3f ms\n",
+           busy / 1000.0, span ? 100.0 * busy / span : 0.0, cts / 1000.0);
+    printf("  command              count   bytes   avg us   min us   max us  cts avg  cts max  polls  share\n");
+    for (int k = 0; k < d->keys; k++) {
+        const Stats_t *s = &d->stats[order[k]];
+
+        printf("  %c %-16s %7lu %7lu %8lu %8lu %8lu %8lu %8lu %6.1f %5.1f%%\n",
+               s->type, trace_cmdName(s->cmd), (unsigned long)s->count, (unsigned long)s->bytes,
+               (unsigned long)(s->sumUs / s->count), (unsigned long)s->minUs, (unsigned long)s->maxUs,
+               (unsigned long)(s->sumCtsUs / s->count), (unsigned long)s->maxCtsUs,
+               (double)s->polls / s->count, busy ? 100.0 * s->sumUs / busy : 0.0);
+    }
+}
+
+static const char* trace_cmdName(unsigned cmd) {
+    static char unknown[8];
+
+    switch (cmd) {
+    case 0x00: return "NOP";
+    case 0x01: return "PART_INFO";
+    case 0x02: return "POWER_UP";
+    case 0x10: return "FUNC_INFO";
+    case 0x11: return "SET_PROPERTY";
+    case 0x12: return "GET_PROPERTY";
+    case 0x13: return "GPIO_PIN_CFG";
+    case 0x15: return "FIFO_INFO";
+    case 0x20: return "GET_INT_STATUS";
+    case 0x21: return "GET_PH_STATUS";
+    case 0x22: return "GET_MODEM_STATUS";
+    case 0x23: return "GET_CHIP_STATUS";
+    case 0x31: return "START_TX";
+    case 0x32: return "START_RX";
+    case 0x33: return "REQUEST_STATE";
+    case 0x34: return "CHANGE_STATE";
+    case 0x44: return "READ_CMD_BUFF";
+    case 0x50: return "FRR_A_READ";
+    case 0x51: return "FRR_B_READ";
+    case 0x53: return "FRR_C_READ";
+    case 0x57: return "FRR_D_READ";
+    case 0x66: return "WRITE_TX_FIFO";
+    case 0x77: return "READ_RX_FIFO";
+    }
+    snprintf(unknown, sizeof(unknown), "0x%02X", cmd & 0xFF);
+    return unknown;
+}
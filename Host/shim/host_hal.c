@@ -0,0 +1,779 @@
+/*
+ * host_hal.c
+ *
+ *  Minimal STM32F1 HAL for running the firmware on a Linux host.
+ *
+ *  Time is virtual: it advances by the modeled duration of peripheral
+ *  transfers (UART bytes at the line rate, SPI bytes at the SPI clock),
+ *  by HAL_Delay(), by skipping ahead while the core sleeps in WFI and,
+ *  optionally, by the host CPU time the firmware consumes. SysTick, UART RX
+ *  and TX complete, EXTI and TIM2 interrupts are delivered whenever
+ *  interrupts are unmasked, TIM2 updates at the exact time they occur.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "host_hal.h"
+#include <string.h>
+#include <time.h>
+
+#define HOST_HSI_HZ          8000000U
+#define HOST_HSE_HZ          8000000U
+#define HOST_HSE_STARTUP_US  1500U
+#define HOST_PLL_LOCK_US     200U
+#define HOST_UART_RXLEN      4096
+#define HOST_MAX_DEVICES     4
+
+// Peripheral instances
+uint32_t SystemCoreClock = HOST_HSI_HZ;
+GPIO_TypeDef Host_GPIOA, Host_GPIOB, Host_GPIOC, Host_GPIOD;
+SPI_TypeDef Host_SPI1, Host_SPI2;
+USART_TypeDef Host_USART1;
+TIM_TypeDef Host_TIM2;
+
+static DWT_Type dwt;
+static CoreDebug_Type coreDebug;
+
+// Interrupt handlers from stm32f1xx_it.c, weak so tools without them still link
+extern void SysTick_Handler(void) __attribute__((weak));
+extern void USART1_IRQHandler(void) __attribute__((weak));
+extern void EXTI0_IRQHandler(void) __attribute__((weak));
+extern void EXTI1_IRQHandler(void) __attribute__((weak));
+extern void EXTI2_IRQHandler(void) __attribute__((weak));
+extern void EXTI3_IRQHandler(void) __attribute__((weak));
+extern void EXTI4_IRQHandler(void) __attribute__((weak));
+extern void TIM2_IRQHandler(void) __attribute__((weak));
+
+static Host_Config_t config = { true, 1 };
+static Host_Stats_t stats;
+
+// Time
+static uint64_t virtualUs = 0;        // modeled time (transfers, delays, sleep)
+static uint64_t cpuStartUs = 0;
+static uint64_t ticksRaised = 0;      // SysTick interrupts raised so far
+static volatile uint32_t uwTick = 0;
+static uint64_t dwtLastUs = 0;
+static uint64_t dwtRemainder = 0;
+
+// Interrupts
+static uint32_t primask = 0;
+static bool inIsr = false;
+static uint32_t pendingSysTick = 0;
+static bool irqEnabled[HOST_IRQ_COUNT];
+static bool irqPending[HOST_IRQ_COUNT];
+
+// Clocks
+static bool hseOn = false;
+static bool pllOn = false;
+static uint32_t pllMul = 1;
+static uint32_t pclk1Hz = HOST_HSI_HZ;
+static uint32_t pclk2Hz = HOST_HSI_HZ;
+
+// UART
+static UART_HandleTypeDef *uartRx = NULL;     // handle with a pending Receive_IT
+static uint8_t uartRxData[HOST_UART_RXLEN];
+static uint64_t uartRxArrival[HOST_UART_RXLEN];
+static size_t uartRxHead = 0, uartRxCount = 0;
+static uint64_t uartRxLastArrival = 0;
+static uint32_t uartBaud = 9600;
+static void (*uartOutput)(const uint8_t *data, size_t len) = NULL;
+// interrupt driven transmit: the bytes are output at once, the completion
+// follows at the line rate. TC is left set, the wait for the shift register
+// before a baud rate change is not modeled.
+static UART_HandleTypeDef *uartTx = NULL;
+static uint64_t uartTxDone = 0;
+
+static void (*idleHook)(uint64_t idle_us) = NULL;
+static uint64_t idleStreakUs = 0;
+
+// TIM2
+static uint64_t timLastUs = 0;
+static uint64_t timRemainder = 0;     // timer clock cycles * 10^6 not counted yet
+static uint32_t timPrescaler = 0;     // active prescaler, PSC is loaded on update events
+static uint32_t timPrescaleCount = 0;
+static uint32_t timCnt = 0;           // CNT as the timer left it, the firmware may write it
+
+// SPI devices
+typedef struct {
+    SPI_TypeDef *spi;
+    Host_SpiDevice_t dev;
+} HostDevice_t;
+static HostDevice_t devices[HOST_MAX_DEVICES];
+static int deviceCount = 0;
+static SPI_HandleTypeDef *spiHandles[2];
+
+// Private function prototypes
+static uint64_t host_cpuUs(void);
+static void host_sync(void);
+static void host_poll(void);
+static void host_serviceIrqs(void);
+static bool host_anyPending(void);
+static void host_dwtUpdate(void);
+static uint32_t host_spiHz(SPI_HandleTypeDef *hspi);
+static uint32_t host_timHz(void);
+static uint64_t host_timCyclesToUpdate(void);
+static uint64_t host_timNextUs(void);
+static void host_timUpdate(void);
+
+// Host API ---------------------------------------------------------------------
+void Host_Init(const Host_Config_t *cfg) {
+    if (cfg) {
+        config = *cfg;
+        if (config.cpuScale == 0) {
+            config.cpuScale = 1;
+        }
+    }
+    memset(&stats, 0, sizeof(stats));
+    Host_USART1.SR = UART_FLAG_TC;
+    Host_GPIOA.IDR = Host_GPIOB.IDR = Host_GPIOC.IDR = Host_GPIOD.IDR = 0xFFFF;
+    cpuStartUs = host_cpuUs();
+}
+
+uint64_t Host_NowUs(void) {
+    uint64_t now = virtualUs;
+
+    if (config.includeCpuTime) {
+        now += (host_cpuUs() - cpuStartUs) * config.cpuScale;
+    }
+    return now;
+}
+
+void Host_Advance(uint64_t us) {
+    uint64_t end = virtualUs + us;
+
+    // stop at each timer update on the way, its handler preempts the code
+    // that is spending the time
+    while ((Host_TIM2.CR1 & TIM_CR1_CEN) && !primask && !inIsr) {
+        uint64_t next, cpuUs;
+
+        host_poll();
+        next = host_timNextUs();
+        cpuUs = Host_NowUs() - virtualUs;
+        if (next == 0 || next >= end + cpuUs) {
+            break;
+        }
+        if (next > virtualUs + cpuUs) {
+            virtualUs = next - cpuUs;
+        }
+    }
+
+    virtualUs = end;
+    host_poll();
+}
+
+const Host_Stats_t* Host_GetStats(void) {
+    return &stats;
+}
+
+void Host_UartInput(const uint8_t *data, size_t len) {
+    uint64_t byteUs = 10ULL * 1000000ULL / uartBaud;
+    uint64_t now = Host_NowUs();
+
+    for (size_t i = 0; i < len; i++) {
+        if (uartRxCount >= HOST_UART_RXLEN) {
+            stats.uartRxDropped++;
+            continue;
+        }
+        if (uartRxLastArrival < now) {
+            uartRxLastArrival = now;
+        }
+        uartRxLastArrival += byteUs;
+
+        size_t idx = (uartRxHead + uartRxCount) % HOST_UART_RXLEN;
+        uartRxData[idx] = data[i];
+        uartRxArrival[idx] = uartRxLastArrival;
+        uartRxCount++;
+    }
+}
+
+size_t Host_UartInputPending(void) {
+    return uartRxCount;
+}
+
+void Host_SetUartOutput(void (*output)(const uint8_t *data, size_t len)) {
+    uartOutput = output;
+}
+
+void Host_SetIdleHook(void (*hook)(uint64_t idle_us)) {
+    idleHook = hook;
+}
+
+bool Host_AttachSpiDevice(SPI_TypeDef *spi, const Host_SpiDevice_t *device) {
+    if (deviceCount >= HOST_MAX_DEVICES || device == NULL) {
+        return false;
+    }
+    devices[deviceCount].spi = spi;
+    devices[deviceCount].dev = *device;
+    deviceCount++;
+    return true;
+}
+
+void Host_SetPin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state) {
+    uint32_t old = port->IDR & pin;
+
+    if (state == GPIO_PIN_SET) {
+        port->IDR |= pin;
+    } else {
+        port->IDR &= ~(uint32_t)pin;
+    }
+
+    bool falling = old && state == GPIO_PIN_RESET;
+    bool rising = !old && state == GPIO_PIN_SET;
+    if ((falling && (port->itFalling & pin)) || (rising && (port->itRising & pin))) {
+        // EXTI lines 0..4 have their own vectors, the firmware only uses those
+        for (int line = 0; line <= 4; line++) {
+            if (pin == (1U << line)) {
+                irqPending[EXTI0_IRQn + line] = true;
+            }
+        }
+    }
+}
+
+// CMSIS ----------------------------------------------------------------------
+DWT_Type* Host_Dwt(void) {
+    host_dwtUpdate();
+    return &dwt;
+}
+
+CoreDebug_Type* Host_CoreDebug(void) {
+    return &coreDebug;
+}
+
+void Host_DisableIrq(void) {
+    primask = 1;
+}
+
+void Host_EnableIrq(void) {
+    primask = 0;
+    host_poll();
+}
+
+uint32_t Host_GetPrimask(void) {
+    return primask;
+}
+
+void Host_SetPrimask(uint32_t value) {
+    primask = value;
+    if (!primask) {
+        host_poll();
+    }
+}
+
+// Sleep until the next interrupt: skip ahead to the next SysTick, UART byte
+// or device event, whichever comes first
+void Host_Wfi(void) {
+    host_sync();
+    if (host_anyPending()) {
+        idleStreakUs = 0;
+        return;
+    }
+
+    stats.wfiCount++;
+    if (idleHook) {
+        idleHook(idleStreakUs);
+        host_sync();
+        if (host_anyPending()) {
+            idleStreakUs = 0;
+            return;
+        }
+    }
+
+    uint64_t now = Host_NowUs();
+    uint64_t wake = (now / 1000 + 1) * 1000;
+    if (uartRx && irqEnabled[USART1_IRQn] && uartRxCount > 0 && uartRxArrival[uartRxHead] < wake) {
+        wake = uartRxArrival[uartRxHead] > now ? uartRxArrival[uartRxHead] : now;
+    }
+    if (uartTx && irqEnabled[USART1_IRQn] && uartTxDone < wake) {
+        wake = uartTxDone > now ? uartTxDone : now;
+    }
+    for (int i = 0; i < deviceCount; i++) {
+        if (devices[i].dev.nextEvent) {
+            uint64_t t = devices[i].dev.nextEvent(devices[i].dev.ctx);
+            if (t != 0 && t < wake) {
+                wake = t > now ? t : now;
+            }
+        }
+    }
+    uint64_t timUs = host_timNextUs();
+    if (timUs != 0 && timUs < wake) {
+        wake = timUs > now ? timUs : now;
+    }
+
+    stats.idleUs += wake - now;
+    idleStreakUs += wake - now;
+    virtualUs += wake - now;
+    host_sync();
+}
+
+// HAL core ---------------------------------------------------------------------
+HAL_StatusTypeDef HAL_Init(void) {
+    HAL_MspInit();
+    return HAL_OK;
+}
+
+void HAL_IncTick(void) {
+    uwTick++;
+}
+
+uint32_t HAL_GetTick(void) {
+    host_poll();
+    return uwTick;
+}
+
+void HAL_Delay(uint32_t Delay) {
+    uint32_t tickstart = HAL_GetTick();
+    uint32_t wait = Delay;
+
+    // same rounding as the real HAL: at least Delay full milliseconds
+    if (wait < HAL_MAX_DELAY) {
+        wait++;
+    }
+    while ((HAL_GetTick() - tickstart) < wait) {
+        uint64_t now = Host_NowUs();
+        Host_Advance((now / 1000 + 1) * 1000 - now);
+    }
+}
+
+// 96 bit device ID, fixed so runs are reproducible
+uint32_t HAL_GetUIDw0(void) {
+    return 0x0030001BU;
+}
+
+uint32_t HAL_GetUIDw1(void) {
+    return 0x33345112U;
+}
+
+uint32_t HAL_GetUIDw2(void) {
+    return 0x20363146U;
+}
+
+// The modeled cycle counter keeps running through WFI, as with DBG_SLEEP set
+void HAL_DBGMCU_EnableDBGSleepMode(void) {
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority) {
+    (void)IRQn; (void)PreemptPriority; (void)SubPriority;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {
+    if (IRQn >= 0 && IRQn < HOST_IRQ_COUNT) irqEnabled[IRQn] = true;
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn) {
+    if (IRQn >= 0 && IRQn < HOST_IRQ_COUNT) irqEnabled[IRQn] = false;
+}
+
+// RCC ------------------------------------------------------------------------
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *osc) {
+    if (osc->OscillatorType & RCC_OSCILLATORTYPE_HSE) {
+        if (osc->HSEState == RCC_HSE_ON && !hseOn) {
+            Host_Advance(HOST_HSE_STARTUP_US);
+        }
+        hseOn = (osc->HSEState == RCC_HSE_ON);
+    }
+    if (osc->PLL.PLLState == RCC_PLL_ON) {
+        if (osc->PLL.PLLSource == RCC_PLLSOURCE_HSE && !hseOn) {
+            return HAL_ERROR;
+        }
+        pllMul = osc->PLL.PLLMUL;
+        if (!pllOn) {
+            Host_Advance(HOST_PLL_LOCK_US);
+        }
+        pllOn = true;
+    } else if (osc->PLL.PLLState == RCC_PLL_OFF) {
+        pllOn = false;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *clk, uint32_t FLatency) {
+    uint32_t sysclk;
+
+    (void)FLatency;
+    switch (clk->SYSCLKSource) {
+    case RCC_SYSCLKSOURCE_PLLCLK:
+        if (!pllOn) return HAL_ERROR;
+        sysclk = HOST_HSE_HZ * pllMul;
+        break;
+    case RCC_SYSCLKSOURCE_HSE:
+        if (!hseOn) return HAL_ERROR;
+        sysclk = HOST_HSE_HZ;
+        break;
+    default:
+        sysclk = HOST_HSI_HZ;
+        break;
+    }
+
+    // settle DWT and TIM2 at the old rate before the clocks change
+    host_dwtUpdate();
+    host_timUpdate();
+    SystemCoreClock = sysclk / (clk->AHBCLKDivider ? clk->AHBCLKDivider : 1);
+    pclk1Hz = SystemCoreClock / (clk->APB1CLKDivider ? clk->APB1CLKDivider : 1);
+    pclk2Hz = SystemCoreClock / (clk->APB2CLKDivider ? clk->APB2CLKDivider : 1);
+    return HAL_OK;
+}
+
+uint32_t HAL_RCC_GetHCLKFreq(void) {
+    return SystemCoreClock;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void) {
+    return pclk1Hz;
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void) {
+    return pclk2Hz;
+}
+
+// GPIO -----------------------------------------------------------------------
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *init) {
+    GPIOx->itFalling &= ~init->Pin;
+    GPIOx->itRising &= ~init->Pin;
+    if (init->Mode == GPIO_MODE_IT_FALLING || init->Mode == GPIO_MODE_IT_RISING_FALLING) {
+        GPIOx->itFalling |= init->Pin;
+    }
+    if (init->Mode == GPIO_MODE_IT_RISING || init->Mode == GPIO_MODE_IT_RISING_FALLING) {
+        GPIOx->itRising |= init->Pin;
+    }
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin) {
+    GPIOx->itFalling &= ~GPIO_Pin;
+    GPIOx->itRising &= ~GPIO_Pin;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+    if (PinState == GPIO_PIN_SET) {
+        GPIOx->ODR |= GPIO_Pin;
+    } else {
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    }
+    for (int i = 0; i < deviceCount; i++) {
+        if (devices[i].dev.pinWrite) {
+            devices[i].dev.pinWrite(devices[i].dev.ctx, GPIOx, GPIO_Pin, PinState);
+        }
+    }
+}
+
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin) {
+    HAL_GPIO_EXTI_Callback(GPIO_Pin);
+}
+
+__attribute__((weak)) void HAL_MspInit(void) {
+}
+
+__attribute__((weak)) void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    (void)GPIO_Pin;
+}
+
+// SPI ------------------------------------------------------------------------
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef *hspi) {
+    int idx = (hspi->Instance == SPI2) ? 1 : 0;
+    spiHandles[idx] = hspi;
+    HAL_SPI_MspInit(hspi);
+    hspi->Instance->CR1 = hspi->Init.BaudRatePrescaler;
+    return HAL_OK;
+}
+
+static HAL_StatusTypeDef host_spiTransfer(SPI_HandleTypeDef *hspi, const uint8_t *tx, uint8_t *rx, uint16_t size) {
+    uint32_t hz = host_spiHz(hspi);
+
+    for (uint16_t n = 0; n < size; n++) {
+        uint8_t miso = 0xFF;
+        uint8_t mosi = tx ? tx[n] : 0xFF;
+
+        for (int i = 0; i < deviceCount; i++) {
+            if (devices[i].spi == hspi->Instance && devices[i].dev.transfer) {
+                miso &= devices[i].dev.transfer(devices[i].dev.ctx, mosi);
+            }
+        }
+        if (rx) {
+            rx[n] = miso;
+        }
+    }
+
+    uint64_t busy = ((uint64_t)size * 8 * 1000000ULL + hz - 1) / hz;
+    stats.spiBytes += size;
+    stats.spiBusyUs += busy;
+    Host_Advance(busy);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    (void)Timeout;
+    return host_spiTransfer(hspi, pData, NULL, Size);
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    (void)Timeout;
+    return host_spiTransfer(hspi, NULL, pData, Size);
+}
+
+__attribute__((weak)) void HAL_SPI_MspInit(SPI_HandleTypeDef *hspi) {
+    (void)hspi;
+}
+
+// UART -----------------------------------------------------------------------
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart) {
+    HAL_UART_MspInit(huart);
+    huart->Instance->SR = UART_FLAG_TC;
+    huart->Instance->BRR = UART_BRR_SAMPLING16(pclk2Hz, huart->Init.BaudRate);
+    uartBaud = huart->Init.BaudRate ? huart->Init.BaudRate : 9600;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    (void)Timeout;
+    if (uartOutput) {
+        uartOutput(pData, Size);
+    }
+    stats.uartTxBytes += Size;
+
+    // blocking transmit holds the core for 10 bit times per byte
+    uint32_t baud = huart->Init.BaudRate ? huart->Init.BaudRate : 9600;
+    Host_Advance((uint64_t)Size * 10 * 1000000ULL / baud);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size) {
+    if (uartTx || Size == 0) {
+        return HAL_BUSY;
+    }
+    if (uartOutput) {
+        uartOutput(pData, Size);
+    }
+    stats.uartTxBytes += Size;
+
+    uint32_t baud = huart->Init.BaudRate ? huart->Init.BaudRate : 9600;
+    uartTx = huart;
+    uartTxDone = Host_NowUs() + (uint64_t)Size * 10 * 1000000ULL / baud;
+    huart->Instance->CR1 |= USART_CR1_TXEIE;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+    if (uartRx == huart || Size == 0) {
+        return HAL_BUSY;
+    }
+    huart->pRxBuffPtr = pData;
+    huart->RxXferCount = Size;
+    uartRx = huart;
+    return HAL_OK;
+}
+
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart) {
+    uint64_t now = Host_NowUs();
+
+    while (uartRx == huart && uartRxCount > 0 && uartRxArrival[uartRxHead] <= now) {
+        *huart->pRxBuffPtr++ = uartRxData[uartRxHead];
+        uartRxHead = (uartRxHead + 1) % HOST_UART_RXLEN;
+        uartRxCount--;
+        stats.uartRxBytes++;
+
+        if (--huart->RxXferCount == 0) {
+            uartRx = NULL;
+            HAL_UART_RxCpltCallback(huart);
+        }
+    }
+
+    if (uartTx == huart && uartTxDone <= now) {
+        uartTx = NULL;
+        huart->Instance->CR1 &= ~USART_CR1_TXEIE;
+        HAL_UART_TxCpltCallback(huart);
+    }
+}
+
+__attribute__((weak)) void HAL_UART_MspInit(UART_HandleTypeDef *huart) {
+    (void)huart;
+}
+
+__attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+    (void)huart;
+}
+
+__attribute__((weak)) void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
+    (void)huart;
+}
+
+__attribute__((weak)) void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+    (void)huart;
+}
+
+// Private functions ------------------------------------------------------------
+static uint64_t host_cpuUs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+// Bring devices and interrupt sources up to the current time
+static void host_sync(void) {
+    uint64_t now = Host_NowUs();
+
+    for (int i = 0; i < deviceCount; i++) {
+        if (devices[i].dev.advance) {
+            devices[i].dev.advance(devices[i].dev.ctx, now);
+        }
+    }
+
+    host_timUpdate();
+
+    uint64_t ticks = now / 1000;
+    if (ticks > ticksRaised) {
+        pendingSysTick += (uint32_t)(ticks - ticksRaised);
+        ticksRaised = ticks;
+    }
+
+    if (uartRx && uartRxCount > 0 && uartRxArrival[uartRxHead] <= now) {
+        irqPending[USART1_IRQn] = true;
+    }
+    if (uartTx && uartTxDone <= now) {
+        irqPending[USART1_IRQn] = true;
+    }
+}
+
+static bool host_anyPending(void) {
+    if (pendingSysTick) return true;
+    for (int i = 0; i < HOST_IRQ_COUNT; i++) {
+        if (irqPending[i] && irqEnabled[i]) return true;
+    }
+    return false;
+}
+
+// Run pending handlers as if they preempted the current code
+static void host_poll(void) {
+    host_sync();
+    host_serviceIrqs();
+}
+
+static void host_serviceIrqs(void) {
+    if (primask || inIsr) {
+        return;
+    }
+
+    inIsr = true;
+    while (host_anyPending()) {
+        if (pendingSysTick) {
+            pendingSysTick--;
+            if (SysTick_Handler) SysTick_Handler(); else uwTick++;
+            continue;
+        }
+        for (int i = 0; i < HOST_IRQ_COUNT; i++) {
+            if (!irqPending[i] || !irqEnabled[i]) continue;
+            irqPending[i] = false;
+
+            switch (i) {
+            case USART1_IRQn: if (USART1_IRQHandler) USART1_IRQHandler(); break;
+            case EXTI0_IRQn:  if (EXTI0_IRQHandler) EXTI0_IRQHandler(); break;
+            case EXTI1_IRQn:  if (EXTI1_IRQHandler) EXTI1_IRQHandler(); break;
+            case EXTI2_IRQn:  if (EXTI2_IRQHandler) EXTI2_IRQHandler(); break;
+            case EXTI3_IRQn:  if (EXTI3_IRQHandler) EXTI3_IRQHandler(); break;
+            case EXTI4_IRQn:  if (EXTI4_IRQHandler) EXTI4_IRQHandler(); break;
+            case TIM2_IRQn:   if (TIM2_IRQHandler) TIM2_IRQHandler(); break;
+            default: break;
+            }
+        }
+        host_sync();
+    }
+    inIsr = false;
+}
+
+static void host_dwtUpdate(void) {
+    uint64_t now = Host_NowUs();
+    uint64_t num = (now - dwtLastUs) * SystemCoreClock + dwtRemainder;
+
+    dwtLastUs = now;
+    dwtRemainder = num % 1000000ULL;
+    if (dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) {
+        dwt.CYCCNT += (uint32_t)(num / 1000000ULL);
+    }
+}
+
+static uint32_t host_spiHz(SPI_HandleTypeDef *hspi) {
+    uint32_t div = 2U << ((hspi->Init.BaudRatePrescaler >> 3) & 0x7);
+    return ((hspi->Instance == SPI2) ? pclk1Hz : pclk2Hz) / div;
+}
+
+// TIM2 runs at twice PCLK1 when the APB1 prescaler divides
+static uint32_t host_timHz(void) {
+    return (pclk1Hz == SystemCoreClock) ? pclk1Hz : 2 * pclk1Hz;
+}
+
+// Timer clock cycles until the counter passes ARR, counting from 0xFFFF
+// through 0 first when the firmware left CNT above ARR
+static uint64_t host_timCyclesToUpdate(void) {
+    uint32_t cnt = Host_TIM2.CNT & 0xFFFF;
+    uint32_t arr = Host_TIM2.ARR & 0xFFFF;
+    uint64_t ticks = (cnt <= arr) ? arr - cnt + 1 : 0x10000 - cnt + arr + 1;
+
+    return ticks * (timPrescaler + 1) - timPrescaleCount;
+}
+
+// Time of the next update interrupt, 0 = none
+static uint64_t host_timNextUs(void) {
+    uint64_t hz = host_timHz();
+    uint64_t need;
+
+    if (!(Host_TIM2.CR1 & TIM_CR1_CEN) || !(Host_TIM2.DIER & TIM_DIER_UIE) || !irqEnabled[TIM2_IRQn]) {
+        return 0;
+    }
+    need = host_timCyclesToUpdate() * 1000000ULL;
+    need = need > timRemainder ? need - timRemainder : 0;
+    return timLastUs + (need + hz - 1) / hz;
+}
+
+// Count the timer up to now, raising an update interrupt at each overflow
+static void host_timUpdate(void) {
+    uint64_t now = Host_NowUs();
+    uint64_t num = (now - timLastUs) * host_timHz() + timRemainder;
+    uint64_t cycles = num / 1000000ULL;
+
+    timLastUs = now;
+    timRemainder = num % 1000000ULL;
+
+    // software update event: load the prescaler and restart the count
+    if (Host_TIM2.EGR & TIM_EGR_UG) {
+        Host_TIM2.EGR = 0;
+        timPrescaler = Host_TIM2.PSC;
+        timPrescaleCount = 0;
+        Host_TIM2.CNT = 0;
+        timCnt = 0;
+        if (!(Host_TIM2.CR1 & TIM_CR1_URS)) {
+            Host_TIM2.SR |= TIM_SR_UIF;
+            if (Host_TIM2.DIER & TIM_DIER_UIE) {
+                irqPending[TIM2_IRQn] = true;
+            }
+        }
+    }
+    if (Host_TIM2.CNT != timCnt) {
+        timPrescaleCount = 0;
+    }
+    if (!(Host_TIM2.CR1 & TIM_CR1_CEN)) {
+        timCnt = Host_TIM2.CNT;
+        return;
+    }
+
+    while (cycles > 0) {
+        uint64_t left = host_timCyclesToUpdate();
+
+        if (cycles < left) {
+            uint64_t total = timPrescaleCount + cycles;
+            Host_TIM2.CNT = (uint32_t)((Host_TIM2.CNT + total / (timPrescaler + 1)) & 0xFFFF);
+            timPrescaleCount = (uint32_t)(total % (timPrescaler + 1));
+            break;
+        }
+        cycles -= left;
+        Host_TIM2.CNT = 0;
+        timPrescaleCount = 0;
+        timPrescaler = Host_TIM2.PSC;
+        Host_TIM2.SR |= TIM_SR_UIF;
+        if (Host_TIM2.DIER & TIM_DIER_UIE) {
+            irqPending[TIM2_IRQn] = true;
+        }
+    }
+    timCnt = Host_TIM2.CNT;
+}
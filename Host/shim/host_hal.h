@@ -0,0 +1,59 @@
+/*
+ * host_hal.h
+ *
+ *  Host side of the HAL shim: virtual time, UART plumbing and hooks for
+ *  simulated SPI devices.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include "stm32f1xx_hal.h"
+
+// Simulated peripheral on an SPI bus. It sees every GPIO write (chip select,
+// shutdown, ...) and every byte on its bus, and drives its outputs back
+// through Host_SetPin().
+typedef struct {
+    void *ctx;
+    uint8_t (*transfer)(void *ctx, uint8_t mosi);
+    void (*pinWrite)(void *ctx, GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+    void (*advance)(void *ctx, uint64_t now_us);
+    uint64_t (*nextEvent)(void *ctx);   // next time the device changes state on its own, 0 = none
+} Host_SpiDevice_t;
+
+typedef struct {
+    bool includeCpuTime;     // count host CPU time as firmware execution time
+    uint32_t cpuScale;       // multiply host CPU time (host is faster than a Cortex-M3)
+} Host_Config_t;
+
+typedef struct {
+    uint64_t uartTxBytes;
+    uint64_t uartRxBytes;
+    uint64_t uartRxDropped;
+    uint64_t spiBytes;
+    uint64_t spiBusyUs;
+    uint64_t idleUs;
+    uint64_t wfiCount;
+} Host_Stats_t;
+
+void Host_Init(const Host_Config_t *config);
+uint64_t Host_NowUs(void);
+void Host_Advance(uint64_t us);
+const Host_Stats_t* Host_GetStats(void);
+
+// UART: bytes handed in arrive at the configured line rate
+void Host_UartInput(const uint8_t *data, size_t len);
+size_t Host_UartInputPending(void);
+void Host_SetUartOutput(void (*output)(const uint8_t *data, size_t len));
+
+// Called while the firmware sleeps in WFI, with the virtual time idle in a row
+void Host_SetIdleHook(void (*hook)(uint64_t idle_us));
+
+// SPI devices and their output pins
+bool Host_AttachSpiDevice(SPI_TypeDef *spi, const Host_SpiDevice_t *device);
+void Host_SetPin(GPIO_TypeDef *port, uint16_t pin, GPIO_PinState state);
+
+#endif // HOST_HAL_H
@@ -0,0 +1,388 @@
+/*
+ * stm32f1xx_hal.h
+ *
+ *  Host build HAL shim: the subset of the STM32F1 HAL and CMSIS used by the
+ *  firmware, backed by host_hal.c (virtual time, PTY UART, pluggable SPI
+ *  device). Takes the place of the real HAL header on the include path.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef STM32F1XX_HAL_H
+#define STM32F1XX_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Status ----------------------------------------------------------------------
+typedef enum {
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum {
+    RESET = 0U,
+    SET = !RESET
+} FlagStatus;
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+// Core / CMSIS ----------------------------------------------------------------
+typedef enum {
+    SysTick_IRQn = -1,
+    EXTI0_IRQn = 6,
+    EXTI1_IRQn = 7,
+    EXTI2_IRQn = 8,
+    EXTI3_IRQn = 9,
+    EXTI4_IRQn = 10,
+    TIM2_IRQn = 28,
+    SPI1_IRQn = 35,
+    USART1_IRQn = 37,
+    HOST_IRQ_COUNT = 64
+} IRQn_Type;
+
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk       (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk   (1UL << 24)
+
+// DWT->CYCCNT follows virtual time at the current core clock
+#define DWT          (Host_Dwt())
+#define CoreDebug    (Host_CoreDebug())
+
+extern uint32_t SystemCoreClock;
+
+#define __disable_irq()      Host_DisableIrq()
+#define __enable_irq()       Host_EnableIrq()
+#define __get_PRIMASK()      Host_GetPrimask()
+#define __set_PRIMASK(x)     Host_SetPrimask(x)
+#define __WFI()              Host_Wfi()
+#define __NOP()              do { } while (0)
+
+// GPIO ------------------------------------------------------------------------
+typedef struct {
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+    uint32_t itFalling;   // pins configured as falling-edge EXTI sources
+    uint32_t itRising;    // pins configured as rising-edge EXTI sources
+} GPIO_TypeDef;
+
+typedef enum {
+    GPIO_PIN_RESET = 0U,
+    GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct {
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Pull;
+    uint32_t Speed;
+} GPIO_InitTypeDef;
+
+#define GPIO_PIN_0   ((uint16_t)0x0001)
+#define GPIO_PIN_1   ((uint16_t)0x0002)
+#define GPIO_PIN_2   ((uint16_t)0x0004)
+#define GPIO_PIN_3   ((uint16_t)0x0008)
+#define GPIO_PIN_4   ((uint16_t)0x0010)
+#define GPIO_PIN_5   ((uint16_t)0x0020)
+#define GPIO_PIN_6   ((uint16_t)0x0040)
+#define GPIO_PIN_7   ((uint16_t)0x0080)
+#define GPIO_PIN_8   ((uint16_t)0x0100)
+#define GPIO_PIN_9   ((uint16_t)0x0200)
+#define GPIO_PIN_10  ((uint16_t)0x0400)
+#define GPIO_PIN_11  ((uint16_t)0x0800)
+#define GPIO_PIN_12  ((uint16_t)0x1000)
+#define GPIO_PIN_13  ((uint16_t)0x2000)
+#define GPIO_PIN_14  ((uint16_t)0x4000)
+#define GPIO_PIN_15  ((uint16_t)0x8000)
+
+#define GPIO_MODE_INPUT        0x00000000U
+#define GPIO_MODE_OUTPUT_PP    0x00000001U
+#define GPIO_MODE_OUTPUT_OD    0x00000011U
+#define GPIO_MODE_AF_PP        0x00000002U
+#define GPIO_MODE_IT_RISING    0x10110000U
+#define GPIO_MODE_IT_FALLING   0x10210000U
+#define GPIO_MODE_IT_RISING_FALLING 0x10310000U
+
+#define GPIO_NOPULL    0x00000000U
+#define GPIO_PULLUP    0x00000001U
+#define GPIO_PULLDOWN  0x00000002U
+
+#define GPIO_SPEED_FREQ_LOW     0x00000002U
+#define GPIO_SPEED_FREQ_MEDIUM  0x00000001U
+#define GPIO_SPEED_FREQ_HIGH    0x00000003U
+
+extern GPIO_TypeDef Host_GPIOA, Host_GPIOB, Host_GPIOC, Host_GPIOD;
+#define GPIOA (&Host_GPIOA)
+#define GPIOB (&Host_GPIOB)
+#define GPIOC (&Host_GPIOC)
+#define GPIOD (&Host_GPIOD)
+
+#define __HAL_RCC_GPIOA_CLK_ENABLE()  do { } while (0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE()  do { } while (0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE()  do { } while (0)
+#define __HAL_RCC_GPIOD_CLK_ENABLE()  do { } while (0)
+#define __HAL_RCC_AFIO_CLK_ENABLE()   do { } while (0)
+#define __HAL_RCC_PWR_CLK_ENABLE()    do { } while (0)
+#define __HAL_RCC_SPI1_CLK_ENABLE()   do { } while (0)
+#define __HAL_RCC_SPI1_CLK_DISABLE()  do { } while (0)
+#define __HAL_RCC_SPI2_CLK_ENABLE()   do { } while (0)
+#define __HAL_RCC_SPI2_CLK_DISABLE()  do { } while (0)
+#define __HAL_RCC_USART1_CLK_ENABLE() do { } while (0)
+#define __HAL_RCC_USART1_CLK_DISABLE() do { } while (0)
+#define __HAL_AFIO_REMAP_SWJ_DISABLE() do { } while (0)
+#define __HAL_RCC_TIM2_CLK_ENABLE()   do { } while (0)
+#define __HAL_RCC_TIM2_CLK_DISABLE()  do { } while (0)
+
+// TIM -------------------------------------------------------------------------
+// General purpose timer, up-counting with the update event only
+typedef struct {
+    volatile uint32_t CR1;
+    volatile uint32_t DIER;
+    volatile uint32_t SR;
+    volatile uint32_t EGR;
+    volatile uint32_t CNT;
+    volatile uint32_t PSC;
+    volatile uint32_t ARR;
+} TIM_TypeDef;
+
+#define TIM_CR1_CEN    0x00000001U
+#define TIM_CR1_URS    0x00000004U
+#define TIM_DIER_UIE   0x00000001U
+#define TIM_SR_UIF     0x00000001U
+#define TIM_EGR_UG     0x00000001U
+
+extern TIM_TypeDef Host_TIM2;
+#define TIM2 (&Host_TIM2)
+
+// SPI -------------------------------------------------------------------------
+typedef struct {
+    volatile uint32_t CR1;
+} SPI_TypeDef;
+
+typedef struct {
+    uint32_t Mode;
+    uint32_t Direction;
+    uint32_t DataSize;
+    uint32_t CLKPolarity;
+    uint32_t CLKPhase;
+    uint32_t NSS;
+    uint32_t BaudRatePrescaler;
+    uint32_t FirstBit;
+    uint32_t TIMode;
+    uint32_t CRCCalculation;
+    uint32_t CRCPolynomial;
+} SPI_InitTypeDef;
+
+typedef struct {
+    SPI_TypeDef *Instance;
+    SPI_InitTypeDef Init;
+} SPI_HandleTypeDef;
+
+#define SPI_MODE_MASTER             0x00000104U
+#define SPI_DIRECTION_2LINES        0x00000000U
+#define SPI_DATASIZE_8BIT           0x00000000U
+#define SPI_POLARITY_LOW            0x00000000U
+#define SPI_PHASE_1EDGE             0x00000000U
+#define SPI_NSS_SOFT                0x00000200U
+#define SPI_BAUDRATEPRESCALER_2     0x00000000U
+#define SPI_BAUDRATEPRESCALER_4     0x00000008U
+#define SPI_BAUDRATEPRESCALER_8     0x00000010U
+#define SPI_BAUDRATEPRESCALER_16    0x00000018U
+#define SPI_BAUDRATEPRESCALER_32    0x00000020U
+#define SPI_BAUDRATEPRESCALER_64    0x00000028U
+#define SPI_BAUDRATEPRESCALER_128   0x00000030U
+#define SPI_BAUDRATEPRESCALER_256   0x00000038U
+#define SPI_FIRSTBIT_MSB            0x00000000U
+#define SPI_TIMODE_DISABLE          0x00000000U
+#define SPI_CRCCALCULATION_DISABLE  0x00000000U
+
+extern SPI_TypeDef Host_SPI1, Host_SPI2;
+#define SPI1 (&Host_SPI1)
+#define SPI2 (&Host_SPI2)
+
+// UART ------------------------------------------------------------------------
+typedef struct {
+    volatile uint32_t SR;
+    volatile uint32_t BRR;
+    volatile uint32_t CR1;
+} USART_TypeDef;
+
+typedef struct {
+    uint32_t BaudRate;
+    uint32_t WordLength;
+    uint32_t StopBits;
+    uint32_t Parity;
+    uint32_t Mode;
+    uint32_t HwFlowCtl;
+    uint32_t OverSampling;
+} UART_InitTypeDef;
+
+typedef struct {
+    USART_TypeDef *Instance;
+    UART_InitTypeDef Init;
+    uint8_t *pRxBuffPtr;
+    uint16_t RxXferCount;
+} UART_HandleTypeDef;
+
+#define UART_WORDLENGTH_8B     0x00000000U
+#define UART_STOPBITS_1        0x00000000U
+#define UART_PARITY_NONE       0x00000000U
+#define UART_MODE_TX_RX        0x0000000CU
+#define UART_HWCONTROL_NONE    0x00000000U
+#define UART_OVERSAMPLING_16   0x00000000U
+
+#define UART_FLAG_TC           0x00000040U
+#define __HAL_UART_GET_FLAG(__HANDLE__, __FLAG__) \
+    ((((__HANDLE__)->Instance->SR) & (__FLAG__)) == (__FLAG__))
+
+#define USART_CR1_TXEIE        0x00000080U
+#define UART_IT_TXE            USART_CR1_TXEIE
+#define __HAL_UART_ENABLE_IT(__HANDLE__, __IT__)  ((__HANDLE__)->Instance->CR1 |= (__IT__))
+#define __HAL_UART_DISABLE_IT(__HANDLE__, __IT__) ((__HANDLE__)->Instance->CR1 &= ~(__IT__))
+#define __HAL_UART_GET_IT_SOURCE(__HANDLE__, __IT__) \
+    ((((__HANDLE__)->Instance->CR1) & (__IT__)) ? SET : RESET)
+#define UART_BRR_SAMPLING16(_PCLK_, _BAUD_)  (((_PCLK_) + ((_BAUD_) / 2U)) / (_BAUD_))
+
+extern USART_TypeDef Host_USART1;
+#define USART1 (&Host_USART1)
+
+// RCC / FLASH -----------------------------------------------------------------
+typedef struct {
+    uint32_t PLLState;
+    uint32_t PLLSource;
+    uint32_t PLLMUL;
+} RCC_PLLInitTypeDef;
+
+typedef struct {
+    uint32_t OscillatorType;
+    uint32_t HSEState;
+    uint32_t HSEPredivValue;
+    uint32_t LSEState;
+    uint32_t HSIState;
+    uint32_t HSICalibrationValue;
+    uint32_t LSIState;
+    RCC_PLLInitTypeDef PLL;
+} RCC_OscInitTypeDef;
+
+typedef struct {
+    uint32_t ClockType;
+    uint32_t SYSCLKSource;
+    uint32_t AHBCLKDivider;
+    uint32_t APB1CLKDivider;
+    uint32_t APB2CLKDivider;
+} RCC_ClkInitTypeDef;
+
+#define RCC_OSCILLATORTYPE_NONE   0x00000000U
+#define RCC_OSCILLATORTYPE_HSE    0x00000001U
+#define RCC_OSCILLATORTYPE_HSI    0x00000002U
+
+#define RCC_HSE_OFF               0x00000000U
+#define RCC_HSE_ON                0x00000001U
+#define RCC_HSE_PREDIV_DIV1       0x00000000U
+#define RCC_HSI_ON                0x00000001U
+#define RCC_HSICALIBRATION_DEFAULT 0x10U
+
+#define RCC_PLL_NONE              0x00000000U
+#define RCC_PLL_OFF               0x00000001U
+#define RCC_PLL_ON                0x00000002U
+#define RCC_PLLSOURCE_HSI_DIV2    0x00000000U
+#define RCC_PLLSOURCE_HSE         0x00000001U
+#define RCC_PLL_MUL2              2U
+#define RCC_PLL_MUL4              4U
+#define RCC_PLL_MUL6              6U
+#define RCC_PLL_MUL9              9U
+
+#define RCC_CLOCKTYPE_SYSCLK      0x00000001U
+#define RCC_CLOCKTYPE_HCLK        0x00000002U
+#define RCC_CLOCKTYPE_PCLK1       0x00000004U
+#define RCC_CLOCKTYPE_PCLK2       0x00000008U
+
+#define RCC_SYSCLKSOURCE_HSI      0x00000000U
+#define RCC_SYSCLKSOURCE_HSE      0x00000001U
+#define RCC_SYSCLKSOURCE_PLLCLK   0x00000002U
+
+#define RCC_SYSCLK_DIV1           1U
+#define RCC_SYSCLK_DIV2           2U
+#define RCC_HCLK_DIV1             1U
+#define RCC_HCLK_DIV2             2U
+#define RCC_HCLK_DIV4             4U
+
+#define FLASH_LATENCY_0           0U
+#define FLASH_LATENCY_1           1U
+#define FLASH_LATENCY_2           2U
+
+// HAL API ---------------------------------------------------------------------
+HAL_StatusTypeDef HAL_Init(void);
+void HAL_MspInit(void);
+void HAL_IncTick(void);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+uint32_t HAL_GetUIDw0(void);
+uint32_t HAL_GetUIDw1(void);
+uint32_t HAL_GetUIDw2(void);
+void HAL_DBGMCU_EnableDBGSleepMode(void);
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef *RCC_OscInitStruct);
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t FLatency);
+uint32_t HAL_RCC_GetHCLKFreq(void);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t HAL_RCC_GetPCLK2Freq(void);
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin);
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef *hspi);
+void HAL_SPI_MspInit(SPI_HandleTypeDef *hspi);
+void HAL_SPI_MspDeInit(SPI_HandleTypeDef *hspi);
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef *hspi, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+void HAL_UART_MspInit(UART_HandleTypeDef *huart);
+void HAL_UART_MspDeInit(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+
+// Host internals used by the macros above
+DWT_Type* Host_Dwt(void);
+CoreDebug_Type* Host_CoreDebug(void);
+void Host_DisableIrq(void);
+void Host_EnableIrq(void);
+uint32_t Host_GetPrimask(void);
+void Host_SetPrimask(uint32_t primask);
+void Host_Wfi(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STM32F1XX_HAL_H */
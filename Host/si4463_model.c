@@ -0,0 +1,991 @@
+/*
+ * si4463_model.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+#include "si4463_model.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Commands
+#define CMD_NOP                  0x00
+#define CMD_PART_INFO            0x01
+#define CMD_POWER_UP             0x02
+#define CMD_SET_PROPERTY         0x11
+#define CMD_GET_PROPERTY         0x12
+#define CMD_GPIO_PIN_CFG         0x13
+#define CMD_FIFO_INFO            0x15
+#define CMD_GET_INT_STATUS       0x20
+#define CMD_GET_MODEM_STATUS     0x22
+#define CMD_START_TX             0x31
+#define CMD_START_RX             0x32
+#define CMD_REQUEST_DEVICE_STATE 0x33
+#define CMD_CHANGE_STATE         0x34
+#define CMD_READ_CMD_BUFF        0x44
+#define CMD_FRR_A_READ           0x50
+#define CMD_FRR_B_READ           0x51
+#define CMD_FRR_C_READ           0x53
+#define CMD_FRR_D_READ           0x57
+#define CMD_WRITE_TX_FIFO        0x66
+#define CMD_READ_RX_FIFO         0x77
+
+// Device states as reported by REQUEST_DEVICE_STATE
+#define STATE_SLEEP   1
+#define STATE_READY   3
+#define STATE_TX_TUNE 5
+#define STATE_TX      7
+#define STATE_RX      8
+
+// Interrupt bits
+#define INT_PH                    0x01
+#define INT_MODEM                 0x02
+#define INT_CHIP                  0x04
+#define PH_PACKET_SENT            0x20
+#define PH_TX_FIFO_ALMOST_EMPTY   0x02
+#define PH_PACKET_RX              0x10
+#define PH_RX_FIFO_ALMOST_FULL    0x01
+#define MODEM_SYNC_DETECT         0x01
+#define CHIP_FIFO_ERROR           0x20
+#define CHIP_CMD_ERROR            0x08
+#define CHIP_READY                0x04
+
+// Properties the model acts on (group, index)
+#define PROP_INT_CTL              0x01
+#define PROP_PREAMBLE             0x10
+#define PROP_PREAMBLE_TX_LENGTH   0x00
+#define PROP_PREAMBLE_CONFIG      0x04
+#define PROP_PKT                  0x12
+#define PROP_SYNC                 0x11
+#define PROP_PKT_TX_THRESHOLD     0x0B
+#define PROP_PKT_RX_THRESHOLD     0x0C
+#define PROP_MODEM                0x20
+#define PROP_MODEM_MOD_TYPE       0x00
+#define PROP_MODEM_MAP_CONTROL    0x01
+#define PROP_MODEM_DATA_RATE      0x03
+#define MAP_ENINV_TXBIT           0x20
+#define MOD_SOURCE_MASK           0x18
+#define MOD_SOURCE_DIRECT         0x08
+#define MOD_DIRECT_GPIO_MASK      0x60    // 0 = GPIO0, the only one the model wires
+
+#define CMD_BUF_LEN 16
+
+static Si4463Model_Config_t config = { 6000, 15000, 25, 150, 0, -60, -120 };
+static Si4463Model_Stats_t stats;
+static void (*txHook)(const Si4463Model_Tx_t *tx) = NULL;
+
+// Recorded transmissions
+static Si4463Model_Tx_t *txLog = NULL;
+static size_t txLogCount = 0, txLogCap = 0;
+
+// Signals on air for the receiver, sorted by start time
+static Si4463Model_Tx_t *air = NULL;
+static size_t airCount = 0, airCap = 0;
+
+// One modelled chip, wired to its own SPI bus and pins
+typedef struct {
+    // Wiring
+    SPI_TypeDef *spiBus;
+    GPIO_TypeDef *csPort, *sdnPort, *nirqPort;
+    uint16_t csPin, sdnPin, nirqPin;
+    GPIO_TypeDef *dataPort;  // MCU pin driving GPIO0, the direct mode TX data
+    uint16_t dataPin;
+    bool dataLevel;
+
+    // Chip state
+    bool shutdown;
+    uint64_t porDoneUs;
+    bool poweredUp;
+    uint8_t state;
+    uint8_t props[256][256];
+
+    // Command interface
+    bool selected;
+    uint16_t framePos;
+    uint8_t frameCmd;
+    uint8_t cmdBuf[CMD_BUF_LEN];
+    uint8_t cmdLen;
+    uint8_t resp[CMD_BUF_LEN];
+    uint8_t respLen;
+    uint64_t ctsReadyUs;
+    uint64_t cmdDoneUs;      // command end, for CTS wait statistics
+    bool ctsWaitPending;
+
+    // Interrupts
+    uint8_t phPend, modemPend, chipPend;
+    bool nirqAsserted;
+
+    // TX FIFO and transmitter
+    uint8_t fifo[SI4463_MODEL_FIFO_SIZE];
+    uint8_t fifoHead, fifoCount;
+    uint16_t txLen;          // 0 = until the FIFO is empty
+    uint16_t txSent;         // preamble bytes included
+    uint16_t txPreamble;     // bytes the packet handler sends ahead of the FIFO
+    uint8_t txPreambleByte;
+    uint8_t txXor;           // 0xFF while the modem inverts the TX data
+    uint64_t txFirstBitUs;
+    uint64_t txStartCmdUs;
+    uint32_t txBitRate;
+    uint8_t txCompleteState;
+    size_t txRecord;         // txLog entry of the current transmission
+    size_t txDataCap;
+
+    // Direct mode transmitter: GPIO0 is sampled in the middle of each bit,
+    // the bit grid starts at the first pin write after START_TX
+    bool txDirect;
+    bool txDirectClocked;
+    uint64_t txDirectStartUs;
+    uint64_t txDirectBits;
+    uint8_t txDirectByte;
+
+    // Receiver position in the signals on air
+    size_t airPos;           // signals before this one are over
+
+    // RX FIFO and receiver
+    uint8_t rxFifo[SI4463_MODEL_FIFO_SIZE];
+    uint8_t rxFifoHead, rxFifoCount;
+    bool rxHunting;          // looking for the sync word
+    bool rxSilent;           // hunting, and no signal left to come
+    uint32_t rxShift;
+    uint8_t rxByte;
+    uint8_t rxBitCount;
+    uint16_t rxLen;          // 0 = no end
+    uint16_t rxReceived;
+    uint8_t rxValidState;
+    uint32_t rxBitRate;
+    uint64_t rxClockUs;      // bit clock, bit n is sampled half a bit after n bit times
+    uint64_t rxBitIndex;
+    const Si4463Model_Tx_t *rxLocked; // signal the bit clock follows
+    uint32_t rxNoise;
+} Model_t;
+
+static Model_t models[SI4463_MODEL_MAX];
+static size_t modelCount = 0;
+
+// Private function prototypes
+static uint8_t model_transfer(void *ctx, uint8_t mosi);
+static void model_pinWrite(void *ctx, GPIO_TypeDef *port, uint16_t pin, GPIO_PinState pinState);
+static void model_advance(void *ctx, uint64_t now);
+static uint64_t model_nextEvent(void *ctx);
+static void model_reset(Model_t *m, uint64_t now);
+static void model_execute(Model_t *m, uint64_t now);
+static void model_updateIrq(Model_t *m);
+static uint32_t model_bitRate(Model_t *m);
+static uint64_t model_byteUs(Model_t *m, uint16_t index);
+static void model_txPreamble(Model_t *m);
+static void model_txByte(Model_t *m, uint8_t byte);
+static void model_txEnd(Model_t *m, uint64_t now, bool underflow);
+static void model_directSample(Model_t *m, uint64_t now);
+static void model_rxAdvance(Model_t *m, uint64_t now);
+static uint64_t model_rxSampleUs(Model_t *m);
+static const Si4463Model_Tx_t* model_airAt(Model_t *m, uint64_t t, uint64_t *nextStart);
+static bool model_syncMatch(Model_t *m);
+static void model_rxByte(Model_t *m, uint8_t byte);
+static uint8_t model_rssi(Model_t *m, uint64_t now);
+
+// Public functions -------------------------------------------------------------
+void Si4463Model_Init(const Si4463Model_Config_t *cfg) {
+    if (cfg) {
+        config = *cfg;
+    }
+    memset(&stats, 0, sizeof(stats));
+    memset(models, 0, sizeof(models));
+    modelCount = 0;
+}
+
+bool Si4463Model_Attach(SPI_TypeDef *spi, GPIO_TypeDef *cs_port, uint16_t cs_pin,
+                        GPIO_TypeDef *sdn_port, uint16_t sdn_pin,
+                        GPIO_TypeDef *nirq_port, uint16_t nirq_pin) {
+    Host_SpiDevice_t dev = { NULL, model_transfer, model_pinWrite, model_advance, model_nextEvent };
+    Model_t *m;
+
+    if (modelCount >= SI4463_MODEL_MAX) {
+        return false;
+    }
+    m = &models[modelCount++];
+    dev.ctx = m;
+
+    m->spiBus = spi;
+    m->csPort = cs_port;
+    m->csPin = cs_pin;
+    m->sdnPort = sdn_port;
+    m->sdnPin = sdn_pin;
+    m->nirqPort = nirq_port;
+    m->nirqPin = nirq_pin;
+    m->txCompleteState = STATE_READY;
+    m->rxValidState = STATE_RX;
+    m->rxBitRate = 1200;
+    m->rxNoise = 0x2545F491 + (uint32_t)(m - models);
+    model_reset(m, Host_NowUs());
+
+    Host_SetPin(m->nirqPort, m->nirqPin, GPIO_PIN_SET);
+    return Host_AttachSpiDevice(spi, &dev);
+}
+
+bool Si4463Model_AttachTxData(size_t unit, GPIO_TypeDef *port, uint16_t pin) {
+    if (unit >= modelCount) {
+        return false;
+    }
+    models[unit].dataPort = port;
+    models[unit].dataPin = pin;
+    models[unit].dataLevel = (port->ODR & pin) != 0;
+    return true;
+}
+
+const Si4463Model_Stats_t* Si4463Model_GetStats(void) {
+    return &stats;
+}
+
+size_t Si4463Model_GetTxCount(void) {
+    return txLogCount;
+}
+
+const Si4463Model_Tx_t* Si4463Model_GetTx(size_t index) {
+    return index < txLogCount ? &txLog[index] : NULL;
+}
+
+void Si4463Model_SetTxHook(void (*hook)(const Si4463Model_Tx_t *tx)) {
+    txHook = hook;
+}
+
+void Si4463Model_AddRx(uint64_t startUs, uint32_t bitRate, const uint8_t *data, uint16_t len) {
+    size_t i;
+
+    if (!data || len == 0 || bitRate == 0) {
+        return;
+    }
+    if (airCount == airCap) {
+        airCap = airCap ? airCap * 2 : 16;
+        air = realloc(air, airCap * sizeof(*air));
+    }
+    for (i = airCount; i > 0 && air[i - 1].startUs > startUs; i--) {
+        air[i] = air[i - 1];
+    }
+    memset(&air[i], 0, sizeof(*air));
+    air[i].startUs = startUs;
+    air[i].endUs = startUs + (uint64_t)len * 8 * 1000000ULL / bitRate;
+    air[i].bitRate = bitRate;
+    air[i].len = len;
+    air[i].data = malloc(len);
+    memcpy(air[i].data, data, len);
+    airCount++;
+
+    // every receiver looks at the signals again
+    for (size_t r = 0; r < modelCount; r++) {
+        models[r].airPos = 0;
+        models[r].rxLocked = NULL;
+        models[r].rxSilent = false;
+    }
+}
+
+// Host device callbacks --------------------------------------------------------
+static uint8_t model_transfer(void *ctx, uint8_t mosi) {
+    Model_t *m = ctx;
+    uint64_t now = Host_NowUs();
+    uint8_t miso = 0xFF;
+
+    model_advance(ctx, now);
+    if (!m->selected) {
+        return 0xFF;
+    }
+    if (m->shutdown || now < m->porDoneUs) {
+        // SPI is dead until the power-on reset has finished, reading CTS
+        // as 0x00 meanwhile is how the driver detects the end of it
+        if (m->framePos++ == 0 && mosi != CMD_READ_CMD_BUFF) {
+            stats.commandsBeforePor++;
+        }
+        return 0x00;
+    }
+
+    if (m->framePos == 0) {
+        m->frameCmd = mosi;
+        m->cmdLen = 0;
+        if (m->frameCmd == CMD_WRITE_TX_FIFO) {
+            stats.fifoWrites++;
+        }
+    }
+
+    switch (m->frameCmd) {
+    case CMD_READ_CMD_BUFF:
+        if (m->framePos == 1) {
+            bool cts = now >= m->ctsReadyUs;
+            stats.ctsPolls++;
+            if (!cts) {
+                stats.ctsBusyPolls++;
+            } else if (m->ctsWaitPending) {
+                uint64_t wait = now - m->cmdDoneUs;
+                stats.ctsWaitUs += wait;
+                if (wait > stats.ctsWaitMaxUs) {
+                    stats.ctsWaitMaxUs = wait;
+                }
+                m->ctsWaitPending = false;
+            }
+            miso = cts ? 0xFF : 0x00;
+        } else if (m->framePos > 1) {
+            // response bytes are only valid once CTS is high
+            uint16_t i = m->framePos - 2;
+            miso = (now >= m->ctsReadyUs && i < m->respLen) ? m->resp[i] : 0x00;
+        }
+        break;
+
+    case CMD_WRITE_TX_FIFO:
+        if (m->framePos > 0) {
+            stats.fifoBytes++;
+            if (m->fifoCount >= SI4463_MODEL_FIFO_SIZE) {
+                stats.fifoOverflows++;
+                m->chipPend |= CHIP_FIFO_ERROR;
+                model_updateIrq(m);
+            } else {
+                m->fifo[(m->fifoHead + m->fifoCount) % SI4463_MODEL_FIFO_SIZE] = mosi;
+                m->fifoCount++;
+            }
+        }
+        break;
+
+    case CMD_READ_RX_FIFO:
+        if (m->framePos > 0) {
+            if (m->rxFifoCount > 0) {
+                miso = m->rxFifo[m->rxFifoHead];
+                m->rxFifoHead = (m->rxFifoHead + 1) % SI4463_MODEL_FIFO_SIZE;
+                m->rxFifoCount--;
+                stats.rxFifoReads++;
+            } else {
+                miso = 0x00;
+                m->chipPend |= CHIP_FIFO_ERROR;
+                model_updateIrq(m);
+            }
+        }
+        break;
+
+    case CMD_FRR_A_READ:
+    case CMD_FRR_B_READ:
+    case CMD_FRR_C_READ:
+    case CMD_FRR_D_READ:
+        // fast response registers are not modeled
+        miso = 0x00;
+        break;
+
+    default:
+        if (m->cmdLen < CMD_BUF_LEN) {
+            m->cmdBuf[m->cmdLen++] = mosi;
+        }
+        break;
+    }
+
+    m->framePos++;
+    return miso;
+}
+
+static void model_pinWrite(void *ctx, GPIO_TypeDef *port, uint16_t pin, GPIO_PinState pinState) {
+    Model_t *m = ctx;
+    uint64_t now = Host_NowUs();
+
+    model_advance(ctx, now);
+
+    if (m->dataPort && port == m->dataPort && (pin & m->dataPin)) {
+        m->dataLevel = (pinState == GPIO_PIN_SET);
+        if (m->txDirect && !m->txDirectClocked) {
+            m->txDirectClocked = true;
+            m->txDirectStartUs = now;
+            txLog[m->txRecord].startUs = now;
+        }
+    }
+
+    if (port == m->sdnPort && (pin & m->sdnPin)) {
+        if (pinState == GPIO_PIN_SET && !m->shutdown) {
+            m->shutdown = true;
+            if (m->state == STATE_TX || m->state == STATE_TX_TUNE) {
+                model_txEnd(m, now, true);
+            }
+            m->state = STATE_READY;
+        } else if (pinState == GPIO_PIN_RESET && m->shutdown) {
+            model_reset(m, now);
+        }
+    }
+
+    if (port == m->csPort && (pin & m->csPin)) {
+        if (pinState == GPIO_PIN_RESET && !m->selected) {
+            m->selected = true;
+            m->framePos = 0;
+        } else if (pinState == GPIO_PIN_SET && m->selected) {
+            m->selected = false;
+            if (m->framePos > 0 && !m->shutdown && now >= m->porDoneUs) {
+                switch (m->frameCmd) {
+                case CMD_READ_CMD_BUFF:
+                case CMD_WRITE_TX_FIFO:
+                case CMD_READ_RX_FIFO:
+                case CMD_FRR_A_READ:
+                case CMD_FRR_B_READ:
+                case CMD_FRR_C_READ:
+                case CMD_FRR_D_READ:
+                    break;
+                default:
+                    model_execute(m, now);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Move the transmitter forward to "now"
+static void model_advance(void *ctx, uint64_t now) {
+    Model_t *m = ctx;
+
+    if (m->state == STATE_TX_TUNE && now >= m->txFirstBitUs) {
+        m->state = STATE_TX;
+        stats.txTurnaroundUs += m->txFirstBitUs - m->txStartCmdUs;
+    }
+
+    if (m->state == STATE_TX && m->txDirect) {
+        model_directSample(m, now);
+    }
+
+    while (m->state == STATE_TX && !m->txDirect) {
+        uint64_t next = m->txFirstBitUs + model_byteUs(m, m->txSent);
+
+        if (m->txLen != 0 && m->txSent >= m->txPreamble + m->txLen) {
+            // last byte shifted out, the packet is complete
+            if (now < next) {
+                break;
+            }
+            m->phPend |= PH_PACKET_SENT;
+            model_txEnd(m, next, false);
+            break;
+        }
+        if (now < next) {
+            break;
+        }
+        if (m->txSent < m->txPreamble) {
+            m->txSent++;
+            model_txByte(m, m->txPreambleByte);
+            continue;
+        }
+        if (m->fifoCount == 0) {
+            if (m->txLen != 0) {
+                stats.fifoUnderflows++;
+                m->chipPend |= CHIP_FIFO_ERROR;
+                model_txEnd(m, next, true);
+            } else {
+                m->phPend |= PH_PACKET_SENT;
+                model_txEnd(m, next, false);
+            }
+            break;
+        }
+
+        // byte moves from the FIFO into the modulator
+        uint8_t byte = m->fifo[m->fifoHead];
+        uint8_t threshold = m->props[PROP_PKT][PROP_PKT_TX_THRESHOLD];
+        bool wasAbove = (SI4463_MODEL_FIFO_SIZE - m->fifoCount) >= threshold;
+
+        m->fifoHead = (m->fifoHead + 1) % SI4463_MODEL_FIFO_SIZE;
+        m->fifoCount--;
+        m->txSent++;
+        model_txByte(m, byte);
+
+        if (!wasAbove && (SI4463_MODEL_FIFO_SIZE - m->fifoCount) >= threshold) {
+            m->phPend |= PH_TX_FIFO_ALMOST_EMPTY;
+        }
+    }
+
+    if (!m->shutdown) {
+        model_rxAdvance(m, now);
+    }
+
+    model_updateIrq(m);
+}
+
+static uint64_t model_nextEvent(void *ctx) {
+    Model_t *m = ctx;
+
+    if (m->state == STATE_TX_TUNE) {
+        return m->txFirstBitUs;
+    }
+    if (m->state == STATE_TX && !m->txDirect) {
+        return m->txFirstBitUs + model_byteUs(m, m->txSent);
+    }
+    if (m->state == STATE_RX && !(m->rxHunting && m->rxSilent)) {
+        return model_rxSampleUs(m);
+    }
+    return 0;
+}
+
+// Private functions ------------------------------------------------------------
+// Power-on reset: everything back to defaults
+static void model_reset(Model_t *m, uint64_t now) {
+    m->shutdown = false;
+    m->porDoneUs = now + config.porUs;
+    m->poweredUp = false;
+    m->state = STATE_READY;
+    memset(m->props, 0, sizeof(m->props));
+    m->props[PROP_INT_CTL][0x00] = INT_CHIP;
+    m->props[PROP_INT_CTL][0x03] = CHIP_READY;
+    m->props[PROP_PKT][PROP_PKT_TX_THRESHOLD] = 0x30;
+    m->props[PROP_PKT][PROP_PKT_RX_THRESHOLD] = 0x30;
+    m->phPend = m->modemPend = m->chipPend = 0;
+    m->fifoHead = m->fifoCount = 0;
+    m->rxFifoHead = m->rxFifoCount = 0;
+    m->respLen = 0;
+    m->ctsReadyUs = m->porDoneUs;
+    m->ctsWaitPending = false;
+    m->txBitRate = model_bitRate(m);
+    model_updateIrq(m);
+}
+
+// Run the command collected in cmdBuf when chip select goes high
+static void model_execute(Model_t *m, uint64_t now) {
+    uint32_t latency = config.ctsLatencyUs;
+
+    if (m->cmdLen == 0) {
+        return;
+    }
+    stats.commands++;
+
+    if (now < m->ctsReadyUs) {
+        // a command sent before CTS is dropped and flagged by the chip
+        stats.commandsWhileBusy++;
+        m->chipPend |= CHIP_CMD_ERROR;
+        model_updateIrq(m);
+        return;
+    }
+
+    m->respLen = 0;
+    memset(m->resp, 0, sizeof(m->resp));
+
+    switch (m->cmdBuf[0]) {
+    case CMD_NOP:
+        break;
+
+    case CMD_PART_INFO:
+        m->resp[0] = 0x11;         // CHIPREV
+        m->resp[1] = 0x44;         // PART 0x4463
+        m->resp[2] = 0x63;
+        m->resp[3] = 0x00;         // PBUILD
+        m->resp[4] = 0x00;         // ID
+        m->resp[5] = 0x00;
+        m->resp[6] = 0x00;         // CUSTOMER
+        m->resp[7] = 0x00;         // ROMID
+        m->respLen = 8;
+        break;
+
+    case CMD_POWER_UP:
+        m->poweredUp = true;
+        latency = config.powerUpUs;
+        m->chipPend |= CHIP_READY;
+        break;
+
+    case CMD_SET_PROPERTY:
+        if (m->cmdLen >= 4) {
+            uint8_t group = m->cmdBuf[1];
+            uint8_t count = m->cmdBuf[2];
+            uint8_t start = m->cmdBuf[3];
+
+            for (uint8_t i = 0; i < count && 4 + i < m->cmdLen; i++) {
+                m->props[group][(uint8_t)(start + i)] = m->cmdBuf[4 + i];
+            }
+            if (group == PROP_MODEM) {
+                m->txBitRate = model_bitRate(m);
+            }
+        }
+        break;
+
+    case CMD_GET_PROPERTY:
+        if (m->cmdLen >= 4) {
+            uint8_t count = m->cmdBuf[2] > CMD_BUF_LEN ? CMD_BUF_LEN : m->cmdBuf[2];
+            for (uint8_t i = 0; i < count; i++) {
+                m->resp[i] = m->props[m->cmdBuf[1]][(uint8_t)(m->cmdBuf[3] + i)];
+            }
+            m->respLen = count;
+        }
+        break;
+
+    case CMD_FIFO_INFO:
+        if (m->cmdLen >= 2 && (m->cmdBuf[1] & 0x01)) {
+            m->fifoHead = m->fifoCount = 0;
+        }
+        if (m->cmdLen >= 2 && (m->cmdBuf[1] & 0x02)) {
+            m->rxFifoHead = m->rxFifoCount = 0;
+        }
+        m->resp[0] = m->rxFifoCount;                              // RX_FIFO_COUNT
+        m->resp[1] = SI4463_MODEL_FIFO_SIZE - m->fifoCount;       // TX_FIFO_SPACE
+        m->respLen = 2;
+        break;
+
+    case CMD_GET_INT_STATUS: {
+        uint8_t phStatus = m->phPend, modemStatus = m->modemPend, chipStatus = m->chipPend;
+        uint8_t intPend = (m->phPend ? INT_PH : 0) | (m->modemPend ? INT_MODEM : 0) | (m->chipPend ? INT_CHIP : 0);
+
+        m->resp[0] = intPend;
+        m->resp[1] = intPend;
+        m->resp[2] = m->phPend;
+        m->resp[3] = phStatus;
+        m->resp[4] = m->modemPend;
+        m->resp[5] = modemStatus;
+        m->resp[6] = m->chipPend;
+        m->resp[7] = chipStatus;
+        m->respLen = 8;
+
+        // each argument clears the pending bits written as 0, no argument clears all
+        m->phPend = m->cmdLen > 1 ? (m->phPend & m->cmdBuf[1]) : 0;
+        m->modemPend = m->cmdLen > 2 ? (m->modemPend & m->cmdBuf[2]) : 0;
+        m->chipPend = m->cmdLen > 3 ? (m->chipPend & m->cmdBuf[3]) : 0;
+        model_updateIrq(m);
+        break;
+    }
+
+    case CMD_GET_MODEM_STATUS:
+        m->resp[0] = m->modemPend;
+        m->resp[1] = m->modemPend;
+        m->resp[2] = model_rssi(m, now);   // CURR_RSSI
+        m->resp[3] = m->resp[2];           // LATCH_RSSI
+        m->resp[4] = m->resp[2];           // ANT1_RSSI
+        m->resp[5] = m->resp[2];           // ANT2_RSSI
+        m->respLen = 8;
+        m->modemPend = m->cmdLen > 1 ? (m->modemPend & m->cmdBuf[1]) : 0;
+        model_updateIrq(m);
+        break;
+
+    case CMD_START_TX:
+        if (m->state == STATE_TX || m->state == STATE_TX_TUNE) {
+            model_txEnd(m, now, true);
+        }
+        m->txCompleteState = m->cmdLen > 2 ? (m->cmdBuf[2] >> 4) : 0;
+        if (m->txCompleteState == 0) {
+            m->txCompleteState = STATE_READY;
+        }
+        m->txLen = m->cmdLen > 4 ? (uint16_t)((m->cmdBuf[3] << 8) | m->cmdBuf[4]) : 0;
+        m->txSent = 0;
+        m->txDirect = (m->props[PROP_MODEM][PROP_MODEM_MOD_TYPE] & MOD_SOURCE_MASK) == MOD_SOURCE_DIRECT &&
+                      (m->props[PROP_MODEM][PROP_MODEM_MOD_TYPE] & MOD_DIRECT_GPIO_MASK) == 0;
+        m->txDirectClocked = false;
+        m->txDirectBits = 0;
+        model_txPreamble(m);
+        m->txXor = (m->props[PROP_MODEM][PROP_MODEM_MAP_CONTROL] & MAP_ENINV_TXBIT) ? 0xFF : 0x00;
+        m->txBitRate = model_bitRate(m);
+        m->txStartCmdUs = now;
+        m->txFirstBitUs = now + latency + config.txTuneUs;
+        m->state = STATE_TX_TUNE;
+
+        // open a new record for the bitstream
+        if (txLogCount == txLogCap) {
+            txLogCap = txLogCap ? txLogCap * 2 : 16;
+            txLog = realloc(txLog, txLogCap * sizeof(*txLog));
+        }
+        memset(&txLog[txLogCount], 0, sizeof(*txLog));
+        txLog[txLogCount].startUs = m->txFirstBitUs;
+        txLog[txLogCount].bitRate = m->txBitRate;
+        txLog[txLogCount].unit = (uint8_t)(m - models);
+        m->txRecord = txLogCount++;
+        m->txDataCap = 0;
+        break;
+
+    case CMD_START_RX:
+        if (m->state == STATE_TX || m->state == STATE_TX_TUNE) {
+            model_txEnd(m, now, true);
+        }
+        m->rxLen = m->cmdLen > 4 ? (uint16_t)((m->cmdBuf[3] << 8) | m->cmdBuf[4]) : 0;
+        m->rxValidState = (m->cmdLen > 6 && m->cmdBuf[6]) ? m->cmdBuf[6] : STATE_RX;
+        m->rxBitRate = model_bitRate(m);
+        m->rxClockUs = now + latency;
+        m->rxBitIndex = 0;
+        m->rxLocked = NULL;
+        m->rxHunting = true;
+        m->rxSilent = false;
+        m->rxShift = 0;
+        m->state = STATE_RX;
+        break;
+
+    case CMD_REQUEST_DEVICE_STATE:
+        m->resp[0] = m->state;
+        m->resp[1] = 0;
+        m->respLen = 2;
+        break;
+
+    case CMD_GPIO_PIN_CFG:
+        // pin states are not modeled, GPIO0 is the direct mode input when wired
+        m->respLen = 7;
+        break;
+
+    case CMD_CHANGE_STATE:
+        if (m->cmdLen > 1) {
+            if (m->state == STATE_TX || m->state == STATE_TX_TUNE) {
+                // a direct mode or open-ended packet only ends this way, the
+                // byte on air goes out cut short but is recorded whole
+                model_txEnd(m, now, false);
+            }
+            m->state = m->cmdBuf[1] ? m->cmdBuf[1] : STATE_READY;
+        }
+        break;
+
+    default:
+        stats.unknownCommands++;
+        m->chipPend |= CHIP_CMD_ERROR;
+        model_updateIrq(m);
+        break;
+    }
+
+    // the boot loader answers PART_INFO and NOP before POWER_UP as well
+    if (!m->poweredUp && m->cmdBuf[0] != CMD_POWER_UP &&
+        m->cmdBuf[0] != CMD_PART_INFO && m->cmdBuf[0] != CMD_NOP) {
+        stats.commandsBeforePowerUp++;
+    }
+
+    m->cmdDoneUs = now;
+    m->ctsReadyUs = now + latency;
+    m->ctsWaitPending = true;
+}
+
+// Drive nIRQ low while any enabled interrupt is pending
+static void model_updateIrq(Model_t *m) {
+    uint8_t enable = m->props[PROP_INT_CTL][0x00];
+    bool active = ((enable & INT_PH) && (m->phPend & m->props[PROP_INT_CTL][0x01])) ||
+                  ((enable & INT_MODEM) && (m->modemPend & m->props[PROP_INT_CTL][0x02])) ||
+                  ((enable & INT_CHIP) && (m->chipPend & m->props[PROP_INT_CTL][0x03]));
+
+    if (m->shutdown) {
+        active = false;
+    }
+    if (active != m->nirqAsserted) {
+        m->nirqAsserted = active;
+        if (active) {
+            stats.irqAssertions++;
+        }
+        if (m->nirqPort) {
+            Host_SetPin(m->nirqPort, m->nirqPin, active ? GPIO_PIN_RESET : GPIO_PIN_SET);
+        }
+    }
+}
+
+// The driver programs MODEM_DATA_RATE with opaque register words, map the
+// two it uses back to a bit rate
+static uint32_t model_bitRate(Model_t *m) {
+    const uint8_t *rate = &m->props[PROP_MODEM][PROP_MODEM_DATA_RATE];
+    uint32_t word = ((uint32_t)rate[0] << 24) | ((uint32_t)rate[1] << 16) |
+                    ((uint32_t)rate[2] << 8) | rate[3];
+
+    if (config.bitRate) {
+        return config.bitRate;
+    }
+    return word == 0x800000 ? 512 : 1200;
+}
+
+// Offset of the first bit of byte "index" from the start of the packet
+static uint64_t model_byteUs(Model_t *m, uint16_t index) {
+    return (uint64_t)index * 8 * 1000000ULL / m->txBitRate;
+}
+
+// Standard preamble of PREAMBLE_TX_LENGTH bytes (or nibbles), the sync
+// word is not modeled: the driver always sets SYNC_CONFIG SKIP_TX
+static void model_txPreamble(Model_t *m) {
+    uint8_t length = m->props[PROP_PREAMBLE][PROP_PREAMBLE_TX_LENGTH];
+    uint8_t cfg = m->props[PROP_PREAMBLE][PROP_PREAMBLE_CONFIG];
+
+    m->txPreamble = (cfg & 0x10) ? length : length / 2;
+    m->txPreambleByte = (cfg & 0x20) ? 0xAA : 0x55;
+}
+
+static void model_txByte(Model_t *m, uint8_t byte) {
+    Si4463Model_Tx_t *tx = &txLog[m->txRecord];
+
+    if (tx->len >= m->txDataCap) {
+        m->txDataCap = m->txDataCap ? m->txDataCap * 2 : 256;
+        tx->data = realloc(tx->data, m->txDataCap);
+    }
+    tx->data[tx->len++] = byte ^ m->txXor;
+    stats.txBytes++;
+}
+
+static void model_txEnd(Model_t *m, uint64_t now, bool underflow) {
+    Si4463Model_Tx_t *tx = &txLog[m->txRecord];
+
+    if (m->state == STATE_TX && m->txDirect) {
+        model_directSample(m, now);
+    }
+    m->txDirect = false;
+    if (m->state == STATE_TX_TUNE) {
+        tx->startUs = now;
+    }
+    tx->endUs = now;
+    tx->underflow = underflow;
+    m->state = underflow ? STATE_READY : m->txCompleteState;
+    stats.txCount++;
+    model_updateIrq(m);
+
+    if (txHook) {
+        txHook(tx);
+    }
+}
+
+// Direct mode: take the samples due up to "now" from the level of the data
+// pin, the radio has no bit clock of its own so the grid follows the MCU's
+// first write. Only whole bytes are recorded.
+static void model_directSample(Model_t *m, uint64_t now) {
+    if (!m->txDirectClocked) {
+        return;
+    }
+    for (;;) {
+        uint64_t t = m->txDirectStartUs + (2 * m->txDirectBits + 1) * 500000ULL / m->txBitRate;
+
+        if (t > now) {
+            break;
+        }
+        m->txDirectByte = (uint8_t)((m->txDirectByte << 1) | (m->dataLevel ? 1 : 0));
+        if (++m->txDirectBits % 8 == 0) {
+            m->txSent++;
+            model_txByte(m, m->txDirectByte);
+        }
+    }
+}
+
+// Move the receiver forward to "now", one bit at a time
+static void model_rxAdvance(Model_t *m, uint64_t now) {
+    while (m->state == STATE_RX && !(m->rxHunting && m->rxSilent)) {
+        uint64_t t = model_rxSampleUs(m);
+        uint64_t nextStart;
+        const Si4463Model_Tx_t *sig;
+        int bit;
+
+        if (t > now) {
+            break;
+        }
+
+        sig = model_airAt(m, t, &nextStart);
+        if (m->rxHunting && !sig) {
+            // noise never holds the sync word, skip ahead to the next signal
+            if (nextStart == 0) {
+                m->rxSilent = true;
+                break;
+            }
+            m->rxClockUs = nextStart;
+            m->rxBitIndex = 0;
+            continue;
+        }
+        if (sig && sig != m->rxLocked) {
+            // clock recovery locks onto the new signal
+            m->rxLocked = sig;
+            m->rxClockUs = sig->startUs;
+            m->rxBitIndex = (t - sig->startUs) * m->rxBitRate / 1000000ULL;
+            if (model_rxSampleUs(m) < t) {
+                m->rxBitIndex++;
+            }
+            continue;
+        }
+
+        if (sig) {
+            uint32_t k = (uint32_t)((t - sig->startUs) * sig->bitRate / 1000000ULL);
+            bit = (sig->data[k / 8] >> (7 - k % 8)) & 1;
+        } else {
+            m->rxNoise ^= m->rxNoise << 13;
+            m->rxNoise ^= m->rxNoise >> 17;
+            m->rxNoise ^= m->rxNoise << 5;
+            bit = m->rxNoise & 1;
+        }
+        m->rxBitIndex++;
+
+        if (m->rxHunting) {
+            m->rxShift = (m->rxShift << 1) | (uint32_t)bit;
+            if (model_syncMatch(m)) {
+                m->rxHunting = false;
+                m->rxReceived = 0;
+                m->rxBitCount = 0;
+                m->modemPend |= MODEM_SYNC_DETECT;
+                stats.rxSyncs++;
+            }
+            continue;
+        }
+
+        m->rxByte = (uint8_t)((m->rxByte << 1) | bit);
+        if (++m->rxBitCount == 8) {
+            m->rxBitCount = 0;
+            model_rxByte(m, m->rxByte);
+        }
+    }
+}
+
+static uint64_t model_rxSampleUs(Model_t *m) {
+    return m->rxClockUs + (m->rxBitIndex * 2 + 1) * 1000000ULL / (2ULL * m->rxBitRate);
+}
+
+// Signal the receiver hears at time t, NULL for noise. nextStart is set to
+// the start of the next audible signal, 0 when there is none.
+static const Si4463Model_Tx_t* model_airAt(Model_t *m, uint64_t t, uint64_t *nextStart) {
+    *nextStart = 0;
+
+    while (m->airPos < airCount && air[m->airPos].endUs <= t) {
+        m->airPos++;
+    }
+    for (size_t i = m->airPos; i < airCount; i++) {
+        if (air[i].bitRate != m->rxBitRate) {
+            continue;
+        }
+        if (air[i].startUs > t) {
+            *nextStart = air[i].startUs;
+            break;
+        }
+        if (t < air[i].endUs) {
+            return &air[i];
+        }
+    }
+    return NULL;
+}
+
+// Compare the last received bits with SYNC_BITS, allowing SYNC_CONFIG.RX_ERRORS
+static bool model_syncMatch(Model_t *m) {
+    uint8_t cfg = m->props[PROP_SYNC][0x00];
+    int bytes = (cfg & 0x03) + 1;
+    int errors = (cfg >> 4) & 0x07;
+    uint32_t word = 0;
+    uint32_t mask = bytes == 4 ? 0xFFFFFFFFUL : ((1UL << (bytes * 8)) - 1);
+
+    for (int i = 0; i < bytes; i++) {
+        word = (word << 8) | m->props[PROP_SYNC][1 + i];
+    }
+    return __builtin_popcount((m->rxShift ^ word) & mask) <= errors;
+}
+
+static void model_rxByte(Model_t *m, uint8_t byte) {
+    uint8_t threshold = m->props[PROP_PKT][PROP_PKT_RX_THRESHOLD];
+
+    if (m->rxFifoCount >= SI4463_MODEL_FIFO_SIZE) {
+        stats.rxOverflows++;
+        m->chipPend |= CHIP_FIFO_ERROR;
+    } else {
+        m->rxFifo[(m->rxFifoHead + m->rxFifoCount) % SI4463_MODEL_FIFO_SIZE] = byte;
+        m->rxFifoCount++;
+        stats.rxBytes++;
+        if (m->rxFifoCount == threshold) {
+            m->phPend |= PH_RX_FIFO_ALMOST_FULL;
+        }
+    }
+
+    if (m->rxLen != 0 && ++m->rxReceived >= m->rxLen) {
+        m->phPend |= PH_PACKET_RX;
+        stats.rxPackets++;
+        if (m->rxValidState == STATE_RX) {
+            m->rxHunting = true;
+            m->rxShift = 0;
+        } else {
+            m->state = m->rxValidState;
+        }
+    }
+}
+
+// RSSI register (0.5 dB steps, 0 = -134 dBm with the default MODEM_RSSI_COMP),
+// only meaningful in RX
+static uint8_t model_rssi(Model_t *m, uint64_t now) {
+    int dBm = config.noiseDbm;
+    int reg;
+
+    if (m->state != STATE_RX) {
+        return 0;
+    }
+    for (size_t i = 0; i < airCount; i++) {
+        if (air[i].startUs <= now && now < air[i].endUs) {
+            dBm = config.signalDbm;
+            break;
+        }
+    }
+
+    reg = (dBm + 134) * 2;
+    return (uint8_t)(reg < 0 ? 0 : reg > 255 ? 255 : reg);
+}
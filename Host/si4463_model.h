@@ -0,0 +1,92 @@
+/*
+ * si4463_model.h
+ *
+ *  Software SI4463 for the host build. Speaks the SPI command set used by
+ *  si4463_driver.c, models the 64-byte TX and RX FIFOs, CTS latency, nIRQ
+ *  and on-air bit timing, records every transmission and receives the
+ *  signals put on air with Si4463Model_AddRx().
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: peter
+ */
+
+#ifndef SI4463_MODEL_H
+#define SI4463_MODEL_H
+
+#include "host_hal.h"
+#include <stddef.h>
+
+#define SI4463_MODEL_FIFO_SIZE 64
+
+typedef struct {
+    uint32_t porUs;          // SDN released to first command accepted
+    uint32_t powerUpUs;      // POWER_UP execution time
+    uint32_t ctsLatencyUs;   // execution time of every other command
+    uint32_t txTuneUs;       // START_TX to first bit on air
+    uint32_t bitRate;        // on-air bit rate, 0 = follow the driver's data rate setting
+    int signalDbm;           // RSSI while a signal added with Si4463Model_AddRx() is on air
+    int noiseDbm;            // RSSI otherwise
+} Si4463Model_Config_t;
+
+// One transmission as it went on air
+typedef struct {
+    uint64_t startUs;        // first bit on air
+    uint64_t endUs;          // last bit on air
+    uint32_t bitRate;
+    uint16_t len;            // bytes sent
+    bool underflow;          // FIFO ran empty before TX_LEN bytes were sent
+    uint8_t unit;            // model that sent it, in Si4463Model_Attach() order
+    uint8_t *data;
+} Si4463Model_Tx_t;
+
+typedef struct {
+    uint64_t commands;
+    uint64_t unknownCommands;     // opcodes the model does not know (CMD_ERROR)
+    uint64_t commandsWhileBusy;   // sent before CTS, ignored by the chip (CMD_ERROR)
+    uint64_t commandsBeforePor;   // sent while in shutdown or reset, lost
+    uint64_t commandsBeforePowerUp; // accepted, but a real chip would still be booting
+    uint64_t ctsPolls;
+    uint64_t ctsBusyPolls;        // READ_CMD_BUFF answered with CTS low
+    uint64_t ctsWaitUs;           // command end to first CTS seen high, summed
+    uint64_t ctsWaitMaxUs;
+    uint64_t fifoWrites;          // WRITE_TX_FIFO frames
+    uint64_t fifoBytes;
+    uint64_t fifoOverflows;
+    uint64_t fifoUnderflows;
+    uint64_t txCount;
+    uint64_t txBytes;
+    uint64_t txTurnaroundUs;      // START_TX to first bit, summed
+    uint64_t irqAssertions;
+    uint64_t rxSyncs;             // sync words matched
+    uint64_t rxPackets;           // RX_LEN bytes received
+    uint64_t rxBytes;             // bytes into the RX FIFO
+    uint64_t rxFifoReads;         // bytes read out of the RX FIFO
+    uint64_t rxOverflows;
+} Si4463Model_Stats_t;
+
+// Up to SI4463_MODEL_MAX chips share the configuration, statistics,
+// transmission log and the signals on air
+#define SI4463_MODEL_MAX 2
+
+void Si4463Model_Init(const Si4463Model_Config_t *config);
+bool Si4463Model_Attach(SPI_TypeDef *spi, GPIO_TypeDef *csPort, uint16_t csPin,
+                        GPIO_TypeDef *sdnPort, uint16_t sdnPin,
+                        GPIO_TypeDef *nirqPort, uint16_t nirqPin);
+
+// Wire GPIO0 of a chip (in Si4463Model_Attach() order) to an MCU output,
+// the TX data input in asynchronous direct mode
+bool Si4463Model_AttachTxData(size_t unit, GPIO_TypeDef *port, uint16_t pin);
+
+const Si4463Model_Stats_t* Si4463Model_GetStats(void);
+size_t Si4463Model_GetTxCount(void);
+const Si4463Model_Tx_t* Si4463Model_GetTx(size_t index);
+
+// Called when a transmission has left the antenna (or was cut short)
+void Si4463Model_SetTxHook(void (*hook)(const Si4463Model_Tx_t *tx));
+
+// Put a signal on air for the receiver, e.g. one recorded with --bitstream.
+// Signals at another bit rate than the receiver's are not heard, outside
+// of any signal the receiver hears noise.
+void Si4463Model_AddRx(uint64_t startUs, uint32_t bitRate, const uint8_t *data, uint16_t len);
+
+#endif // SI4463_MODEL_H